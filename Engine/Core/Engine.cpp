@@ -11,6 +11,7 @@
 
 #include "Engine/AudioSystem/Audio.hpp"
 #include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/TickScheduler.hpp"
 #include "Engine/Core/Time.hpp"
 #include "Engine/DebugSystem/BProfiler.hpp"
 #include "Engine/DebugSystem/Console.hpp"
@@ -144,6 +145,7 @@ Engine::Engine( HINSTANCE applicationInstanceHandle )
 	: m_applicationInstanceHandle( applicationInstanceHandle )
 	, m_timeLastFrameBegan( 0.0 )
 	, m_targetFPS( 60.0 )
+	, m_preciseFrameWait( false )
 	, m_isFullscreen( false )
 	, m_UICamera( nullptr )
 	, m_currentDrawCalls( 0 )
@@ -288,8 +290,15 @@ void Engine::UpdateTime( )
 
 	if( g_limitFPS && elapsedTime < totalFrameTime )
 	{
-		double waitTime = (totalFrameTime - elapsedTime) * 1000.0 - 0.5;
-		std::this_thread::sleep_for( std::chrono::duration<double,std::milli>( waitTime ) );
+		if( m_preciseFrameWait )
+		{
+			TickScheduler::WaitUntil( m_timeLastFrameBegan + totalFrameTime );
+		}
+		else
+		{
+			double waitTime = (totalFrameTime - elapsedTime) * 1000.0 - 0.5;
+			std::this_thread::sleep_for( std::chrono::duration<double,std::milli>( waitTime ) );
+		}
 	}
 	g_ProfilerSystem->StopSample( );
 
@@ -449,6 +458,14 @@ void Engine::SetTargetFPS( double fps )
 }
 
 
+//-------------------------------------------------------------------------------------------------
+// For servers that pace their tick off the frame, costs a little spinning at the end of each frame
+void Engine::SetPreciseFrameWait( bool preciseFrameWait )
+{
+	m_preciseFrameWait = preciseFrameWait;
+}
+
+
 //-------------------------------------------------------------------------------------------------
 void Engine::SetWindowHandle( HWND & handle )
 {
@@ -53,6 +53,7 @@ private:
 	HINSTANCE m_applicationInstanceHandle;
 	double m_timeLastFrameBegan;
 	double m_targetFPS;
+	bool m_preciseFrameWait; //Sleep then spin to the frame deadline instead of a plain sleep
 	bool m_isFullscreen;
 	Camera3D * m_UICamera; //#TODO: Make this something that's passed into the UI system, and all MeshRenderer calls use this camera proj/view stuff
 	int m_currentDrawCalls; //#TODO: Put this in RenderSystem
@@ -77,6 +78,7 @@ public:
 	void CalculateLargestWindow( );
 
 	void SetTargetFPS( double fps );
+	void SetPreciseFrameWait( bool preciseFrameWait );
 	void SetWindowHandle( HWND & handle );
 	void SetFullscreen( bool isFullscreen );
 
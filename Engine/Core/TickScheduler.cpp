@@ -0,0 +1,185 @@
+#include "Engine/Core/TickScheduler.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+#if !defined( _WIN32 )
+	#include <time.h>
+#endif
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Time.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC double const TickScheduler::DEFAULT_TICKS_PER_SECOND = 60.0;
+STATIC double TickScheduler::s_spinSeconds = 0.002;
+
+
+//-------------------------------------------------------------------------------------------------
+// Sleeps most of the way then yields until the target. The POSIX side of the platform layer (see
+// Time.cpp) sleeps on the absolute monotonic deadline instead, nothing ships on it yet.
+STATIC void TickScheduler::WaitUntil( double targetTime )
+{
+	double remaining = targetTime - Time::GetCurrentTimeSeconds( );
+	if( remaining <= 0.0 )
+	{
+		return;
+	}
+
+#if defined( _WIN32 )
+	if( remaining > s_spinSeconds )
+	{
+		std::this_thread::sleep_for( std::chrono::duration<double>( remaining - s_spinSeconds ) );
+	}
+	while( Time::GetCurrentTimeSeconds( ) < targetTime )
+	{
+		std::this_thread::yield( );
+	}
+#else
+	timespec deadline;
+	clock_gettime( CLOCK_MONOTONIC, &deadline );
+	uint64_t nanoseconds = (uint64_t) deadline.tv_nsec + (uint64_t) ( remaining * 1e9 );
+	deadline.tv_sec += (time_t) ( nanoseconds / 1000000000ULL );
+	deadline.tv_nsec = (long) ( nanoseconds % 1000000000ULL );
+	while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr ) != 0 )
+	{
+		//Interrupted by a signal, the deadline hasn't moved
+	}
+#endif
+}
+
+
+//-------------------------------------------------------------------------------------------------
+TickScheduler::TickScheduler( double ticksPerSecond, size_t maxSubsteps )
+	: m_interval( 1.0 / ( ticksPerSecond > 0.0 ? ticksPerSecond : DEFAULT_TICKS_PER_SECOND ) )
+	, m_maxSubsteps( maxSubsteps > 0 ? maxSubsteps : 1 )
+	, m_nextTickTime( 0.0 )
+	, m_started( false )
+{
+	ResetStats( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Ticks to run now. Ticks past the substep cap are dropped, the schedule keeps its phase.
+size_t TickScheduler::Advance( double currentTime )
+{
+	//First tick is due right away
+	if( !m_started )
+	{
+		m_nextTickTime = currentTime;
+		m_started = true;
+	}
+
+	if( currentTime < m_nextTickTime )
+	{
+		return 0;
+	}
+
+	size_t dueTicks = (size_t) ( ( currentTime - m_nextTickTime ) / m_interval ) + 1;
+	m_nextTickTime += (double) dueTicks * m_interval;
+
+	size_t runTicks = dueTicks;
+	if( runTicks > m_maxSubsteps )
+	{
+		m_stats.droppedTicks += runTicks - m_maxSubsteps;
+		runTicks = m_maxSubsteps;
+	}
+	return runTicks;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// How long one tick took to run, anything over the interval can't keep up the rate
+void TickScheduler::RecordTick( double tickSeconds )
+{
+	++m_stats.ticks;
+	m_stats.totalTickSeconds += tickSeconds;
+	if( tickSeconds > m_stats.maxTickSeconds )
+	{
+		m_stats.maxTickSeconds = tickSeconds;
+	}
+	if( tickSeconds > m_interval )
+	{
+		++m_stats.overruns;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void TickScheduler::WaitForNextTick( ) const
+{
+	if( m_started )
+	{
+		WaitUntil( m_nextTickTime );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Restarts the schedule on the next Advance(), nothing is owed for the time in between
+void TickScheduler::Reset( )
+{
+	m_started = false;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void TickScheduler::ResetStats( )
+{
+	memset( &m_stats, 0, sizeof( m_stats ) );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+double TickScheduler::GetRate( ) const
+{
+	return 1.0 / m_interval;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+double TickScheduler::GetInterval( ) const
+{
+	return m_interval;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t TickScheduler::GetMaxSubsteps( ) const
+{
+	return m_maxSubsteps;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+double TickScheduler::GetNextTickTime( ) const
+{
+	return m_nextTickTime;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+TickSchedulerStats const & TickScheduler::GetStats( ) const
+{
+	return m_stats;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Takes effect from the next tick, the one already scheduled keeps its time
+void TickScheduler::SetRate( double ticksPerSecond )
+{
+	if( ticksPerSecond <= 0.0 )
+	{
+		return;
+	}
+	m_interval = 1.0 / ticksPerSecond;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void TickScheduler::SetMaxSubsteps( size_t maxSubsteps )
+{
+	m_maxSubsteps = maxSubsteps > 0 ? maxSubsteps : 1;
+}
\ No newline at end of file
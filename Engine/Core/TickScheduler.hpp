@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stddef.h>
+
+
+//-------------------------------------------------------------------------------------------------
+// Counted since the last ResetStats()
+class TickSchedulerStats
+{
+public:
+	size_t ticks;
+	size_t overruns; //Ticks that took longer than the interval to run
+	size_t droppedTicks; //Due but skipped by the substep cap, the schedule fell behind this much
+	double totalTickSeconds;
+	double maxTickSeconds;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Fixed timestep against the real clock, independent of the frame rate. Advance() says how many
+// ticks are due, catching up to the substep cap and dropping the rest so a long hitch doesn't
+// turn into a spiral of ever longer updates.
+class TickScheduler
+{
+//-------------------------------------------------------------------------------------------------
+// Static Members
+//-------------------------------------------------------------------------------------------------
+public:
+	static double const DEFAULT_TICKS_PER_SECOND; //Used when constructed with a rate that isn't positive
+	static double s_spinSeconds; //End of a wait spent yielding, sleeps overshoot by up to a scheduler quantum
+
+//-------------------------------------------------------------------------------------------------
+// Members
+//-------------------------------------------------------------------------------------------------
+private:
+	double m_interval;
+	size_t m_maxSubsteps;
+	double m_nextTickTime;
+	bool m_started;
+	TickSchedulerStats m_stats;
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+public:
+	static void WaitUntil( double targetTime );
+
+	TickScheduler( double ticksPerSecond, size_t maxSubsteps );
+
+	size_t Advance( double currentTime );
+	void RecordTick( double tickSeconds );
+	void WaitForNextTick( ) const;
+	void Reset( );
+	void ResetStats( );
+
+	double GetRate( ) const;
+	double GetInterval( ) const;
+	size_t GetMaxSubsteps( ) const;
+	double GetNextTickTime( ) const;
+	TickSchedulerStats const & GetStats( ) const;
+
+	void SetRate( double ticksPerSecond );
+	void SetMaxSubsteps( size_t maxSubsteps );
+};
\ No newline at end of file
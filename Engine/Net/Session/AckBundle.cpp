@@ -7,8 +7,11 @@
 AckBundle::AckBundle( )
 	: m_ackID( INVALID_ACK_ID )
 	, m_reliableMessageCount( 0 )
-	, m_confirmReceived( false )
+	, m_firstDeliveryIndex( 0 )
+	, m_deliveryTagCount( 0 )
 	, m_sentTimeStamp( 0.0 )
+	, m_confirmReceived( false )
+	, m_lossReported( false )
 {
 	//Nothing
 }
@@ -18,8 +21,11 @@ AckBundle::AckBundle( )
 AckBundle::AckBundle( uint16_t id )
 	: m_ackID( id )
 	, m_reliableMessageCount( 0 )
+	, m_firstDeliveryIndex( 0 )
+	, m_deliveryTagCount( 0 )
+	, m_sentTimeStamp( Time::GetCurrentTimeSeconds( ) )
 	, m_confirmReceived( false )
-	, m_sentTimeStamp( Time::TOTAL_SECONDS )
+	, m_lossReported( false )
 {
 	//Nothing
 }
@@ -32,3 +38,14 @@ void AckBundle::AddReliableID( uint16_t reliableID )
 	++m_reliableMessageCount;
 }
 
+
+//-------------------------------------------------------------------------------------------------
+// Delivery indices written into one packet are always consecutive
+void AckBundle::AddDeliveryIndex( uint32_t deliveryIndex )
+{
+	if( m_deliveryTagCount == 0 )
+	{
+		m_firstDeliveryIndex = deliveryIndex;
+	}
+	++m_deliveryTagCount;
+}
@@ -3,6 +3,7 @@
 
 //-------------------------------------------------------------------------------------------------
 typedef unsigned short uint16_t;
+typedef unsigned int uint32_t;
 
 
 //-------------------------------------------------------------------------------------------------
@@ -22,8 +23,11 @@ public:
 	uint16_t m_ackID;
 	uint16_t m_attachedReliables[MAX_RELIABLES_PER_PACKET];
 	size_t m_reliableMessageCount;
+	uint32_t m_firstDeliveryIndex; //Into the connection's sent delivery tags
+	uint16_t m_deliveryTagCount;
 	double m_sentTimeStamp;
 	bool m_confirmReceived;
+	bool m_lossReported;
 
 //-------------------------------------------------------------------------------------------------
 // Functions
@@ -33,4 +37,5 @@ public:
 	AckBundle( uint16_t id );
 
 	void AddReliableID( uint16_t reliableID );
+	void AddDeliveryIndex( uint32_t deliveryIndex );
 };
\ No newline at end of file
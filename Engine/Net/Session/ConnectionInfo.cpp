@@ -14,7 +14,7 @@ ConnectionInfo::ConnectionInfo( )
 
 
 //-------------------------------------------------------------------------------------------------
-ConnectionInfo::ConnectionInfo( byte_t idx, sockaddr_in const & addr, char const * id, char const * name )
+ConnectionInfo::ConnectionInfo( uint16_t idx, sockaddr_in const & addr, char const * id, char const * name )
 	: m_index( idx )
 	, m_address( addr )
 {
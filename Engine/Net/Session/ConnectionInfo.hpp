@@ -19,7 +19,7 @@ public:
 // Members
 //-------------------------------------------------------------------------------------------------
 public:
-	byte_t m_index;
+	uint16_t m_index;
 	sockaddr_in m_address;
 	char m_guid[MAX_GUID_SIZE];
 	char m_username[MAX_USERNAME_SIZE];
@@ -30,5 +30,5 @@ public:
 //-------------------------------------------------------------------------------------------------
 public:
 	ConnectionInfo( );
-	ConnectionInfo( byte_t index, sockaddr_in const & address, char const * id, char const * name );
+	ConnectionInfo( uint16_t index, sockaddr_in const & address, char const * id, char const * name );
 };
\ No newline at end of file
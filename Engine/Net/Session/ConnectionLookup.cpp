@@ -0,0 +1,239 @@
+#include "Engine/Net/Session/ConnectionLookup.hpp"
+
+#include <string.h>
+
+
+//-------------------------------------------------------------------------------------------------
+static size_t const TABLE_MASK = ConnectionLookup::TABLE_SIZE - 1;
+
+
+//-------------------------------------------------------------------------------------------------
+// Whether an entry at slot (next) with home slot (home) can move back into (empty) without
+// becoming unreachable, ie. its home is not in (empty, next] going around the table
+static bool CanShiftBack( size_t home, size_t empty, size_t next )
+{
+	if( next > empty )
+	{
+		return home <= empty || home > next;
+	}
+	return home <= empty && home > next;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+ConnectionLookup::ConnectionLookup( )
+{
+	Clear( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void ConnectionLookup::Add( uint16_t index, sockaddr_in const & address, char const * guid )
+{
+	if( index >= MAX_CONNECTIONS )
+	{
+		return;
+	}
+	if( m_used[index] )
+	{
+		Remove( index );
+	}
+
+	m_used[index] = true;
+	m_addresses[index] = address;
+	m_guids[index] = guid;
+
+	uint32_t ipAddress = address.sin_addr.s_addr;
+	uint16_t port = address.sin_port;
+	size_t slot = HashAddress( ipAddress, port );
+	while( m_addressSlots[slot].index != INVALID_INDEX )
+	{
+		slot = ( slot + 1 ) & TABLE_MASK;
+	}
+	m_addressSlots[slot].address = ipAddress;
+	m_addressSlots[slot].port = port;
+	m_addressSlots[slot].index = index;
+
+	uint32_t hash = HashGUID( guid );
+	slot = GetSlotFromHash( hash );
+	while( m_guidSlots[slot].index != INVALID_INDEX )
+	{
+		slot = ( slot + 1 ) & TABLE_MASK;
+	}
+	m_guidSlots[slot].hash = hash;
+	m_guidSlots[slot].index = index;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void ConnectionLookup::Remove( uint16_t index )
+{
+	if( index >= MAX_CONNECTIONS || !m_used[index] )
+	{
+		return;
+	}
+
+	//Find this index's own slots, another connection could share the GUID
+	size_t slot = HashAddress( m_addresses[index].sin_addr.s_addr, m_addresses[index].sin_port );
+	while( m_addressSlots[slot].index != INVALID_INDEX )
+	{
+		if( m_addressSlots[slot].index == index )
+		{
+			RemoveAddressSlot( slot );
+			break;
+		}
+		slot = ( slot + 1 ) & TABLE_MASK;
+	}
+
+	slot = GetSlotFromHash( HashGUID( m_guids[index].c_str( ) ) );
+	while( m_guidSlots[slot].index != INVALID_INDEX )
+	{
+		if( m_guidSlots[slot].index == index )
+		{
+			RemoveGUIDSlot( slot );
+			break;
+		}
+		slot = ( slot + 1 ) & TABLE_MASK;
+	}
+
+	m_used[index] = false;
+	m_guids[index].clear( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void ConnectionLookup::Clear( )
+{
+	for( size_t slot = 0; slot < TABLE_SIZE; ++slot )
+	{
+		m_addressSlots[slot].index = INVALID_INDEX;
+		m_guidSlots[slot].index = INVALID_INDEX;
+	}
+	for( size_t index = 0; index < MAX_CONNECTIONS; ++index )
+	{
+		m_used[index] = false;
+		m_guids[index].clear( );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+uint16_t ConnectionLookup::FindAddress( sockaddr_in const & address ) const
+{
+	size_t slot = FindAddressSlot( address );
+	return m_addressSlots[slot].index;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+uint16_t ConnectionLookup::FindGUID( char const * guid ) const
+{
+	size_t slot = FindGUIDSlot( guid, HashGUID( guid ) );
+	return m_guidSlots[slot].index;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Returns the matching slot, or the empty slot that ends the probe
+size_t ConnectionLookup::FindAddressSlot( sockaddr_in const & address ) const
+{
+	uint32_t ipAddress = address.sin_addr.s_addr;
+	uint16_t port = address.sin_port;
+	size_t slot = HashAddress( ipAddress, port );
+	while( m_addressSlots[slot].index != INVALID_INDEX )
+	{
+		AddressSlot const & check = m_addressSlots[slot];
+		if( check.address == ipAddress && check.port == port )
+		{
+			break;
+		}
+		slot = ( slot + 1 ) & TABLE_MASK;
+	}
+	return slot;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t ConnectionLookup::FindGUIDSlot( char const * guid, uint32_t hash ) const
+{
+	size_t slot = GetSlotFromHash( hash );
+	while( m_guidSlots[slot].index != INVALID_INDEX )
+	{
+		GUIDSlot const & check = m_guidSlots[slot];
+		if( check.hash == hash && strcmp( m_guids[check.index].c_str( ), guid ) == 0 )
+		{
+			break;
+		}
+		slot = ( slot + 1 ) & TABLE_MASK;
+	}
+	return slot;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Linear probing can't just clear a slot, entries after it would become unreachable.
+// Shift every later entry in the run back if its home slot allows it.
+void ConnectionLookup::RemoveAddressSlot( size_t slot )
+{
+	size_t empty = slot;
+	size_t next = ( slot + 1 ) & TABLE_MASK;
+	while( m_addressSlots[next].index != INVALID_INDEX )
+	{
+		size_t home = HashAddress( m_addressSlots[next].address, m_addressSlots[next].port );
+		if( CanShiftBack( home, empty, next ) )
+		{
+			m_addressSlots[empty] = m_addressSlots[next];
+			empty = next;
+		}
+		next = ( next + 1 ) & TABLE_MASK;
+	}
+	m_addressSlots[empty].index = INVALID_INDEX;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void ConnectionLookup::RemoveGUIDSlot( size_t slot )
+{
+	size_t empty = slot;
+	size_t next = ( slot + 1 ) & TABLE_MASK;
+	while( m_guidSlots[next].index != INVALID_INDEX )
+	{
+		size_t home = GetSlotFromHash( m_guidSlots[next].hash );
+		if( CanShiftBack( home, empty, next ) )
+		{
+			m_guidSlots[empty] = m_guidSlots[next];
+			empty = next;
+		}
+		next = ( next + 1 ) & TABLE_MASK;
+	}
+	m_guidSlots[empty].index = INVALID_INDEX;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC size_t ConnectionLookup::HashAddress( uint32_t address, uint16_t port )
+{
+	return GetSlotFromHash( address ^ ( ( (uint32_t) port << 16 ) | port ) );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// FNV-1a
+STATIC uint32_t ConnectionLookup::HashGUID( char const * guid )
+{
+	uint32_t hash = 2166136261U;
+	for( char const * c = guid; *c != '\0'; ++c )
+	{
+		hash ^= (byte_t) *c;
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Fibonacci hashing, top bits of the product are the best mixed
+STATIC size_t ConnectionLookup::GetSlotFromHash( uint32_t hash )
+{
+	return (size_t) ( ( hash * 2654435769U ) >> ( 32 - TABLE_BITS ) );
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <string>
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Utils/NetworkUtils.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+class AddressSlot
+{
+public:
+	uint32_t address;
+	uint16_t port;
+	uint16_t index;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+class GUIDSlot
+{
+public:
+	uint32_t hash;
+	uint16_t index;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Open addressed tables from address and GUID to connection index, so the receive path doesn't
+// scan every connection slot. Tables are kept under half full and use linear probing.
+class ConnectionLookup
+{
+//-------------------------------------------------------------------------------------------------
+// Static Members
+//-------------------------------------------------------------------------------------------------
+public:
+	static uint16_t const INVALID_INDEX = 0xFFFF;
+	static size_t const MAX_CONNECTIONS = 2048; //Matches NetSession
+	static size_t const TABLE_BITS = 12;
+	static size_t const TABLE_SIZE = 1 << TABLE_BITS; //4096, at most half full
+
+//-------------------------------------------------------------------------------------------------
+// Members
+//-------------------------------------------------------------------------------------------------
+private:
+	AddressSlot m_addressSlots[TABLE_SIZE];
+	GUIDSlot m_guidSlots[TABLE_SIZE];
+	sockaddr_in m_addresses[MAX_CONNECTIONS];
+	std::string m_guids[MAX_CONNECTIONS];
+	bool m_used[MAX_CONNECTIONS];
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+public:
+	ConnectionLookup( );
+
+	void Add( uint16_t index, sockaddr_in const & address, char const * guid );
+	void Remove( uint16_t index );
+	void Clear( );
+	uint16_t FindAddress( sockaddr_in const & address ) const;
+	uint16_t FindGUID( char const * guid ) const;
+
+private:
+	size_t FindAddressSlot( sockaddr_in const & address ) const;
+	size_t FindGUIDSlot( char const * guid, uint32_t hash ) const;
+	void RemoveAddressSlot( size_t slot );
+	void RemoveGUIDSlot( size_t slot );
+
+	static size_t HashAddress( uint32_t address, uint16_t port );
+	static uint32_t HashGUID( char const * guid );
+	static size_t GetSlotFromHash( uint32_t hash );
+};
\ No newline at end of file
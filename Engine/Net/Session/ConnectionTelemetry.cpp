@@ -0,0 +1,150 @@
+#include "Engine/Net/Session/ConnectionTelemetry.hpp"
+
+#include <cstring>
+#include "Engine/Utils/StringUtils.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+// Upper edge of a bucket, 0 for the last one which has none
+STATIC double ConnectionTelemetry::GetBucketLimitMilliseconds( size_t bucket )
+{
+	if( bucket + 1 >= ROUND_TRIP_BUCKET_COUNT )
+	{
+		return 0.0;
+	}
+	return (double) ( 1U << bucket );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+ConnectionTelemetry::ConnectionTelemetry( )
+{
+	Reset( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void ConnectionTelemetry::AddRoundTripSample( double seconds )
+{
+	double milliseconds = seconds * 1000.0;
+	size_t bucket = 0;
+	while( bucket + 1 < ROUND_TRIP_BUCKET_COUNT && milliseconds > GetBucketLimitMilliseconds( bucket ) )
+	{
+		++bucket;
+	}
+	++m_roundTripBuckets[bucket];
+
+	if( seconds > m_maxRoundTrip )
+	{
+		m_maxRoundTrip = seconds;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Size with the message header, resends count again since they cost the bandwidth again
+void ConnectionTelemetry::AddMessageSent( byte_t type, size_t size )
+{
+	++m_sentCounts[type];
+	m_sentBytes[type] += size;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void ConnectionTelemetry::AddMessageReceived( byte_t type, size_t size )
+{
+	++m_receivedCounts[type];
+	m_receivedBytes[type] += size;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void ConnectionTelemetry::Reset( )
+{
+	memset( m_roundTripBuckets, 0, sizeof( m_roundTripBuckets ) );
+	m_maxRoundTrip = 0.0;
+	memset( m_sentCounts, 0, sizeof( m_sentCounts ) );
+	memset( m_sentBytes, 0, sizeof( m_sentBytes ) );
+	memset( m_receivedCounts, 0, sizeof( m_receivedCounts ) );
+	memset( m_receivedBytes, 0, sizeof( m_receivedBytes ) );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Appends the fields without braces so the connection can add its own around them
+void ConnectionTelemetry::AppendJSON( std::string * out_json ) const
+{
+	out_json->append( "\"rtt_bucket_ms\":[" );
+	for( size_t bucket = 0; bucket + 1 < ROUND_TRIP_BUCKET_COUNT; ++bucket )
+	{
+		out_json->append( Stringf( bucket == 0 ? "%.0f" : ",%.0f", GetBucketLimitMilliseconds( bucket ) ) );
+	}
+	out_json->append( "],\"rtt_histogram\":[" );
+	for( size_t bucket = 0; bucket < ROUND_TRIP_BUCKET_COUNT; ++bucket )
+	{
+		out_json->append( Stringf( bucket == 0 ? "%llu" : ",%llu", (unsigned long long) m_roundTripBuckets[bucket] ) );
+	}
+	out_json->append( Stringf( "],\"rtt_max_ms\":%.1f,\"sent\":", m_maxRoundTrip * 1000.0 ) );
+	AppendTypeTotals( out_json, m_sentCounts, m_sentBytes );
+	out_json->append( ",\"received\":" );
+	AppendTypeTotals( out_json, m_receivedCounts, m_receivedBytes );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+uint64_t ConnectionTelemetry::GetRoundTripSampleCount( ) const
+{
+	uint64_t sampleCount = 0;
+	for( size_t bucket = 0; bucket < ROUND_TRIP_BUCKET_COUNT; ++bucket )
+	{
+		sampleCount += m_roundTripBuckets[bucket];
+	}
+	return sampleCount;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+uint64_t ConnectionTelemetry::GetSentBytes( ) const
+{
+	uint64_t totalBytes = 0;
+	for( size_t type = 0; type < MESSAGE_TYPE_COUNT; ++type )
+	{
+		totalBytes += m_sentBytes[type];
+	}
+	return totalBytes;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+uint64_t ConnectionTelemetry::GetReceivedBytes( ) const
+{
+	uint64_t totalBytes = 0;
+	for( size_t type = 0; type < MESSAGE_TYPE_COUNT; ++type )
+	{
+		totalBytes += m_receivedBytes[type];
+	}
+	return totalBytes;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Object keyed by message type, types never seen are left out
+STATIC void ConnectionTelemetry::AppendTypeTotals( std::string * out_json, uint64_t const * counts, uint64_t const * bytes )
+{
+	out_json->append( "{" );
+	bool first = true;
+	for( size_t type = 0; type < MESSAGE_TYPE_COUNT; ++type )
+	{
+		if( counts[type] == 0 )
+		{
+			continue;
+		}
+		out_json->append( Stringf( "%s\"%u\":[%llu,%llu]",
+			first ? "" : ",",
+			(unsigned int) type,
+			(unsigned long long) counts[type],
+			(unsigned long long) bytes[type] ) );
+		first = false;
+	}
+	out_json->append( "}" );
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include "Engine/Core/EngineCommon.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+// Running counters for one connection: a round trip histogram and message counts and bytes per
+// type in each direction. Updated on the send and receive paths with plain increments, read
+// under the net lock. Counts since the connection was made, readers diff consecutive exports.
+class ConnectionTelemetry
+{
+//-------------------------------------------------------------------------------------------------
+// Static Members
+//-------------------------------------------------------------------------------------------------
+public:
+	static size_t const ROUND_TRIP_BUCKET_COUNT = 12; //Doubling from 1ms, the last bucket is everything over 1s
+	static size_t const MESSAGE_TYPE_COUNT = 256;
+
+//-------------------------------------------------------------------------------------------------
+// Members
+//-------------------------------------------------------------------------------------------------
+private:
+	uint64_t m_roundTripBuckets[ROUND_TRIP_BUCKET_COUNT];
+	double m_maxRoundTrip;
+	uint64_t m_sentCounts[MESSAGE_TYPE_COUNT];
+	uint64_t m_sentBytes[MESSAGE_TYPE_COUNT];
+	uint64_t m_receivedCounts[MESSAGE_TYPE_COUNT];
+	uint64_t m_receivedBytes[MESSAGE_TYPE_COUNT];
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+public:
+	static double GetBucketLimitMilliseconds( size_t bucket );
+
+	ConnectionTelemetry( );
+
+	void AddRoundTripSample( double seconds );
+	void AddMessageSent( byte_t type, size_t size );
+	void AddMessageReceived( byte_t type, size_t size );
+	void Reset( );
+	void AppendJSON( std::string * out_json ) const;
+
+	uint64_t GetRoundTripSampleCount( ) const;
+	uint64_t GetSentBytes( ) const;
+	uint64_t GetReceivedBytes( ) const;
+
+private:
+	static void AppendTypeTotals( std::string * out_json, uint64_t const * counts, uint64_t const * bytes );
+};
\ No newline at end of file
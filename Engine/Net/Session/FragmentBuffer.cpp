@@ -0,0 +1,153 @@
+#include "Engine/Net/Session/FragmentBuffer.hpp"
+
+#include "Engine/Net/Session/NetMessage.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+// An empty payload still takes one fragment so the receiver gets the message
+STATIC size_t FragmentBuffer::GetFragmentCount( size_t dataSize )
+{
+	if( dataSize == 0 )
+	{
+		return 1;
+	}
+	return ( dataSize + FRAGMENT_DATA_SIZE - 1 ) / FRAGMENT_DATA_SIZE;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// data and dataSize are the whole payload, this writes the header and the fragmentIndex'th slice
+STATIC void FragmentBuffer::WriteFragment( NetMessage * out_fragment, uint16_t groupID, byte_t type, size_t fragmentIndex, byte_t const * data, size_t dataSize )
+{
+	size_t offset = fragmentIndex * FRAGMENT_DATA_SIZE;
+	size_t fragmentSize = dataSize - offset;
+	if( fragmentSize > FRAGMENT_DATA_SIZE )
+	{
+		fragmentSize = FRAGMENT_DATA_SIZE;
+	}
+
+	out_fragment->Write<uint16_t>( groupID );
+	out_fragment->Write<byte_t>( type );
+	out_fragment->Write<uint8_t>( (uint8_t) fragmentIndex );
+	out_fragment->Write<uint8_t>( (uint8_t) GetFragmentCount( dataSize ) );
+	if( fragmentSize > 0 )
+	{
+		out_fragment->WriteForward( data + offset, fragmentSize );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+FragmentBuffer::FragmentBuffer( )
+	: m_receivedMask( 0U )
+	, m_groupID( 0 )
+	, m_type( 0 )
+	, m_fragmentCount( 0 )
+	, m_receivedCount( 0 )
+	, m_size( 0 )
+	, m_started( false )
+{
+	//Nothing
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Returns true when this fragment completes its message. A new group ID drops whatever was left of
+// the last one, the sender only starts a group after queueing every fragment of the one before.
+bool FragmentBuffer::AddFragment( NetMessage const & fragment )
+{
+	uint16_t groupID;
+	byte_t type;
+	uint8_t fragmentIndex;
+	uint8_t fragmentCount;
+	if( !fragment.Read<uint16_t>( &groupID ) || !fragment.Read<byte_t>( &type ) ||
+		!fragment.Read<uint8_t>( &fragmentIndex ) || !fragment.Read<uint8_t>( &fragmentCount ) )
+	{
+		return false;
+	}
+	if( fragmentCount == 0 || fragmentCount > MAX_FRAGMENTS || fragmentIndex >= fragmentCount )
+	{
+		return false;
+	}
+
+	if( !m_started || groupID != m_groupID || IsComplete( ) )
+	{
+		Start( groupID, type, fragmentCount );
+	}
+	if( type != m_type || fragmentCount != m_fragmentCount )
+	{
+		return false;
+	}
+
+	uint64_t fragmentBit = 1ULL << fragmentIndex;
+	if( ( m_receivedMask & fragmentBit ) != 0U )
+	{
+		return false;
+	}
+
+	//Only the last fragment can be short
+	size_t fragmentSize = fragment.GetReadableBytesLeft( );
+	bool isLast = ( fragmentIndex == fragmentCount - 1 );
+	if( fragmentSize > FRAGMENT_DATA_SIZE || ( !isLast && fragmentSize != FRAGMENT_DATA_SIZE ) )
+	{
+		return false;
+	}
+	if( fragmentSize > 0 && !fragment.ReadForward( &m_data[fragmentIndex * FRAGMENT_DATA_SIZE], fragmentSize ) )
+	{
+		return false;
+	}
+
+	if( isLast )
+	{
+		m_size = fragmentIndex * FRAGMENT_DATA_SIZE + fragmentSize;
+	}
+	m_receivedMask |= fragmentBit;
+	++m_receivedCount;
+	return IsComplete( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+byte_t * FragmentBuffer::GetData( )
+{
+	return m_data.data( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t FragmentBuffer::GetSize( ) const
+{
+	return m_size;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+byte_t FragmentBuffer::GetType( ) const
+{
+	return m_type;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool FragmentBuffer::IsComplete( ) const
+{
+	return m_started && m_receivedCount == m_fragmentCount;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// The buffer only grows, a connection that sent one big message will likely send another
+void FragmentBuffer::Start( uint16_t groupID, byte_t type, uint8_t fragmentCount )
+{
+	m_groupID = groupID;
+	m_type = type;
+	m_fragmentCount = fragmentCount;
+	m_receivedCount = 0;
+	m_receivedMask = 0U;
+	m_size = 0;
+	m_started = true;
+	if( m_data.size( ) < fragmentCount * FRAGMENT_DATA_SIZE )
+	{
+		m_data.resize( fragmentCount * FRAGMENT_DATA_SIZE );
+	}
+}
\ No newline at end of file
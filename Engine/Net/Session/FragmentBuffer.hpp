@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include "Engine/Core/EngineCommon.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+class NetMessage;
+
+
+//-------------------------------------------------------------------------------------------------
+// Reassembly for one connection's fragmented messages. Each fragment is its own reliable, so acks
+// and resends are per fragment. They arrive in order on NetSession::FRAGMENT_CHANNEL, but are
+// still slotted by index with a received mask so a duplicate or stray can't corrupt the payload.
+// Fragment wire format: group ID, inner type, fragment index, fragment count, then the data.
+class FragmentBuffer
+{
+//-------------------------------------------------------------------------------------------------
+// Static Members
+//-------------------------------------------------------------------------------------------------
+public:
+	static size_t const FRAGMENT_DATA_SIZE = 1000; //Every fragment but the last, fits a NetMessage with the header
+	static size_t const MAX_FRAGMENTS = 64; //One bit each in the received mask
+	static size_t const MAX_SIZE = FRAGMENT_DATA_SIZE * MAX_FRAGMENTS;
+
+//-------------------------------------------------------------------------------------------------
+// Members
+//-------------------------------------------------------------------------------------------------
+private:
+	std::vector<byte_t> m_data;
+	uint64_t m_receivedMask;
+	uint16_t m_groupID;
+	byte_t m_type;
+	uint8_t m_fragmentCount;
+	uint8_t m_receivedCount;
+	size_t m_size;
+	bool m_started;
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+public:
+	static size_t GetFragmentCount( size_t dataSize );
+	static void WriteFragment( NetMessage * out_fragment, uint16_t groupID, byte_t type, size_t fragmentIndex, byte_t const * data, size_t dataSize );
+
+	FragmentBuffer( );
+
+	bool AddFragment( NetMessage const & fragment );
+	byte_t * GetData( );
+	size_t GetSize( ) const;
+	byte_t GetType( ) const;
+	bool IsComplete( ) const;
+
+private:
+	void Start( uint16_t groupID, byte_t type, uint8_t fragmentCount );
+};
\ No newline at end of file
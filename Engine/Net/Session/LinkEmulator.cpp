@@ -0,0 +1,361 @@
+#include "Engine/Net/Session/LinkEmulator.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+
+//-------------------------------------------------------------------------------------------------
+// name, latency, jitter, good>bad, bad>good, good loss, bad loss, duplicate, reorder, reorder delay, bandwidth, queue, mtu
+STATIC LinkProfile const LinkProfile::NONE = { "none", 0.0, 0.0, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.0, 0.0, 0, NetPacket::MAX_SIZE };
+
+
+//-------------------------------------------------------------------------------------------------
+static LinkProfile const PRESETS[] =
+{
+	{ "none", 0.0, 0.0, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.0, 0.0, 0, NetPacket::MAX_SIZE },
+	{ "lan", 0.001, 0.0005, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.0, 0.0, 0, NetPacket::MAX_SIZE },
+	{ "broadband", 0.015, 0.002, 0.001f, 0.5f, 0.001f, 0.2f, 0.f, 0.f, 0.0, 1000000.0, 64 * 1024, NetPacket::MAX_SIZE },
+	{ "wifi", 0.005, 0.004, 0.01f, 0.3f, 0.002f, 0.3f, 0.001f, 0.005f, 0.01, 0.0, 0, NetPacket::MAX_SIZE },
+	{ "mobile", 0.05, 0.02, 0.02f, 0.2f, 0.01f, 0.5f, 0.002f, 0.02f, 0.03, 256.0 * 1024.0, 32 * 1024, NetPacket::MAX_SIZE },
+	{ "transcontinental", 0.075, 0.005, 0.001f, 0.5f, 0.002f, 0.2f, 0.f, 0.001f, 0.01, 0.0, 0, NetPacket::MAX_SIZE },
+	{ "vpn", 0.03, 0.005, 0.f, 0.f, 0.001f, 0.f, 0.f, 0.f, 0.0, 0.0, 0, 1280 },
+	{ "terrible", 0.15, 0.05, 0.05f, 0.1f, 0.02f, 0.7f, 0.01f, 0.05f, 0.05, 64.0 * 1024.0, 16 * 1024, NetPacket::MAX_SIZE },
+};
+static size_t const PRESET_COUNT = sizeof( PRESETS ) / sizeof( PRESETS[0] );
+
+
+//-------------------------------------------------------------------------------------------------
+// std heap functions build a max-heap, so order by later release to get the earliest on top
+static bool IsLaterRelease( EmulatedPacket const * first, EmulatedPacket const * second )
+{
+	if( first->releaseTime != second->releaseTime )
+	{
+		return first->releaseTime > second->releaseTime;
+	}
+	return first->order > second->order;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC size_t LinkProfile::GetPresetCount( )
+{
+	return PRESET_COUNT;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC LinkProfile const & LinkProfile::GetPreset( size_t presetIndex )
+{
+	if( presetIndex >= PRESET_COUNT )
+	{
+		return NONE;
+	}
+	return PRESETS[presetIndex];
+}
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC LinkProfile const * LinkProfile::FindPreset( char const * presetName )
+{
+	for( size_t presetIndex = 0; presetIndex < PRESET_COUNT; ++presetIndex )
+	{
+		if( strcmp( PRESETS[presetIndex].name, presetName ) == 0 )
+		{
+			return &PRESETS[presetIndex];
+		}
+	}
+	return nullptr;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool LinkProfile::IsPassthrough( ) const
+{
+	bool canLose = goodLossRate > 0.f || ( goodToBadChance > 0.f && badLossRate > 0.f );
+	return latency <= 0.0
+		&& jitter <= 0.0
+		&& !canLose
+		&& duplicateRate <= 0.f
+		&& reorderRate <= 0.f
+		&& bandwidth <= 0.0
+		&& mtu >= NetPacket::MAX_SIZE;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+LinkEmulator::LinkEmulator( uint64_t seed )
+	: m_profile( LinkProfile::NONE )
+	, m_nextOrder( 0 )
+{
+	SetSeed( seed );
+	ResetStats( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+LinkEmulator::~LinkEmulator( )
+{
+	Clear( );
+	for( EmulatedPacket * packet : m_freePackets )
+	{
+		delete packet;
+	}
+	m_freePackets.clear( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Runs the packet through the profile, it comes back out of PopReady() unless it was lost
+void LinkEmulator::Submit( double currentTime, sockaddr_in const & address, byte_t const * data, size_t dataSize )
+{
+	++m_stats.submitted;
+
+	if( dataSize > m_profile.mtu )
+	{
+		++m_stats.mtuDropped;
+		return;
+	}
+
+	if( RollLoss( ) )
+	{
+		return;
+	}
+
+	//Wait behind whatever is already queued for the wire
+	double departureTime = currentTime;
+	if( m_profile.bandwidth > 0.0 )
+	{
+		if( m_wireFreeTime < currentTime )
+		{
+			m_wireFreeTime = currentTime;
+		}
+
+		double queuedBytes = ( m_wireFreeTime - currentTime ) * m_profile.bandwidth;
+		if( m_profile.maxQueueBytes > 0 && queuedBytes + (double) dataSize > (double) m_profile.maxQueueBytes )
+		{
+			++m_stats.queueDropped;
+			return;
+		}
+
+		m_wireFreeTime += (double) dataSize / m_profile.bandwidth;
+		departureTime = m_wireFreeTime;
+	}
+
+	double delay = m_profile.latency + m_profile.jitter * ( RandomZeroToOne( ) * 2.0 - 1.0 );
+	if( delay < 0.0 )
+	{
+		delay = 0.0;
+	}
+	double releaseTime = departureTime + delay;
+
+	if( RandomChance( m_profile.reorderRate ) )
+	{
+		//Held out of line, the packets behind it overtake
+		releaseTime += m_profile.reorderDelay;
+		++m_stats.reordered;
+	}
+	else
+	{
+		//Jitter stretches the gaps between packets but a single path keeps them in order
+		if( releaseTime < m_lastInOrderReleaseTime )
+		{
+			releaseTime = m_lastInOrderReleaseTime;
+		}
+		m_lastInOrderReleaseTime = releaseTime;
+	}
+
+	Hold( releaseTime, address, data, dataSize );
+
+	if( RandomChance( m_profile.duplicateRate ) )
+	{
+		++m_stats.duplicated;
+		Hold( releaseTime + m_profile.jitter * RandomZeroToOne( ), address, data, dataSize );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Hands over the next packet due by currentTime, give it back with Recycle()
+EmulatedPacket * LinkEmulator::PopReady( double currentTime )
+{
+	if( m_heldPackets.empty( ) || m_heldPackets.front( )->releaseTime > currentTime )
+	{
+		return nullptr;
+	}
+
+	std::pop_heap( m_heldPackets.begin( ), m_heldPackets.end( ), IsLaterRelease );
+	EmulatedPacket * packet = m_heldPackets.back( );
+	m_heldPackets.pop_back( );
+	++m_stats.delivered;
+	return packet;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void LinkEmulator::Recycle( EmulatedPacket * packet )
+{
+	m_freePackets.push_back( packet );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Drops everything still in flight
+void LinkEmulator::Clear( )
+{
+	for( EmulatedPacket * packet : m_heldPackets )
+	{
+		m_freePackets.push_back( packet );
+	}
+	m_heldPackets.clear( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+LinkProfile const & LinkEmulator::GetProfile( ) const
+{
+	return m_profile;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+uint64_t LinkEmulator::GetSeed( ) const
+{
+	return m_seed;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t LinkEmulator::GetHeldCount( ) const
+{
+	return m_heldPackets.size( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+LinkEmulatorStats const & LinkEmulator::GetStats( ) const
+{
+	return m_stats;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Keep routing through the link until the last held packet is out, even after switching to none
+bool LinkEmulator::IsActive( ) const
+{
+	return !m_profile.IsPassthrough( ) || !m_heldPackets.empty( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void LinkEmulator::SetProfile( LinkProfile const & profile )
+{
+	m_profile = profile;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Restarts the random sequence and link state so a run can be repeated exactly
+void LinkEmulator::SetSeed( uint64_t seed )
+{
+	m_seed = seed;
+
+	//Xorshift gets stuck on zero
+	m_randomState = seed != 0 ? seed : 0x9E3779B97F4A7C15ULL;
+	m_inBadState = false;
+	m_wireFreeTime = 0.0;
+	m_lastInOrderReleaseTime = 0.0;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void LinkEmulator::ResetStats( )
+{
+	memset( &m_stats, 0, sizeof( m_stats ) );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Steps the Gilbert-Elliott chain once per packet, then rolls against the current state's loss
+bool LinkEmulator::RollLoss( )
+{
+	if( m_inBadState )
+	{
+		if( RandomChance( m_profile.badToGoodChance ) )
+		{
+			m_inBadState = false;
+		}
+	}
+	else if( RandomChance( m_profile.goodToBadChance ) )
+	{
+		m_inBadState = true;
+	}
+
+	float lossRate = m_inBadState ? m_profile.badLossRate : m_profile.goodLossRate;
+	if( !RandomChance( lossRate ) )
+	{
+		return false;
+	}
+
+	++m_stats.lost;
+	if( m_inBadState )
+	{
+		++m_stats.burstLost;
+	}
+	return true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool LinkEmulator::RandomChance( float chance )
+{
+	if( chance <= 0.f )
+	{
+		return false;
+	}
+	return RandomZeroToOne( ) < (double) chance;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Xorshift64*, kept per link so its sequence only depends on the seed and this link's traffic
+double LinkEmulator::RandomZeroToOne( )
+{
+	m_randomState ^= m_randomState >> 12;
+	m_randomState ^= m_randomState << 25;
+	m_randomState ^= m_randomState >> 27;
+	uint64_t random = m_randomState * 0x2545F4914F6CDD1DULL;
+
+	//Top 53 bits fill a double's mantissa
+	return (double) ( random >> 11 ) * ( 1.0 / 9007199254740992.0 );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void LinkEmulator::Hold( double releaseTime, sockaddr_in const & address, byte_t const * data, size_t dataSize )
+{
+	if( m_heldPackets.size( ) >= MAX_HELD_PACKETS )
+	{
+		++m_stats.queueDropped;
+		return;
+	}
+
+	EmulatedPacket * packet = nullptr;
+	if( m_freePackets.empty( ) )
+	{
+		packet = new EmulatedPacket( );
+	}
+	else
+	{
+		packet = m_freePackets.back( );
+		m_freePackets.pop_back( );
+	}
+
+	packet->address = address;
+	packet->releaseTime = releaseTime;
+	packet->order = m_nextOrder++;
+	packet->dataSize = dataSize;
+	memcpy( packet->data, data, dataSize );
+
+	m_heldPackets.push_back( packet );
+	std::push_heap( m_heldPackets.begin( ), m_heldPackets.end( ), IsLaterRelease );
+}
\ No newline at end of file
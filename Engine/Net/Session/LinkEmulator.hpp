@@ -0,0 +1,135 @@
+#pragma once
+
+#include <vector>
+#include "Engine/Net/UDPIP/UDPSock.hpp"
+#include "Engine/Net/Session/NetPacket.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+// How one direction of the emulated link behaves. Times are one way, in seconds.
+class LinkProfile
+{
+//-------------------------------------------------------------------------------------------------
+// Static Members
+//-------------------------------------------------------------------------------------------------
+public:
+	static LinkProfile const NONE;
+
+//-------------------------------------------------------------------------------------------------
+// Members
+//-------------------------------------------------------------------------------------------------
+public:
+	char const * name;
+	double latency;
+	double jitter; //Spread either side of latency, does not reorder on its own
+
+	//Gilbert-Elliott loss, the link flips between a good and a bursty bad state per packet
+	float goodToBadChance;
+	float badToGoodChance;
+	float goodLossRate;
+	float badLossRate;
+
+	float duplicateRate;
+	float reorderRate;
+	double reorderDelay; //Extra hold on a reordered packet so the ones behind it overtake
+
+	double bandwidth; //Bytes per second, 0 is unlimited
+	size_t maxQueueBytes; //Tail drop once this much is waiting for the wire
+	size_t mtu; //Bigger packets are dropped
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+public:
+	static size_t GetPresetCount( );
+	static LinkProfile const & GetPreset( size_t presetIndex );
+	static LinkProfile const * FindPreset( char const * presetName );
+
+	bool IsPassthrough( ) const;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+class EmulatedPacket
+{
+public:
+	sockaddr_in address;
+	double releaseTime;
+	uint64_t order; //Breaks ties between equal release times
+	size_t dataSize;
+	byte_t data[NetPacket::MAX_SIZE];
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Packets counted since the last ResetStats()
+class LinkEmulatorStats
+{
+public:
+	size_t submitted;
+	size_t delivered;
+	size_t lost;
+	size_t burstLost; //Subset of lost, dropped while in the bad state
+	size_t queueDropped;
+	size_t mtuDropped;
+	size_t duplicated;
+	size_t reordered;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// One direction of a simulated network link. Every random decision comes from its own seeded
+// generator, so the same seed and the same traffic drop, delay and reorder the same packets.
+class LinkEmulator
+{
+//-------------------------------------------------------------------------------------------------
+// Static Members
+//-------------------------------------------------------------------------------------------------
+public:
+	static size_t const MAX_HELD_PACKETS = 4096;
+
+//-------------------------------------------------------------------------------------------------
+// Members
+//-------------------------------------------------------------------------------------------------
+private:
+	LinkProfile m_profile;
+	uint64_t m_seed;
+	uint64_t m_randomState;
+	bool m_inBadState;
+	double m_wireFreeTime; //When the bandwidth limited wire finishes its current backlog
+	double m_lastInOrderReleaseTime;
+	uint64_t m_nextOrder;
+
+	//Min heap on release time, then order
+	std::vector<EmulatedPacket*> m_heldPackets;
+	std::vector<EmulatedPacket*> m_freePackets;
+	LinkEmulatorStats m_stats;
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+public:
+	LinkEmulator( uint64_t seed );
+	~LinkEmulator( );
+
+	void Submit( double currentTime, sockaddr_in const & address, byte_t const * data, size_t dataSize );
+	EmulatedPacket * PopReady( double currentTime );
+	void Recycle( EmulatedPacket * packet );
+	void Clear( );
+
+	LinkProfile const & GetProfile( ) const;
+	uint64_t GetSeed( ) const;
+	size_t GetHeldCount( ) const;
+	LinkEmulatorStats const & GetStats( ) const;
+	bool IsActive( ) const;
+
+	void SetProfile( LinkProfile const & profile );
+	void SetSeed( uint64_t seed );
+	void ResetStats( );
+
+private:
+	bool RollLoss( );
+	bool RandomChance( float chance );
+	double RandomZeroToOne( );
+	void Hold( double releaseTime, sockaddr_in const & address, byte_t const * data, size_t dataSize );
+};
\ No newline at end of file
@@ -1,36 +1,93 @@
 #include "Engine/Net/Session/NetConnection.hpp"
 
+#include <algorithm>
 #include "Engine/Core/Time.hpp"
 #include "Engine/DebugSystem/ErrorWarningAssert.hpp"
+#include "Engine/Net/Session/FragmentBuffer.hpp"
 #include "Engine/Net/Session/NetMessage.hpp"
+#include "Engine/Net/Session/NetMessageArena.hpp"
 #include "Engine/Net/Session/NetSession.hpp"
 #include "Engine/Net/Session/NetPacket.hpp"
+#include "Engine/Net/Session/RateController.hpp"
+#include "Engine/Net/Session/SequenceChannel.hpp"
 #include "Engine/Utils/MathUtils.hpp"
+#include "Engine/Utils/StringUtils.hpp"
 
 
 //-------------------------------------------------------------------------------------------------
 STATIC double NetConnection::s_resendDelaySeconds = 0.2; //Default 200ms
+STATIC double NetConnection::s_minResendDelaySeconds = 0.05;
+STATIC double NetConnection::s_maxResendDelaySeconds = 2.0;
+STATIC double NetConnection::s_clockGranularitySeconds = 1.0 / 60.0;
 
 
 //-------------------------------------------------------------------------------------------------
-NetConnection::NetConnection( unsigned char index, sockaddr_in const & address, std::string const & guid, std::string const & username, NetSession const * const session )
+// Quotes and backslashes escaped, control characters dropped
+static void AppendJSONString( std::string * out_json, char const * text )
+{
+	out_json->push_back( '"' );
+	for( char const * character = text; *character != '\0'; ++character )
+	{
+		if( *character == '"' || *character == '\\' )
+		{
+			out_json->push_back( '\\' );
+		}
+		if( (unsigned char) *character >= 0x20 )
+		{
+			out_json->push_back( *character );
+		}
+	}
+	out_json->push_back( '"' );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// std heap functions build a max-heap, so order by later deadline to get the earliest on top
+static bool IsLaterResend( ReliableResend const & first, ReliableResend const & second )
+{
+	return first.deadline > second.deadline;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+NetConnection::NetConnection( uint16_t index, sockaddr_in const & address, std::string const & guid, std::string const & username, NetSession const * const session )
 	: m_connectionInfo( index, address, guid.c_str( ), username.c_str( ) )
 	, m_session( session )
-	, m_timeLastSent( Time::TOTAL_SECONDS )
-	, m_timeLastRecv( Time::TOTAL_SECONDS )
+	, m_timeLastSent( Time::GetCurrentTimeSeconds( ) )
+	, m_timeLastRecv( Time::GetCurrentTimeSeconds( ) )
 	, m_dropsCounted( 0 )
 	, m_receivedCounted( 0 )
 	, m_nextToSendAck( 0 )
 	, m_mostRecentReceivedAck( AckBundle::INVALID_ACK_ID )
 	, m_mostRecentReceivedAcksBitfield( 0 )
+	, m_ackPending( false )
 	, m_nextToSendReliableID( 0 )
 	, m_nextUnconfirmedReliableID( 0 )
 	, m_oldestUnconfirmedReliableID( 0 )
 	, m_nextUnreceivedReliableID( 0 )
 	, m_oldestUnreceivedReliableID( 0 )
 	, m_lastJoinRequestNuonce( (uint32_t) -1 )
+	, m_sentReliableCount( 0 )
+	, m_nextFragmentGroupID( 0 )
+	, m_fragmentBuffer( nullptr )
+	, m_sentDeliveryCount( 0 )
 	, m_roundTripTime( s_resendDelaySeconds )
+	, m_roundTripTimeVariance( 0.0 )
+	, m_resendTimeout( s_resendDelaySeconds )
+	, m_hasRoundTripSample( false )
+	, m_resendCount( 0 )
+	, m_reliableSendCount( 0 )
+	, m_rateController( new AIMDRateController( Time::GetCurrentTimeSeconds( ) ) )
+	, m_compressPackets( false )
+	, m_telemetry( )
 {
+	//Initialize sent reliable slots
+	for( size_t slotIndex = 0; slotIndex < MAX_RELIABLE_RANGE; ++slotIndex )
+	{
+		m_sentReliableMessages[slotIndex] = nullptr;
+	}
+	m_resendQueue.reserve( MAX_RELIABLE_RANGE );
+
 	//Initialize confirmed reliable IDs
 	for( size_t confirmIndex = 0; confirmIndex < MAX_RELIABLE_RANGE; ++confirmIndex )
 	{
@@ -65,43 +122,54 @@ NetConnection::NetConnection( unsigned char index, sockaddr_in const & address,
 NetConnection::~NetConnection( )
 {
 	//Destroy all remaining unreliables
-	while( m_unsentUnreliableMessages.size( ) > 0 )
-	{
-		NetMessage const * message = m_unsentUnreliableMessages.front( );
-		delete message;
-		m_unsentUnreliableMessages.pop( );
-	}
+	CleanUpRemainingUnreliables( );
 
 	//Destroy all remaining reliables
-	while( m_unsentReliableMessages.size( ) > 0 )
+	while( !m_unsentReliableMessages.IsEmpty( ) )
 	{
-		NetMessage const * message = m_unsentReliableMessages.front( );
-		delete message;
-		m_unsentReliableMessages.pop( );
+		NetMessage * message = m_unsentReliableMessages.Front( );
+		m_session->GetMessageArena( ).Release( message );
+		m_unsentReliableMessages.Pop( );
 	}
-	while( m_sentReliableMessages.size( ) > 0 )
+	for( size_t slotIndex = 0; slotIndex < MAX_RELIABLE_RANGE; ++slotIndex )
 	{
-		NetMessage const * message = m_sentReliableMessages.front( );
-		delete message;
-		m_sentReliableMessages.pop( );
+		if( m_sentReliableMessages[slotIndex] )
+		{
+			m_session->GetMessageArena( ).Release( m_sentReliableMessages[slotIndex] );
+			m_sentReliableMessages[slotIndex] = nullptr;
+		}
 	}
+	m_sentReliableCount = 0;
+	m_resendQueue.clear( );
+
+	delete m_rateController;
+	m_rateController = nullptr;
 
 	//Destroy all messages in channels
 	for( size_t channelIndex = 0; channelIndex < MAX_SEQUENCE_CHANNELS; ++channelIndex )
 	{
-		while( m_sequenceChannels[channelIndex] )
+		if( m_sequenceChannels[channelIndex] )
 		{
-			NetMessage * deleteMe = m_sequenceChannels[channelIndex];
-			m_sequenceChannels[channelIndex] = m_sequenceChannels[channelIndex]->m_next;
-			delete deleteMe;
+			m_sequenceChannels[channelIndex]->Clear( m_session->GetMessageArena( ) );
+			delete m_sequenceChannels[channelIndex];
+			m_sequenceChannels[channelIndex] = nullptr;
 		}
 	}
+
+	delete m_fragmentBuffer;
+	m_fragmentBuffer = nullptr;
 }
 
 
 //-------------------------------------------------------------------------------------------------
 void NetConnection::AddMessage( NetMessage & message )
 {
+	//The network thread queues it once it picks it up from the handoff
+	if( m_session && m_session->DeferMessage( this, message ) )
+	{
+		return;
+	}
+
 	//Set index
 	if( m_session )
 	{
@@ -124,15 +192,70 @@ void NetConnection::AddMessage( NetMessage & message )
 	//Check where it belongs
 	if( def->IsReliable( ) )
 	{
-		m_unsentReliableMessages.push( message.Copy( ) );
+		m_unsentReliableMessages.Push( m_session->GetMessageArena( ).Share( message ) );
+	}
+	else if( def->IsCoalesced( ) )
+	{
+		AddCoalescedMessage( message );
 	}
 	else
 	{
-		m_unsentUnreliableMessages.push( message.Copy( ) );
+		m_unsentUnreliableMessages[def->priority].Push( m_session->GetMessageArena( ).Share( message ) );
 	}
 }
 
 
+//-------------------------------------------------------------------------------------------------
+// Latest state wins, replaces a queued message with the same type and key in place so the stale
+// one is never written
+void NetConnection::AddCoalescedMessage( NetMessage & message )
+{
+	NetMessageDefinition const * def = message.m_definition;
+	NetMessageQueue & unsentMessages = m_unsentUnreliableMessages[def->priority];
+	uint64_t key = ( (uint64_t) def->type << 32 ) | message.m_coalesceKey;
+
+	std::map<uint64_t, size_t>::iterator found = m_coalescedMessages.find( key );
+	if( found != m_coalescedMessages.end( ) )
+	{
+		//Make sure it hasn't been sent since
+		NetMessage const * queued = unsentMessages.Get( found->second );
+		if( queued && queued->m_definition == def && queued->m_coalesceKey == message.m_coalesceKey )
+		{
+			NetMessage * replaced = unsentMessages.Replace( found->second, m_session->GetMessageArena( ).Share( message ) );
+			m_session->GetMessageArena( ).Release( replaced );
+			return;
+		}
+	}
+
+	m_coalescedMessages[key] = unsentMessages.Push( m_session->GetMessageArena( ).Share( message ) );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// For payloads bigger than one NetMessage, up to FragmentBuffer::MAX_SIZE. Every fragment is its own
+// reliable, so only the lost ones are resent, and the receiver hands the whole payload to type's
+// callback once they're all in. Returns false if it's too big, type isn't registered, or type is
+// connectionless, which the receiver would drop on reassembly.
+bool NetConnection::AddFragmentedMessage( byte_t type, byte_t const * data, size_t dataSize )
+{
+	NetMessageDefinition const * def = m_session->GetDefinition( (eNetMessageType) type );
+	if( def == nullptr || def->IsConnectionless( ) || type == eNetMessageType_FRAGMENT || dataSize > FragmentBuffer::MAX_SIZE )
+	{
+		return false;
+	}
+
+	uint16_t groupID = m_nextFragmentGroupID++;
+	size_t fragmentCount = FragmentBuffer::GetFragmentCount( dataSize );
+	for( size_t fragmentIndex = 0; fragmentIndex < fragmentCount; ++fragmentIndex )
+	{
+		OwnedNetMessage fragment( eNetMessageType_FRAGMENT );
+		FragmentBuffer::WriteFragment( &fragment, groupID, type, fragmentIndex, data, dataSize );
+		AddMessage( fragment );
+	}
+	return true;
+}
+
+
 //-------------------------------------------------------------------------------------------------
 void NetConnection::AddBundle( AckBundle const & bundle )
 {
@@ -150,6 +273,10 @@ void NetConnection::AddBundle( AckBundle const & bundle )
 		else
 		{
 			++m_dropsCounted;
+			if( !m_bundles[slot].m_lossReported )
+			{
+				m_rateController->OnPacketLost( );
+			}
 		}
 
 		//Reset them if they get too high
@@ -173,6 +300,9 @@ void NetConnection::SendPacket( )
 		return;
 	}
 
+	//Refill this tick's budget
+	m_rateController->Update( Time::GetCurrentTimeSeconds( ), GetRoundTripTime( ) );
+
 	//Heartbeat is a packet with no messages
 	bool heartbeat = IsTimeForHeartbeat( );
 
@@ -185,30 +315,41 @@ void NetConnection::SendPacket( )
 			return;
 		}
 		//If there is nothing to send, don't continue
-		else if( m_unsentUnreliableMessages.size( ) == 0 &&
-			m_unsentReliableMessages.size() == 0 &&
-			m_sentReliableMessages.size() == 0 )
+		else if( !HasUnsentUnreliables( ) &&
+			m_unsentReliableMessages.IsEmpty( ) &&
+			m_sentReliableCount == 0 )
 		{
-		
-			return;
+			//Nothing to say, but acks still go out so the other side's round trip doesn't wait on our next message
+			if( !m_ackPending )
+			{
+				return;
+			}
+			heartbeat = true;
 		}
 	}
 
-	//Keep sending packets until we have no more data to send, up to MAX_PACKET_SEND_AMOUNT_PER_CONNECTION
+	//Keep sending packets until we have no more data to send or the rate controller is out of budget,
+	//never more than MAX_PACKET_SEND_AMOUNT_PER_CONNECTION
 	m_lastOutgoingPackageCount = 0;
 	m_lastOutgoingMessageCount = 0;
 	m_lastOutgoingByteCountPacketHeader = 0;
 	m_lastOutgoingByteCountMessages = 0;
 	for( int numberOfPacketsSent = 0; numberOfPacketsSent < NetSession::MAX_PACKET_SEND_AMOUNT_PER_CONNECTION; ++numberOfPacketsSent )
 	{
+		//Heartbeats always go out, they carry our acks
+		if( !heartbeat && !m_rateController->CanSend( ) )
+		{
+			break;
+		}
+
 		//Setup packet Header
 		PacketHeader header;
 		header.fromConnIndex = m_connectionInfo.m_index;
 		header.packetAck = GetNextAck( );
 		header.mostRecentReceivedAck = m_mostRecentReceivedAck;
 		header.previousReceivedAcksBitfield = m_mostRecentReceivedAcksBitfield;
+		m_ackPending = false;
 		AckBundle bundle( header.packetAck );
-		NetSession::m_NetworkTrafficActivity.Printf( "Sending Packet (%u) to Connection %u", header.packetAck, m_connectionInfo.m_index );
 
 		//Create packet
 		NetPacket packet;
@@ -218,7 +359,7 @@ void NetConnection::SendPacket( )
 		size_t numMessagesBookmark = packet.Reserve<uint8_t>( 0U );
 
 		//Update sent time stamp
-		m_timeLastSent = Time::TOTAL_SECONDS;
+		m_timeLastSent = Time::GetCurrentTimeSeconds( );
 
 		//Immediately send heartbeat, and don't send anything else
 		if( heartbeat )
@@ -228,7 +369,8 @@ void NetConnection::SendPacket( )
 			m_lastOutgoingMessageCount = 0;
 			m_lastOutgoingByteCountMessages = 0;
 			m_lastOutgoingByteCountPacketHeader = header.GetTotalWrittenHeaderSize( );
-			m_session->SendPacket( m_connectionInfo.m_address, packet.GetBuffer( ), packet.GetSize( ) );
+			size_t sentSize = m_session->SendPacket( m_connectionInfo.m_address, packet.GetBuffer( ), packet.GetSize( ), m_compressPackets );
+			m_rateController->OnPacketSent( sentSize );
 			break;
 		}
 		else
@@ -240,7 +382,7 @@ void NetConnection::SendPacket( )
 			totalBytesWritten += bytesWritten;
 			count += WriteUnsentReliables( &packet, &bundle, &bytesWritten );
 			totalBytesWritten += bytesWritten;
-			count += WriteUnsentUnreliables( &packet, &bytesWritten );
+			count += WriteUnsentUnreliables( &packet, &bundle, &bytesWritten );
 			totalBytesWritten += bytesWritten;
 
 			//We have no more messages to send, but we will send at least one to keep the connection
@@ -259,7 +401,8 @@ void NetConnection::SendPacket( )
 
 			//Update message count
 			packet.WriteAt<uint8_t>( numMessagesBookmark, (uint8_t)count );
-			m_session->SendPacket( m_connectionInfo.m_address, packet.GetBuffer( ), packet.GetSize( ) );
+			size_t sentSize = m_session->SendPacket( m_connectionInfo.m_address, packet.GetBuffer( ), packet.GetSize( ), m_compressPackets );
+			m_rateController->OnPacketSent( sentSize );
 		}
 		AddBundle( bundle );
 	}
@@ -274,41 +417,63 @@ size_t NetConnection::WriteSentReliables( NetPacket * packet, AckBundle * bundle
 	//Keep track of how many we are writing
 	size_t messageCount = 0;
 	*out_bytesWritten = 0;
-	while( !m_sentReliableMessages.empty( ) )
+	while( !m_resendQueue.empty( ) )
 	{
-		NetMessage * message = m_sentReliableMessages.front( );
+		//If there are no more old reliables, return
+		ReliableResend next = m_resendQueue.front( );
+		if( next.deadline >= Time::GetCurrentTimeSeconds( ) )
+		{
+			break;
+		}
+
+		//Confirmed since it was scheduled, its slot was already released
+		NetMessage * message = m_sentReliableMessages[next.reliableID % MAX_RELIABLE_RANGE];
+		if( message == nullptr || message->m_reliableID != next.reliableID )
+		{
+			std::pop_heap( m_resendQueue.begin( ), m_resendQueue.end( ), IsLaterResend );
+			m_resendQueue.pop_back( );
+			continue;
+		}
 
 		//Delete confirmed reliables
 		if( IsReliableIDConfirmed( message->m_reliableID ) )
 		{
-			m_sentReliableMessages.pop( );
-			delete message;
+			std::pop_heap( m_resendQueue.begin( ), m_resendQueue.end( ), IsLaterResend );
+			m_resendQueue.pop_back( );
+			ReleaseSentReliable( next.reliableID );
+			continue;
+		}
+
+		//Timeout went up since it was scheduled, push it back
+		if( !IsMessageOld( message ) )
+		{
+			std::pop_heap( m_resendQueue.begin( ), m_resendQueue.end( ), IsLaterResend );
+			m_resendQueue.pop_back( );
+			ScheduleResend( message );
 			continue;
 		}
 
 		//Resend old reliables
-		if( IsMessageOld( message ) )
+		if( packet->WriteMessage( message ) )
 		{
-			if( packet->WriteMessage( message ) )
-			{
-				++messageCount;
-				*out_bytesWritten += message->GetTotalWrittenMessageSize( );
+			++messageCount;
+			*out_bytesWritten += message->GetTotalWrittenMessageSize( );
+			m_telemetry.AddMessageSent( message->m_type, message->GetTotalWrittenMessageSize( ) );
 
-				m_sentReliableMessages.pop( );
-				bundle->AddReliableID( message->m_reliableID );
-				message->m_sentTimeStamp = Time::TOTAL_SECONDS;
-				m_sentReliableMessages.push( message );
-			}
-			else
+			std::pop_heap( m_resendQueue.begin( ), m_resendQueue.end( ), IsLaterResend );
+			m_resendQueue.pop_back( );
+			bundle->AddReliableID( message->m_reliableID );
+			message->m_sentTimeStamp = Time::GetCurrentTimeSeconds( );
+			if( message->m_resendCount < MAX_RESEND_BACKOFF )
 			{
-				//Unable to write message, time to return
-				break;
+				++message->m_resendCount;
 			}
+			++m_resendCount;
+			ScheduleResend( message );
 		}
-
-		//If there are no more old reliables, return
 		else
 		{
+			//Unable to write message, time to return
 			break;
 		}
 	}
@@ -323,14 +488,15 @@ size_t NetConnection::WriteUnsentReliables( NetPacket * packet, AckBundle * bund
 	//Keep track of how many we are writing
 	uint8_t messageCount = 0;
 	*out_bytesWritten = 0;
-	while( !m_unsentReliableMessages.empty( ) && CanSendNewReliables( ) )
+	while( !m_unsentReliableMessages.IsEmpty( ) && CanSendNewReliables( ) )
 	{
-		NetMessage * message = m_unsentReliableMessages.front( );
+		NetMessage * message = m_unsentReliableMessages.Front( );
 
 		if( packet->CanWriteMessage( message ) )
 		{
 			++messageCount;
 			*out_bytesWritten += message->GetTotalWrittenMessageSize( );
+			m_telemetry.AddMessageSent( message->m_type, message->GetTotalWrittenMessageSize( ) );
 
 			//Assign next ID
 			message->m_reliableID = GetNextReliableID( );
@@ -338,11 +504,14 @@ size_t NetConnection::WriteUnsentReliables( NetPacket * packet, AckBundle * bund
 			packet->WriteMessage( message );
 
 			//Remove from unsent
-			m_unsentReliableMessages.pop( );
-
-			//Add to sent
-			message->m_sentTimeStamp = Time::TOTAL_SECONDS;
-			m_sentReliableMessages.push( message );
+			m_unsentReliableMessages.Pop( );
+
+			//Add to sent, CanSendNewReliables keeps the window smaller than the slot range
+			message->m_sentTimeStamp = Time::GetCurrentTimeSeconds( );
+			m_sentReliableMessages[message->m_reliableID % MAX_RELIABLE_RANGE] = message;
+			++m_sentReliableCount;
+			++m_reliableSendCount;
+			ScheduleResend( message );
 		}
 		else
 		{
@@ -354,27 +523,42 @@ size_t NetConnection::WriteUnsentReliables( NetPacket * packet, AckBundle * bund
 
 
 //-------------------------------------------------------------------------------------------------
-size_t NetConnection::WriteUnsentUnreliables( NetPacket * packet, size_t * out_bytesWritten )
+size_t NetConnection::WriteUnsentUnreliables( NetPacket * packet, AckBundle * bundle, size_t * out_bytesWritten )
 {
 	//Keep track of how many we are writing
 	size_t messageCount = 0;
 	*out_bytesWritten = 0;
-	while( m_unsentUnreliableMessages.size() > 0 )
+
+	//Highest priority first, a smaller lower priority message can still fill the rest of the packet
+	for( int priority = eNetMessagePriority_COUNT - 1; priority >= 0; --priority )
 	{
-		//Get Message and Definition
-		NetMessage const * message = m_unsentUnreliableMessages.front( );
-		if( packet->WriteMessage( message ) )
+		NetMessageQueue & unsentMessages = m_unsentUnreliableMessages[priority];
+		while( !unsentMessages.IsEmpty( ) )
 		{
-			++messageCount;
-			*out_bytesWritten += message->GetTotalWrittenMessageSize( );
+			//Get Message and Definition
+			NetMessage * message = unsentMessages.Front( );
+			if( packet->WriteMessage( message ) )
+			{
+				++messageCount;
+				*out_bytesWritten += message->GetTotalWrittenMessageSize( );
+				m_telemetry.AddMessageSent( message->m_type, message->GetTotalWrittenMessageSize( ) );
 
-			m_unsentUnreliableMessages.pop( );
-			delete message;
-			message = nullptr;
-		}
-		else
-		{
-			break;
+				//Remember the tag so it can be reported when this packet is acked
+				if( message->m_deliveryTag != NetMessage::NO_DELIVERY_TAG )
+				{
+					m_sentDeliveryTags[m_sentDeliveryCount % MAX_TRACKED_DELIVERIES] = message->m_deliveryTag;
+					bundle->AddDeliveryIndex( m_sentDeliveryCount );
+					++m_sentDeliveryCount;
+				}
+
+				unsentMessages.Pop( );
+				m_session->GetMessageArena( ).Release( message );
+				message = nullptr;
+			}
+			else
+			{
+				break;
+			}
 		}
 	}
 
@@ -385,11 +569,16 @@ size_t NetConnection::WriteUnsentUnreliables( NetPacket * packet, size_t * out_b
 //-------------------------------------------------------------------------------------------------
 void NetConnection::CleanUpRemainingUnreliables( )
 {
-	while( m_unsentUnreliableMessages.size( ) > 0 )
+	m_coalescedMessages.clear( );
+	for( size_t priority = 0; priority < eNetMessagePriority_COUNT; ++priority )
 	{
-		NetMessage const * message = m_unsentUnreliableMessages.front( );
-		delete message;
-		m_unsentUnreliableMessages.pop( );
+		NetMessageQueue & unsentMessages = m_unsentUnreliableMessages[priority];
+		while( !unsentMessages.IsEmpty( ) )
+		{
+			NetMessage * message = unsentMessages.Front( );
+			m_session->GetMessageArena( ).Release( message );
+			unsentMessages.Pop( );
+		}
 	}
 }
 
@@ -397,6 +586,8 @@ void NetConnection::CleanUpRemainingUnreliables( )
 //-------------------------------------------------------------------------------------------------
 void NetConnection::ProcessMessage( NetSender const & sender, NetMessage const & message )
 {
+	m_telemetry.AddMessageReceived( message.m_type, message.GetTotalWrittenMessageSize( ) );
+
 	//Reliable
 	if( message.m_definition->IsReliable( ) )
 	{
@@ -409,7 +600,7 @@ void NetConnection::ProcessMessage( NetSender const & sender, NetMessage const &
 			}
 			else
 			{
-				message.Process( sender );
+				m_session->DeliverMessage( sender, message );
 			}
 		}
 
@@ -423,7 +614,7 @@ void NetConnection::ProcessMessage( NetSender const & sender, NetMessage const &
 		}
 		else
 		{
-			message.Process( sender );
+			m_session->DeliverMessage( sender, message );
 		}
 	}
 }
@@ -435,7 +626,7 @@ void NetConnection::ProcessReliableSequence( NetSender const & sender, NetMessag
 	byte_t channelID = message.m_definition->sequenceChannelID;
 	if( m_nextToReceiveReliableSequenceID[channelID] == message.m_sequenceID )
 	{
-		message.Process( sender );
+		m_session->DeliverMessage( sender, message );
 		++m_nextToReceiveReliableSequenceID[channelID];
 		ProcessNextInSequenceChannel( sender, channelID );
 	}
@@ -449,25 +640,19 @@ void NetConnection::ProcessReliableSequence( NetSender const & sender, NetMessag
 //-------------------------------------------------------------------------------------------------
 void NetConnection::ProcessNextInSequenceChannel( NetSender const & sender, byte_t sequenceChannelID )
 {
-	while( m_sequenceChannels[sequenceChannelID] )
+	SequenceChannel * channel = m_sequenceChannels[sequenceChannelID];
+	if( channel == nullptr )
 	{
-		if( m_sequenceChannels[sequenceChannelID]->m_sequenceID == m_nextToReceiveReliableSequenceID[sequenceChannelID] )
-		{
-			m_sequenceChannels[sequenceChannelID]->Process( sender );
-			NetMessage * deleteMe = m_sequenceChannels[sequenceChannelID];
-			m_sequenceChannels[sequenceChannelID] = m_sequenceChannels[sequenceChannelID]->m_next;
-			delete deleteMe;
-			deleteMe = nullptr;
-			if( m_sequenceChannels[sequenceChannelID] )
-			{
-				m_sequenceChannels[sequenceChannelID]->m_prev = nullptr;
-			}
-			++m_nextToReceiveReliableSequenceID[sequenceChannelID];
-		}
-		else
-		{
-			break;
-		}
+		return;
+	}
+
+	NetMessage * message = channel->TakeNext( m_nextToReceiveReliableSequenceID[sequenceChannelID] );
+	while( message )
+	{
+		m_session->DeliverMessage( sender, *message );
+		m_session->GetMessageArena( ).Release( message );
+		++m_nextToReceiveReliableSequenceID[sequenceChannelID];
+		message = channel->TakeNext( m_nextToReceiveReliableSequenceID[sequenceChannelID] );
 	}
 }
 
@@ -475,51 +660,18 @@ void NetConnection::ProcessNextInSequenceChannel( NetSender const & sender, byte
 //-------------------------------------------------------------------------------------------------
 void NetConnection::AddMessageToSequenceChannel( NetMessage const & message, byte_t sequenceChannelID )
 {
-	NetMessage * messageToAdd = message.Copy( );
-	NetMessage * channelIter = m_sequenceChannels[sequenceChannelID];
-
-	//if empty, make this head
-	if( channelIter == nullptr )
+	SequenceChannel * channel = m_sequenceChannels[sequenceChannelID];
+	if( channel == nullptr )
 	{
-		m_sequenceChannels[sequenceChannelID] = messageToAdd;
+		channel = new SequenceChannel( );
+		m_sequenceChannels[sequenceChannelID] = channel;
 	}
-	else
+
+	NetMessage * messageToAdd = m_session->GetMessageArena( ).Share( message );
+	if( !channel->Insert( messageToAdd, m_nextToReceiveReliableSequenceID[sequenceChannelID] ) )
 	{
-		while( channelIter )
-		{
-			//if this is smaller, insert
-			if( GreaterThanCycle( channelIter->m_sequenceID, messageToAdd->m_sequenceID ) )
-			{
-				messageToAdd->m_next = channelIter;
-				messageToAdd->m_prev = channelIter->m_prev;
-				channelIter->m_prev = messageToAdd;
-				if( messageToAdd->m_prev )
-				{
-					messageToAdd->m_prev->m_next = messageToAdd;
-				}
-				
-				//if this was head, update head
-				if( channelIter == m_sequenceChannels[sequenceChannelID] )
-				{
-					m_sequenceChannels[sequenceChannelID] = messageToAdd;
-				}
-				break;
-			}
-			else
-			{
-				//if reach end, add to back
-				if( channelIter->m_next == nullptr )
-				{
-					channelIter->m_next = messageToAdd;
-					messageToAdd->m_prev = channelIter;
-					break;
-				}
-				else
-				{
-					channelIter = channelIter->m_next;
-				}
-			}
-		}
+		ASSERT_RECOVERABLE( false, "Sequenced message outside the reorder window" );
+		m_session->GetMessageArena( ).Release( messageToAdd );
 	}
 }
 
@@ -530,8 +682,35 @@ void NetConnection::ProcessUnreliableSequence( NetSender const & sender, NetMess
 	//#TODO: Make sure this is okay
 	if( message.m_ackID >= m_mostRecentReceivedAck )
 	{
-		message.Process( sender );
+		m_session->DeliverMessage( sender, message );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Game thread, fragments come through OnFragment like any other callback. The reassembled message
+// reads straight out of the buffer, which isn't touched again until the next fragment arrives.
+void NetConnection::ProcessFragment( NetSender const & sender, NetMessage const & fragment )
+{
+	if( m_fragmentBuffer == nullptr )
+	{
+		m_fragmentBuffer = new FragmentBuffer( );
+	}
+
+	if( !m_fragmentBuffer->AddFragment( fragment ) )
+	{
+		return;
+	}
+
+	NetMessageDefinition const * def = m_session->GetDefinition( (eNetMessageType) m_fragmentBuffer->GetType( ) );
+	if( def == nullptr || def->IsConnectionless( ) || def->type == eNetMessageType_FRAGMENT )
+	{
+		return;
 	}
+
+	NetMessage assembled( m_fragmentBuffer->GetType( ), fragment.m_senderIndex, m_fragmentBuffer->GetData( ), m_fragmentBuffer->GetSize( ) );
+	assembled.m_definition = def;
+	assembled.Process( sender );
 }
 
 
@@ -542,11 +721,33 @@ void NetConnection::SetPassword( size_t password )
 }
 
 
+//-------------------------------------------------------------------------------------------------
+// Takes ownership, lets the game swap in its own congestion control
+void NetConnection::SetRateController( IRateController * rateController )
+{
+	if( rateController == nullptr || rateController == m_rateController )
+	{
+		return;
+	}
+
+	delete m_rateController;
+	m_rateController = rateController;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Only once the other end has agreed on the same dictionary, it couldn't read them otherwise
+void NetConnection::SetCompressPackets( bool compressPackets )
+{
+	m_compressPackets = compressPackets;
+}
+
+
 //-------------------------------------------------------------------------------------------------
 void NetConnection::UpdateLastRecvTime( )
 {
 	//Mark time received
-	m_timeLastRecv = Time::TOTAL_SECONDS;
+	m_timeLastRecv = Time::GetCurrentTimeSeconds( );
 }
 
 
@@ -556,6 +757,12 @@ void NetConnection::MarkPacketReceived( PacketHeader const & header )
 	MarkAckReceived( header.packetAck );
 	ConfirmAcksSent( header.mostRecentReceivedAck, header.previousReceivedAcksBitfield );
 	UpdateLastRecvTime( );
+
+	//Packets with nothing in them aren't acked back, or two idle ends would ping pong forever
+	if( header.messageCount > 0 )
+	{
+		m_ackPending = true;
+	}
 }
 
 
@@ -583,7 +790,7 @@ bool NetConnection::MarkAckReceived( uint16_t ackID )
 	else if( GreaterThanCycle( ackID, m_mostRecentReceivedAck ) )
 	{
 		uint16_t shift = ackID - m_mostRecentReceivedAck;
-		if( shift > 16 ) //number of bits in uint16_t
+		if( shift >= NetPacket::ACK_BITFIELD_BITS ) //Shifting a uint64_t by 64 is undefined
 		{
 			m_mostRecentReceivedAcksBitfield = 0;
 		}
@@ -592,11 +799,19 @@ bool NetConnection::MarkAckReceived( uint16_t ackID )
 			m_mostRecentReceivedAcksBitfield = (m_mostRecentReceivedAcksBitfield << shift);
 		}
 		m_mostRecentReceivedAck = ackID;
-		SetBit( &m_mostRecentReceivedAcksBitfield, shift - 1 );
+		if( shift <= NetPacket::ACK_BITFIELD_BITS )
+		{
+			SetBit( &m_mostRecentReceivedAcksBitfield, shift - 1 );
+		}
 	}
 	else
 	{
+		//Too old to report, the sender will have resent by now
 		uint16_t offset = m_mostRecentReceivedAck - ackID;
+		if( offset > NetPacket::ACK_BITFIELD_BITS )
+		{
+			return false;
+		}
 		SetBit( &m_mostRecentReceivedAcksBitfield, offset - 1 );
 	}
 
@@ -605,16 +820,51 @@ bool NetConnection::MarkAckReceived( uint16_t ackID )
 
 
 //-------------------------------------------------------------------------------------------------
-void NetConnection::ConfirmAcksSent( uint16_t highestAck, uint16_t ackBitfield )
+void NetConnection::ConfirmAcksSent( uint16_t highestAck, uint64_t ackBitfield )
 {
 	ConfirmAckBundle( highestAck );
-	for( uint16_t bitIndex = 0; bitIndex < 16; ++bitIndex)
+	for( uint16_t bitIndex = 0; bitIndex < NetPacket::ACK_BITFIELD_BITS; ++bitIndex )
 	{
-		if( IsBitfieldSet( ackBitfield, BIT( bitIndex ) ) )
+		if( IsBitSet( ackBitfield, bitIndex ) )
 		{
 			ConfirmAckBundle( highestAck - bitIndex - 1 );
 		}
 	}
+	ReportLostBundles( highestAck, ackBitfield );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Tells the rate controller about packets that newer acks have passed, instead of waiting for
+// AddBundle to find them unconfirmed when the slot is reused
+void NetConnection::ReportLostBundles( uint16_t highestAck, uint64_t ackBitfield )
+{
+	if( highestAck == AckBundle::INVALID_ACK_ID )
+	{
+		return;
+	}
+
+	for( uint16_t bitIndex = LOSS_REORDER_THRESHOLD - 1; bitIndex < NetPacket::ACK_BITFIELD_BITS; ++bitIndex )
+	{
+		if( IsBitSet( ackBitfield, bitIndex ) )
+		{
+			continue;
+		}
+
+		//Early on this wraps below zero, and the unused slots are all still INVALID_ACK_ID
+		uint16_t ack = highestAck - bitIndex - 1;
+		if( ack == AckBundle::INVALID_ACK_ID )
+		{
+			continue;
+		}
+
+		AckBundle & bundle = m_bundles[ack % MAX_ACK_BUNDLES];
+		if( bundle.m_ackID == ack && !bundle.m_confirmReceived && !bundle.m_lossReported )
+		{
+			bundle.m_lossReported = true;
+			m_rateController->OnPacketLost( );
+		}
+	}
 }
 
 
@@ -641,14 +891,64 @@ void NetConnection::ConfirmAckBundle( uint16_t ack )
 		ConfirmReliableID( bundle.m_attachedReliables[reliableIndex] );
 	}
 
-	//Track round trip time
-	double oldRTT = GetRoundTripTime( );
-	double newRTT = Time::TOTAL_SECONDS - bundle.m_sentTimeStamp;
-	m_roundTripTime = ( 0.9 ) * oldRTT + ( 0.1 ) * newRTT;
+	//Report tagged unreliables that made it, unless they have already been overwritten
+	for( uint32_t deliveryOffset = 0; deliveryOffset < bundle.m_deliveryTagCount; ++deliveryOffset )
+	{
+		uint32_t deliveryIndex = bundle.m_firstDeliveryIndex + deliveryOffset;
+		if( m_sentDeliveryCount - deliveryIndex <= MAX_TRACKED_DELIVERIES && m_confirmedDeliveryTags.size( ) < MAX_TRACKED_DELIVERIES )
+		{
+			m_confirmedDeliveryTags.push_back( m_sentDeliveryTags[deliveryIndex % MAX_TRACKED_DELIVERIES] );
+		}
+	}
+
+	//Track round trip time, ack IDs are never reused for a resend so the sample isn't ambiguous
+	double roundTripSample = Time::GetCurrentTimeSeconds( ) - bundle.m_sentTimeStamp;
+	AddRoundTripSample( roundTripSample );
+	m_rateController->OnPacketAcked( roundTripSample );
 	bundle.m_confirmReceived = true;
 }
 
 
+//-------------------------------------------------------------------------------------------------
+// RFC 6298 section 2, the granularity term covers acks waiting for the next tick
+void NetConnection::AddRoundTripSample( double sample )
+{
+	m_telemetry.AddRoundTripSample( sample );
+
+	if( !m_hasRoundTripSample )
+	{
+		m_roundTripTime = sample;
+		m_roundTripTimeVariance = sample / 2.0;
+		m_hasRoundTripSample = true;
+	}
+	else
+	{
+		double error = m_roundTripTime - sample;
+		if( error < 0.0 )
+		{
+			error = -error;
+		}
+		m_roundTripTimeVariance = ( 0.75 ) * m_roundTripTimeVariance + ( 0.25 ) * error;
+		m_roundTripTime = ( 0.875 ) * m_roundTripTime + ( 0.125 ) * sample;
+	}
+
+	double variance = 4.0 * m_roundTripTimeVariance;
+	if( variance < s_clockGranularitySeconds )
+	{
+		variance = s_clockGranularitySeconds;
+	}
+	m_resendTimeout = m_roundTripTime + variance;
+	if( m_resendTimeout < s_minResendDelaySeconds )
+	{
+		m_resendTimeout = s_minResendDelaySeconds;
+	}
+	else if( m_resendTimeout > s_maxResendDelaySeconds )
+	{
+		m_resendTimeout = s_maxResendDelaySeconds;
+	}
+}
+
+
 //-------------------------------------------------------------------------------------------------
 void NetConnection::ConfirmReliableID( uint16_t reliableID )
 {
@@ -689,6 +989,16 @@ void NetConnection::ConfirmReliableID( uint16_t reliableID )
 		m_confirmedReliableIDs[reliableID % MAX_RELIABLE_RANGE] = reliableID;
 	}
 
+	//Report a tagged reliable once, like a tagged unreliable when its packet is acked
+	NetMessage const * sent = m_sentReliableMessages[reliableID % MAX_RELIABLE_RANGE];
+	if( sent && sent->m_reliableID == reliableID && sent->m_deliveryTag != NetMessage::NO_DELIVERY_TAG && m_confirmedDeliveryTags.size( ) < MAX_TRACKED_DELIVERIES )
+	{
+		m_confirmedDeliveryTags.push_back( sent->m_deliveryTag );
+	}
+
+	//Free the sent copy now, its resend entry is dropped when it comes up
+	ReleaseSentReliable( reliableID );
+
 	UpdateOldestUnconfirmedReliableID( );
 }
 
@@ -776,6 +1086,83 @@ bool NetConnection::MarkMessageReceived( NetMessage const & message )
 }
 
 
+//-------------------------------------------------------------------------------------------------
+void NetConnection::ScheduleResend( NetMessage const * message )
+{
+	ReliableResend resend;
+	resend.deadline = message->m_sentTimeStamp + GetResendTimeout( message );
+	resend.reliableID = message->m_reliableID;
+	m_resendQueue.push_back( resend );
+	std::push_heap( m_resendQueue.begin( ), m_resendQueue.end( ), IsLaterResend );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void NetConnection::ReleaseSentReliable( uint16_t reliableID )
+{
+	NetMessage * & message = m_sentReliableMessages[reliableID % MAX_RELIABLE_RANGE];
+	if( message == nullptr || message->m_reliableID != reliableID )
+	{
+		return;
+	}
+
+	m_session->GetMessageArena( ).Release( message );
+	message = nullptr;
+	--m_sentReliableCount;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Hands over every delivery tag confirmed since the last call
+void NetConnection::TakeConfirmedDeliveryTags( std::vector<uint32_t> * out_tags )
+{
+	out_tags->insert( out_tags->end( ), m_confirmedDeliveryTags.begin( ), m_confirmedDeliveryTags.end( ) );
+	m_confirmedDeliveryTags.clear( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// One JSON object, no newline. Gauges are read now, counters are totals since the connection was made.
+// Caller holds the net lock.
+void NetConnection::AppendTelemetryJSON( double time, std::string * out_json ) const
+{
+	size_t unsentUnreliableCount = 0;
+	for( size_t priority = 0; priority < eNetMessagePriority_COUNT; ++priority )
+	{
+		unsentUnreliableCount += m_unsentUnreliableMessages[priority].Size( );
+	}
+
+	size_t totalReliableSends = m_reliableSendCount + m_resendCount;
+	double resendRatio = totalReliableSends > 0 ? (double) m_resendCount / (double) totalReliableSends : 0.0;
+	uint16_t windowSpan = (uint16_t) ( m_nextToSendReliableID - m_oldestUnconfirmedReliableID );
+
+	out_json->append( Stringf( "{\"time\":%.3f,\"index\":%u,\"username\":", time, (unsigned int) GetIndex( ) ) );
+	AppendJSONString( out_json, GetUsername( ) );
+	out_json->append( Stringf( ",\"rtt_ms\":%.2f,\"rttvar_ms\":%.2f,\"rto_ms\":%.2f,\"rtt_samples\":%llu,",
+		m_roundTripTime * 1000.0,
+		m_roundTripTimeVariance * 1000.0,
+		m_resendTimeout * 1000.0,
+		(unsigned long long) m_telemetry.GetRoundTripSampleCount( ) ) );
+	out_json->append( Stringf( "\"reliable_sends\":%u,\"resends\":%u,\"resend_ratio\":%.4f,\"drop_rate\":%.4f,\"send_rate\":%.0f,",
+		(unsigned int) m_reliableSendCount,
+		(unsigned int) m_resendCount,
+		resendRatio,
+		GetDropRate( ),
+		m_rateController->GetSendRate( ) ) );
+	out_json->append( Stringf( "\"reliables_in_flight\":%u,\"reliable_window\":%u,\"reliable_window_max\":%u,",
+		(unsigned int) m_sentReliableCount,
+		(unsigned int) windowSpan,
+		(unsigned int) MAX_RELIABLE_RANGE ) );
+	out_json->append( Stringf( "\"unsent_reliables\":%u,\"unsent_unreliables\":%u,\"resend_queue\":%u,\"sequence_buffered\":%u,",
+		(unsigned int) m_unsentReliableMessages.Size( ),
+		(unsigned int) unsentUnreliableCount,
+		(unsigned int) m_resendQueue.size( ),
+		(unsigned int) GetSequenceBufferedCount( ) ) );
+	m_telemetry.AppendJSON( out_json );
+	out_json->append( "}" );
+}
+
+
 //-------------------------------------------------------------------------------------------------
 float NetConnection::GetDropRate( ) const
 {
@@ -795,7 +1182,94 @@ double NetConnection::GetRoundTripTime( ) const
 
 
 //-------------------------------------------------------------------------------------------------
-byte_t NetConnection::GetIndex( ) const
+double NetConnection::GetRoundTripTimeVariance( ) const
+{
+	return m_roundTripTimeVariance;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+double NetConnection::GetResendTimeout( ) const
+{
+	return m_resendTimeout;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Backs off exponentially for messages that have already been resent
+double NetConnection::GetResendTimeout( NetMessage const * message ) const
+{
+	double timeout = m_resendTimeout * (double) ( 1U << message->m_resendCount );
+	if( timeout > s_maxResendDelaySeconds )
+	{
+		timeout = s_maxResendDelaySeconds;
+	}
+	return timeout;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t NetConnection::GetResendCount( ) const
+{
+	return m_resendCount;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t NetConnection::GetReliableSendCount( ) const
+{
+	return m_reliableSendCount;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Queued and not yet given a reliable ID, including anything still in the network thread's handoff
+size_t NetConnection::GetUnsentReliableCount( ) const
+{
+	if( m_session == nullptr )
+	{
+		return m_unsentReliableMessages.Size( );
+	}
+
+	m_session->LockNetThread( );
+	size_t unsentCount = m_unsentReliableMessages.Size( );
+	m_session->UnlockNetThread( );
+	return unsentCount;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+IRateController const * NetConnection::GetRateController( ) const
+{
+	return m_rateController;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+ConnectionTelemetry const & NetConnection::GetTelemetry( ) const
+{
+	return m_telemetry;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Early reliables held back waiting for a gap in their channel to fill
+size_t NetConnection::GetSequenceBufferedCount( ) const
+{
+	size_t bufferedCount = 0;
+	for( size_t channelIndex = 0; channelIndex < MAX_SEQUENCE_CHANNELS; ++channelIndex )
+	{
+		if( m_sequenceChannels[channelIndex] != nullptr )
+		{
+			bufferedCount += m_sequenceChannels[channelIndex]->GetCount( );
+		}
+	}
+	return bufferedCount;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+uint16_t NetConnection::GetIndex( ) const
 {
 	return m_connectionInfo.m_index;
 }
@@ -882,14 +1356,14 @@ bool NetConnection::IsSelf( ) const
 //-------------------------------------------------------------------------------------------------
 bool NetConnection::IsTimeForHeartbeat( ) const
 {
-	return ( Time::TOTAL_SECONDS - m_timeLastSent ) > (double) NetSession::HEARTBEAT_INTERVAL_SECONDS;
+	return ( Time::GetCurrentTimeSeconds( ) - m_timeLastSent ) > (double) NetSession::HEARTBEAT_INTERVAL_SECONDS;
 }
 
 
 //-------------------------------------------------------------------------------------------------
 bool NetConnection::IsBad( ) const
 {
-	return ( Time::TOTAL_SECONDS - m_timeLastRecv ) > (double) NetSession::BAD_CONNECTION_INTERVAL_SECONDS;
+	return ( Time::GetCurrentTimeSeconds( ) - m_timeLastRecv ) > (double) NetSession::BAD_CONNECTION_INTERVAL_SECONDS;
 }
 
 
@@ -930,7 +1404,7 @@ bool NetConnection::IsReliableIDConfirmed( uint16_t reliableID ) const
 //-------------------------------------------------------------------------------------------------
 bool NetConnection::IsMessageOld( NetMessage const * message ) const
 {
-	return ( Time::TOTAL_SECONDS - message->m_sentTimeStamp ) > GetRoundTripTime( ) * 1.1;
+	return ( Time::GetCurrentTimeSeconds( ) - message->m_sentTimeStamp ) > GetResendTimeout( message );
 }
 
 
@@ -941,6 +1415,20 @@ bool NetConnection::IsHost( ) const
 }
 
 
+//-------------------------------------------------------------------------------------------------
+bool NetConnection::HasUnsentUnreliables( ) const
+{
+	for( size_t priority = 0; priority < eNetMessagePriority_COUNT; ++priority )
+	{
+		if( !m_unsentUnreliableMessages[priority].IsEmpty( ) )
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+
 //-------------------------------------------------------------------------------------------------
 bool NetConnection::CanSendNewReliables( ) const
 {
@@ -948,6 +1436,13 @@ bool NetConnection::CanSendNewReliables( ) const
 }
 
 
+//-------------------------------------------------------------------------------------------------
+bool NetConnection::IsCompressingPackets( ) const
+{
+	return m_compressPackets;
+}
+
+
 //-------------------------------------------------------------------------------------------------
 void NetConnection::SetConnectionInfo( ConnectionInfo const & connInfo )
 {
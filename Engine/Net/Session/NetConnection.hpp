@@ -1,18 +1,35 @@
 #pragma once
 
-#include <queue>
+#include <map>
+#include <vector>
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Net/NetworkSystem.hpp"
 #include "Engine/Net/Session/AckBundle.hpp"
 #include "Engine/Net/Session/ConnectionInfo.hpp"
+#include "Engine/Net/Session/ConnectionTelemetry.hpp"
+#include "Engine/Net/Session/NetMessageDefinition.hpp"
+#include "Engine/Net/Session/NetMessageQueue.hpp"
 
 
 //-------------------------------------------------------------------------------------------------
+class FragmentBuffer;
+class IRateController;
 class NetSession;
 class NetMessage;
 class NetPacket;
 class NetSender;
 class PacketHeader;
+class SequenceChannel;
+
+
+//-------------------------------------------------------------------------------------------------
+// When a sent reliable should be resent if it still isn't confirmed
+class ReliableResend
+{
+public:
+	double deadline;
+	uint16_t reliableID;
+};
 
 
 //-------------------------------------------------------------------------------------------------
@@ -29,7 +46,13 @@ public:
 	//range of Byte (data type of sequence ID)
 	static size_t const MAX_SEQUENCE_CHANNELS = 256;
 	static size_t const DROP_COUNT_RESET_VALUE = 1024;
-	static double s_resendDelaySeconds;
+	static size_t const MAX_TRACKED_DELIVERIES = 4096;
+	static size_t const MAX_RESEND_BACKOFF = 4; //Timeout doubles per resend, up to 16x
+	static size_t const LOSS_REORDER_THRESHOLD = 3; //Packets acked after one before it counts as lost
+	static double s_resendDelaySeconds; //Timeout before the first round trip sample
+	static double s_minResendDelaySeconds;
+	static double s_maxResendDelaySeconds;
+	static double s_clockGranularitySeconds; //Acks only go out once per tick
 
 //-------------------------------------------------------------------------------------------------
 // Members
@@ -50,7 +73,8 @@ public:
 
 	//Receiving
 	uint16_t m_mostRecentReceivedAck;
-	uint16_t m_mostRecentReceivedAcksBitfield;
+	uint64_t m_mostRecentReceivedAcksBitfield;
+	bool m_ackPending; //Received messages not yet acked by anything we sent
 
 	//Sending
 	uint16_t m_nextToSendReliableID;
@@ -80,47 +104,94 @@ public:
 
 private:
 	AckBundle m_bundles[MAX_ACK_BUNDLES];
-	std::queue<NetMessage*> m_unsentUnreliableMessages;
-	std::queue<NetMessage*> m_unsentReliableMessages;
-	std::queue<NetMessage*> m_sentReliableMessages;
-	NetMessage * m_sequenceChannels[MAX_SEQUENCE_CHANNELS]; //#TODO: change to channelInfos
-
-	double m_roundTripTime;
+	NetMessageQueue m_unsentUnreliableMessages[eNetMessagePriority_COUNT];
+	std::map<uint64_t, size_t> m_coalescedMessages; //type and coalesce key to queue sequence
+	NetMessageQueue m_unsentReliableMessages;
+
+	//Sent reliables slotted by reliableID % MAX_RELIABLE_RANGE, resends ordered by deadline
+	NetMessage * m_sentReliableMessages[MAX_RELIABLE_RANGE];
+	size_t m_sentReliableCount;
+	std::vector<ReliableResend> m_resendQueue; //min-heap on deadline
+	SequenceChannel * m_sequenceChannels[MAX_SEQUENCE_CHANNELS]; //Created on the first early message
+
+	//Messages larger than one NetMessage
+	uint16_t m_nextFragmentGroupID;
+	FragmentBuffer * m_fragmentBuffer; //Created on the first fragment received
+
+	//Delivery tracking for tagged unreliables
+	uint32_t m_sentDeliveryTags[MAX_TRACKED_DELIVERIES];
+	uint32_t m_sentDeliveryCount;
+	std::vector<uint32_t> m_confirmedDeliveryTags;
+
+	//Round trip estimate in the style of RFC 6298
+	double m_roundTripTime; //smoothed
+	double m_roundTripTimeVariance;
+	double m_resendTimeout;
+	bool m_hasRoundTripSample;
+	size_t m_resendCount;
+	size_t m_reliableSendCount; //First sends only, resends are in m_resendCount
+
+	//Per tick byte budget
+	IRateController * m_rateController;
+	bool m_compressPackets; //Both ends have the same packet dictionary, agreed at join
+
+	//Histograms and per type traffic, see AppendTelemetryJSON()
+	ConnectionTelemetry m_telemetry;
 
 //-------------------------------------------------------------------------------------------------
 // Functions
 //-------------------------------------------------------------------------------------------------
 public:
-	NetConnection( unsigned char index, sockaddr_in const & address, std::string const & guid, std::string const & username, NetSession const * const session );
+	NetConnection( uint16_t index, sockaddr_in const & address, std::string const & guid, std::string const & username, NetSession const * const session );
 	~NetConnection( );
 
 	void AddMessage( NetMessage & message );
+	void AddCoalescedMessage( NetMessage & message );
+	bool AddFragmentedMessage( byte_t type, byte_t const * data, size_t dataSize );
 	void AddBundle( AckBundle const & bundle );
 	void SendPacket( );
 	size_t WriteSentReliables( NetPacket * packet, AckBundle * bundle, size_t * out_bytesWritten );
 	size_t WriteUnsentReliables( NetPacket * packet, AckBundle * bundle, size_t * out_bytesWritten );
-	size_t WriteUnsentUnreliables( NetPacket * packet, size_t * out_bytesWritten );
+	size_t WriteUnsentUnreliables( NetPacket * packet, AckBundle * bundle, size_t * out_bytesWritten );
 	void CleanUpRemainingUnreliables( );
 	void ProcessMessage( NetSender const & sender, NetMessage const & message );
 	void ProcessReliableSequence( NetSender const & sender, NetMessage const & message );
 	void ProcessNextInSequenceChannel( NetSender const & sender, byte_t sequenceChannelID );
 	void AddMessageToSequenceChannel( NetMessage const & message, byte_t sequenceChannelID );
 	void ProcessUnreliableSequence( NetSender const & sender, NetMessage const & message );
+	void ProcessFragment( NetSender const & sender, NetMessage const & fragment );
 	void SetPassword( size_t password );
+	void SetRateController( IRateController * rateController );
+	void SetCompressPackets( bool compressPackets );
 
 	void UpdateLastRecvTime( );
 	void MarkPacketReceived( PacketHeader const & header );
 	bool MarkAckReceived( uint16_t ackID );
-	void ConfirmAcksSent( uint16_t highestAck, uint16_t ackBitfield );
+	void ConfirmAcksSent( uint16_t highestAck, uint64_t ackBitfield );
 	void ConfirmAckBundle( uint16_t ack );
+	void ReportLostBundles( uint16_t highestAck, uint64_t ackBitfield );
+	void AddRoundTripSample( double sample );
 	void ConfirmReliableID( uint16_t reliableID );
 	void UpdateOldestUnconfirmedReliableID( );
 	void UpdateOldestUnreceivedReliableID( );
 	bool MarkMessageReceived( NetMessage const & message );
+	void ScheduleResend( NetMessage const * message );
+	void ReleaseSentReliable( uint16_t reliableID );
+	void TakeConfirmedDeliveryTags( std::vector<uint32_t> * out_tags );
+	void AppendTelemetryJSON( double time, std::string * out_json ) const;
 	
 	float GetDropRate( ) const;
 	double GetRoundTripTime( ) const;
-	byte_t GetIndex( ) const;
+	double GetRoundTripTimeVariance( ) const;
+	double GetResendTimeout( ) const;
+	double GetResendTimeout( NetMessage const * message ) const;
+	size_t GetResendCount( ) const;
+	size_t GetReliableSendCount( ) const;
+	size_t GetUnsentReliableCount( ) const;
+	IRateController const * GetRateController( ) const;
+	ConnectionTelemetry const & GetTelemetry( ) const;
+	size_t GetSequenceBufferedCount( ) const;
+	uint16_t GetIndex( ) const;
 	char const * GetGUID( ) const;
 	char const * GetUsername( ) const;
 	size_t GetPassword( ) const;
@@ -137,7 +208,9 @@ public:
 	bool IsReliableIDConfirmed( uint16_t reliableID ) const;
 	bool IsMessageOld( NetMessage const * message ) const;
 	bool IsHost( ) const;
+	bool HasUnsentUnreliables( ) const;
 	bool CanSendNewReliables( ) const;
+	bool IsCompressingPackets( ) const;
 
 	void SetConnectionInfo( ConnectionInfo const & connInfo );
 };
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "Engine/Net/Session/NetMessage.hpp"
 
+#include "Engine/Net/Session/NetMessageArena.hpp"
+
 //include for NetSender
 #include "Engine/Net/Session/NetPacket.hpp"
 #include "Engine/Net/Session/NetConnection.hpp"
@@ -7,43 +9,50 @@
 
 
 //-------------------------------------------------------------------------------------------------
-NetMessage::NetMessage( byte_t type /*= eNetMessageType_INVALID*/ )
-	: NetMessage( type, NetSession::INVALID_INDEX )
+// Reads in place from the caller's buffer, which can be larger than OwnedNetMessage::MAX_SIZE (see FragmentBuffer)
+NetMessage::NetMessage( byte_t type, uint16_t senderIndex, byte_t * buffer, size_t bufferSize )
+	: NetMessage( type, senderIndex, buffer, bufferSize, bufferSize )
 {
 	//Nothing
 }
 
 
 //-------------------------------------------------------------------------------------------------
-NetMessage::NetMessage( byte_t type, byte_t senderIndex )
-	: BytePacker( m_data, MAX_SIZE, 0 )
+// Writes go to the caller's buffer, up to bufferMax
+NetMessage::NetMessage( byte_t type, uint16_t senderIndex, byte_t * buffer, size_t bufferMax, size_t bufferSize )
+	: BytePacker( buffer, bufferMax, bufferSize )
 	, m_sentTimeStamp( 0.0 )
+	, m_resendCount( 0 )
 	, m_definition( nullptr )
-	, m_type( (byte_t) type )
+	, m_type( type )
 	, m_reliableID( INVALID_RELIABLE_ID )
 	, m_sequenceID( 0 )
 	, m_senderIndex( senderIndex )
-	, m_next( nullptr )
-	, m_prev( nullptr )
+	, m_deliveryTag( NO_DELIVERY_TAG )
+	, m_coalesceKey( 0 )
+	, m_block( nullptr )
 {
 	//Nothing
 }
 
 
 //-------------------------------------------------------------------------------------------------
-NetMessage::NetMessage( byte_t * buffer, size_t bufferSize )
-	: BytePacker( m_data, MAX_SIZE, bufferSize )
-	, m_sentTimeStamp( 0.0 )
-	, m_definition( nullptr )
-	, m_type( (byte_t) -1 )
-	, m_reliableID( INVALID_RELIABLE_ID )
-	, m_sequenceID( 0 )
-	, m_senderIndex( NetSession::INVALID_INDEX )
-	, m_next( nullptr )
-	, m_prev( nullptr )
+// Arena copy, reads and writes go to the shared block
+NetMessage::NetMessage( NetMessage const & source, NetMessageBlock * block, size_t blockSize )
+	: BytePacker( block->GetData( ), blockSize, source.GetPayloadSize( ) )
+	, m_sentTimeStamp( source.m_sentTimeStamp )
+	, m_resendCount( source.m_resendCount )
+	, m_definition( source.m_definition )
+	, m_type( source.m_type )
+	, m_reliableID( source.m_reliableID )
+	, m_sequenceID( source.m_sequenceID )
+	, m_ackID( source.m_ackID )
+	, m_senderIndex( source.m_senderIndex )
+	, m_deliveryTag( source.m_deliveryTag )
+	, m_coalesceKey( source.m_coalesceKey )
+	, m_block( block )
 {
-	memcpy( m_data, buffer, bufferSize );
-	m_buffer = m_data;
+	//Nothing
 }
 
 
@@ -82,9 +91,24 @@ eNetMessageType NetMessage::GetNetMessageType( ) const
 
 
 //-------------------------------------------------------------------------------------------------
-NetMessage * NetMessage::Copy( ) const
+OwnedNetMessage::OwnedNetMessage( byte_t type /*= eNetMessageType_INVALID*/ )
+	: OwnedNetMessage( type, NetSession::INVALID_INDEX )
+{
+	//Nothing
+}
+
+
+//-------------------------------------------------------------------------------------------------
+OwnedNetMessage::OwnedNetMessage( byte_t type, uint16_t senderIndex )
+	: NetMessage( type, senderIndex, m_data, MAX_SIZE, 0 )
+{
+	//Nothing
+}
+
+
+//-------------------------------------------------------------------------------------------------
+OwnedNetMessage::OwnedNetMessage( byte_t * buffer, size_t bufferSize )
+	: NetMessage( (byte_t) -1, NetSession::INVALID_INDEX, m_data, MAX_SIZE, bufferSize )
 {
-	NetMessage * copy = new NetMessage( *this );
-	copy->m_buffer = copy->m_data;
-	return copy;
+	memcpy( m_data, buffer, bufferSize );
 }
@@ -6,49 +6,84 @@
 
 //-------------------------------------------------------------------------------------------------
 class NetSender;
+class NetMessageBlock;
 
 
 //-------------------------------------------------------------------------------------------------
+// Header and a view of the payload, which lives in an OwnedNetMessage, a shared arena block or the
+// caller's buffer. Connection queues hold these, so a queued message costs only the header and its
+// size-exact block.
 class NetMessage : public BytePacker
 {
 //-------------------------------------------------------------------------------------------------
 // Static Members
 //-------------------------------------------------------------------------------------------------
-private:
-	static size_t const MAX_SIZE = 1024;
-
 public:
 	static uint16_t const INVALID_RELIABLE_ID = 65535;
+	static uint32_t const NO_DELIVERY_TAG = 0;
 
 //-------------------------------------------------------------------------------------------------
 // Members
 //-------------------------------------------------------------------------------------------------
 public:
 	double m_sentTimeStamp;
+	byte_t m_resendCount; //Resend timeout doubles with each resend, see NetConnection::GetResendTimeout
 	NetMessageDefinition const * m_definition;
 	byte_t m_type;
 	uint16_t m_reliableID;
 	uint16_t m_sequenceID;
 	uint16_t m_ackID;
-	byte_t m_senderIndex;
-	NetMessage * m_next;
-	NetMessage * m_prev;
-
-private:
-	byte_t m_data[MAX_SIZE];
+	uint16_t m_senderIndex;
+	uint32_t m_deliveryTag; //Reported back through NetConnection once acked, for reliables once confirmed
+	uint32_t m_coalesceKey; //With the type, identifies what a coalesced message supersedes (eg. net ID)
+	NetMessageBlock * m_block; //Shared arena payload, nullptr when the payload isn't in the arena
 
 //-------------------------------------------------------------------------------------------------
 // Functions
 //-------------------------------------------------------------------------------------------------
 public:
-	NetMessage( byte_t type = eNetMessageType_INVALID );
-	NetMessage( byte_t type, byte_t senderIndex );
-	NetMessage( byte_t * buffer, size_t bufferSize );
+	NetMessage( byte_t type, uint16_t senderIndex, byte_t * buffer, size_t bufferSize );
+	NetMessage( byte_t type, uint16_t senderIndex, byte_t * buffer, size_t bufferMax, size_t bufferSize );
+	NetMessage( NetMessage const & source, NetMessageBlock * block, size_t blockSize );
 
 	void Process( NetSender const & senderInfo ) const;
 
 	size_t GetPayloadSize( ) const;
 	size_t GetTotalWrittenMessageSize( ) const;
 	eNetMessageType GetNetMessageType( ) const;
-	NetMessage * Copy( ) const;
+
+private:
+	NetMessage( NetMessage const & ) = delete; //Would alias m_block past its release, see NetMessageArena::Share()
+	NetMessage & operator=( NetMessage const & ) = delete;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Message with its own payload storage, for building one to send or holding one just read.
+// Never queued, NetMessageArena::Share() copies the payload out into a block.
+class OwnedNetMessage : public NetMessage
+{
+//-------------------------------------------------------------------------------------------------
+// Static Members
+//-------------------------------------------------------------------------------------------------
+public:
+	static size_t const MAX_SIZE = 1024;
+
+//-------------------------------------------------------------------------------------------------
+// Members
+//-------------------------------------------------------------------------------------------------
+private:
+	byte_t m_data[MAX_SIZE];
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+public:
+	OwnedNetMessage( byte_t type = eNetMessageType_INVALID );
+	OwnedNetMessage( byte_t type, uint16_t senderIndex );
+	OwnedNetMessage( byte_t * buffer, size_t bufferSize );
+
+private:
+	OwnedNetMessage( OwnedNetMessage const & ) = delete; //The copy would still read the source's buffer
+	OwnedNetMessage & operator=( OwnedNetMessage const & ) = delete;
 };
\ No newline at end of file
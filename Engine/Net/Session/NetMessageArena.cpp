@@ -0,0 +1,224 @@
+#include "Engine/Net/Session/NetMessageArena.hpp"
+
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+#include "Engine/DebugSystem/ErrorWarningAssert.hpp"
+#include "Engine/Net/Session/NetMessage.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+NetMessageArena::NetMessageArena( )
+	: m_freeMessages( nullptr )
+	, m_reservedBytes( 0 )
+	, m_liveBlocks( 0 )
+	, m_liveMessages( 0 )
+	, m_currentTick( )
+	, m_lastTick( )
+{
+	for( size_t sizeClass = 0; sizeClass < SIZE_CLASS_COUNT; ++sizeClass )
+	{
+		m_freeBlocks[sizeClass] = nullptr;
+	}
+	MarkTick( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+NetMessageArena::~NetMessageArena( )
+{
+	ASSERT_RECOVERABLE( m_liveMessages == 0, "NetMessages still referenced when arena was destroyed" );
+	for( void * slab : m_slabs )
+	{
+		free( slab );
+	}
+	m_slabs.clear( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Returns a queued copy of source. If source already lives in the arena only the refcount is bumped.
+NetMessage * NetMessageArena::Share( NetMessage const & source )
+{
+	NetMessageBlock * block = source.m_block;
+	if( block )
+	{
+		++block->refCount;
+		++m_currentTick.blocksShared;
+	}
+	else
+	{
+		size_t payloadSize = source.GetPayloadSize( );
+		block = AllocateBlock( payloadSize );
+		memcpy( block->GetData( ), source.GetBuffer( ), payloadSize );
+		m_currentTick.bytesCopied += payloadSize;
+	}
+
+	void * slot = AllocateMessageSlot( );
+	return new ( slot ) NetMessage( source, block, GetSizeClassBytes( block->sizeClass ) );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void NetMessageArena::Release( NetMessage * message )
+{
+	if( message == nullptr )
+	{
+		return;
+	}
+
+	NetMessageBlock * block = message->m_block;
+	message->~NetMessage( );
+	FreeMessageSlot( message );
+
+	--block->refCount;
+	if( block->refCount == 0 )
+	{
+		FreeBlock( block );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void NetMessageArena::MarkTick( )
+{
+	m_lastTick = m_currentTick;
+	m_currentTick.bytesAllocated = 0;
+	m_currentTick.bytesCopied = 0;
+	m_currentTick.blocksAllocated = 0;
+	m_currentTick.blocksShared = 0;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+NetMessageArenaStats const & NetMessageArena::GetLastTickStats( ) const
+{
+	return m_lastTick;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t NetMessageArena::GetReservedBytes( ) const
+{
+	return m_reservedBytes;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t NetMessageArena::GetLiveBlockCount( ) const
+{
+	return m_liveBlocks;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t NetMessageArena::GetLiveMessageCount( ) const
+{
+	return m_liveMessages;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+NetMessageBlock * NetMessageArena::AllocateBlock( size_t payloadSize )
+{
+	size_t sizeClass = GetSizeClass( payloadSize );
+
+	//Out of blocks, carve a new slab for this size class
+	if( m_freeBlocks[sizeClass] == nullptr )
+	{
+		size_t slotSize = sizeof( NetMessageBlock ) + GetSizeClassBytes( sizeClass );
+		byte_t * slab = (byte_t*) AllocateSlab( slotSize );
+		for( int slotIndex = BLOCKS_PER_SLAB - 1; slotIndex >= 0; --slotIndex )
+		{
+			NetMessageBlock * node = (NetMessageBlock*) ( slab + slotIndex * slotSize );
+			node->next = m_freeBlocks[sizeClass];
+			m_freeBlocks[sizeClass] = node;
+		}
+	}
+
+	NetMessageBlock * block = m_freeBlocks[sizeClass];
+	m_freeBlocks[sizeClass] = block->next;
+	block->next = nullptr;
+	block->refCount = 1;
+	block->sizeClass = (byte_t) sizeClass;
+
+	++m_liveBlocks;
+	++m_currentTick.blocksAllocated;
+	m_currentTick.bytesAllocated += GetSizeClassBytes( sizeClass );
+	return block;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void NetMessageArena::FreeBlock( NetMessageBlock * block )
+{
+	block->next = m_freeBlocks[block->sizeClass];
+	m_freeBlocks[block->sizeClass] = block;
+	--m_liveBlocks;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void * NetMessageArena::AllocateMessageSlot( )
+{
+	if( m_freeMessages == nullptr )
+	{
+		byte_t * slab = (byte_t*) AllocateSlab( sizeof( NetMessage ) );
+		for( int slotIndex = BLOCKS_PER_SLAB - 1; slotIndex >= 0; --slotIndex )
+		{
+			void ** node = (void**) ( slab + slotIndex * sizeof( NetMessage ) );
+			*node = m_freeMessages;
+			m_freeMessages = node;
+		}
+	}
+
+	void * slot = m_freeMessages;
+	m_freeMessages = *( (void**) slot );
+
+	++m_liveMessages;
+	m_currentTick.bytesAllocated += sizeof( NetMessage );
+	return slot;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void NetMessageArena::FreeMessageSlot( void * slot )
+{
+	*( (void**) slot ) = m_freeMessages;
+	m_freeMessages = slot;
+	--m_liveMessages;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void * NetMessageArena::AllocateSlab( size_t slotSize )
+{
+	size_t slabSize = slotSize * BLOCKS_PER_SLAB;
+	void * slab = malloc( slabSize );
+	ASSERT_OR_DIE( slab != nullptr, "NetMessageArena out of memory" );
+	m_slabs.push_back( slab );
+	m_reservedBytes += slabSize;
+	return slab;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC size_t NetMessageArena::GetSizeClass( size_t payloadSize )
+{
+	size_t sizeClass = 0;
+	size_t classBytes = MIN_BLOCK_SIZE;
+	while( classBytes < payloadSize && sizeClass < SIZE_CLASS_COUNT - 1 )
+	{
+		classBytes <<= 1;
+		++sizeClass;
+	}
+	ASSERT_OR_DIE( payloadSize <= classBytes, "NetMessage payload too large for arena" );
+	return sizeClass;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC size_t NetMessageArena::GetSizeClassBytes( size_t sizeClass )
+{
+	return MIN_BLOCK_SIZE << sizeClass;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+#include "Engine/Core/EngineCommon.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+class NetMessage;
+
+
+//-------------------------------------------------------------------------------------------------
+// Refcounted payload storage, data follows directly after the block header
+class NetMessageBlock
+{
+public:
+	NetMessageBlock * next;
+	uint32_t refCount;
+	byte_t sizeClass;
+
+public:
+	byte_t * GetData( ) { return (byte_t*) ( this + 1 ); }
+};
+
+
+//-------------------------------------------------------------------------------------------------
+class NetMessageArenaStats
+{
+public:
+	size_t bytesAllocated;
+	size_t bytesCopied;
+	size_t blocksAllocated;
+	size_t blocksShared;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Hands out size-exact payload blocks and message headers from slabs owned by the session.
+// A message is serialized into a block once and every connection queue holds a reference to it.
+class NetMessageArena
+{
+//-------------------------------------------------------------------------------------------------
+// Static Members
+//-------------------------------------------------------------------------------------------------
+public:
+	static size_t const MIN_BLOCK_SIZE = 16;
+	static size_t const SIZE_CLASS_COUNT = 7; //16, 32, 64, 128, 256, 512, 1024
+	static size_t const BLOCKS_PER_SLAB = 64;
+
+//-------------------------------------------------------------------------------------------------
+// Members
+//-------------------------------------------------------------------------------------------------
+private:
+	NetMessageBlock * m_freeBlocks[SIZE_CLASS_COUNT];
+	void * m_freeMessages;
+	std::vector<void*> m_slabs;
+	size_t m_reservedBytes;
+	size_t m_liveBlocks;
+	size_t m_liveMessages;
+	NetMessageArenaStats m_currentTick;
+	NetMessageArenaStats m_lastTick;
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+public:
+	NetMessageArena( );
+	~NetMessageArena( );
+
+	NetMessage * Share( NetMessage const & source );
+	void Release( NetMessage * message );
+	void MarkTick( );
+
+	NetMessageArenaStats const & GetLastTickStats( ) const;
+	size_t GetReservedBytes( ) const;
+	size_t GetLiveBlockCount( ) const;
+	size_t GetLiveMessageCount( ) const;
+
+private:
+	NetMessageBlock * AllocateBlock( size_t payloadSize );
+	void FreeBlock( NetMessageBlock * block );
+	void * AllocateMessageSlot( );
+	void FreeMessageSlot( void * slot );
+	void * AllocateSlab( size_t slotSize );
+
+	static size_t GetSizeClass( size_t payloadSize );
+	static size_t GetSizeClassBytes( size_t sizeClass );
+};
@@ -9,10 +9,10 @@ void NetMessageDefinition::CalculateHeaderSize( )
 	//message type 1 byte
 	headerSize = 1;
 
-	//sender index 1 byte
+	//sender index 2 bytes
 	if( !IsConnectionless( ) )
 	{
-		headerSize += 1;
+		headerSize += 2;
 	}
 
 	//reliable id 2 bytes
@@ -46,4 +46,11 @@ bool NetMessageDefinition::IsReliable( ) const
 bool NetMessageDefinition::IsSequence( ) const
 {
 	return IsBitfieldSet( optionFlags, SEQUENCE_OPTION_FLAG );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool NetMessageDefinition::IsCoalesced( ) const
+{
+	return !IsReliable( ) && IsBitfieldSet( optionFlags, COALESCE_OPTION_FLAG );
 }
\ No newline at end of file
@@ -21,11 +21,23 @@ enum eNetMessageType : byte_t
 	eNetMessageType_JOIN_DENY,
 	eNetMessageType_JOIN_ACCEPT,
 	eNetMessageType_LEAVE,
+	eNetMessageType_FRAGMENT,
 	eNetMessageType_COUNT,
 	eNetMessageType_INVALID = 255,
 };
 
 
+//-------------------------------------------------------------------------------------------------
+// Unsent unreliables go out highest priority first, whatever doesn't fit the tick is dropped
+enum eNetMessagePriority : byte_t
+{
+	eNetMessagePriority_LOW,
+	eNetMessagePriority_NORMAL,
+	eNetMessagePriority_HIGH,
+	eNetMessagePriority_COUNT,
+};
+
+
 //-------------------------------------------------------------------------------------------------
 class NetMessageDefinition
 {
@@ -36,6 +48,7 @@ public:
 	static byte_t const CONNECTIONLESS_CONTROL_FLAG = BIT( 0 );
 	static byte_t const RELIABLE_OPTION_FLAG = BIT( 0 );
 	static byte_t const SEQUENCE_OPTION_FLAG = BIT( 1 );
+	static byte_t const COALESCE_OPTION_FLAG = BIT( 2 ); //Unreliable only, a newer message with the same coalesce key replaces the queued one
 
 //-------------------------------------------------------------------------------------------------
 // Members
@@ -45,6 +58,7 @@ public:
 	byte_t controlFlags;
 	byte_t optionFlags;
 	byte_t sequenceChannelID;
+	eNetMessagePriority priority;
 	size_t headerSize;
 	MessageCallback * callback;
 
@@ -56,4 +70,5 @@ public:
 	bool IsConnectionless( ) const;
 	bool IsReliable( ) const;
 	bool IsSequence( ) const;
+	bool IsCoalesced( ) const;
 };
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "Engine/Net/Session/NetMessageQueue.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+NetMessageQueue::NetMessageQueue( )
+	: m_messages( new NetMessage*[START_CAPACITY] )
+	, m_capacity( START_CAPACITY )
+	, m_head( 0 )
+	, m_count( 0 )
+	, m_pushCount( 0 )
+{
+	//Nothing
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Does not release the messages, the owner has to drain the queue first
+NetMessageQueue::~NetMessageQueue( )
+{
+	delete[] m_messages;
+	m_messages = nullptr;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Returns the message's sequence, usable with Get and Replace until it's popped
+size_t NetMessageQueue::Push( NetMessage * message )
+{
+	if( m_count == m_capacity )
+	{
+		Grow( );
+	}
+	m_messages[( m_head + m_count ) & ( m_capacity - 1 )] = message;
+	++m_count;
+	return m_pushCount++;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void NetMessageQueue::Pop( )
+{
+	if( m_count == 0 )
+	{
+		return;
+	}
+	m_head = ( m_head + 1 ) & ( m_capacity - 1 );
+	--m_count;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+NetMessage * NetMessageQueue::Front( ) const
+{
+	if( m_count == 0 )
+	{
+		return nullptr;
+	}
+	return m_messages[m_head];
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// nullptr if that message was already popped
+NetMessage * NetMessageQueue::Get( size_t sequence ) const
+{
+	size_t frontSequence = m_pushCount - m_count;
+	if( sequence < frontSequence || sequence >= m_pushCount )
+	{
+		return nullptr;
+	}
+	return m_messages[( m_head + ( sequence - frontSequence ) ) & ( m_capacity - 1 )];
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Swaps the message in place, keeping its spot in line. Returns the old message for the caller to release.
+NetMessage * NetMessageQueue::Replace( size_t sequence, NetMessage * message )
+{
+	size_t frontSequence = m_pushCount - m_count;
+	if( sequence < frontSequence || sequence >= m_pushCount )
+	{
+		return nullptr;
+	}
+	NetMessage * & slot = m_messages[( m_head + ( sequence - frontSequence ) ) & ( m_capacity - 1 )];
+	NetMessage * oldMessage = slot;
+	slot = message;
+	return oldMessage;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t NetMessageQueue::Size( ) const
+{
+	return m_count;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool NetMessageQueue::IsEmpty( ) const
+{
+	return m_count == 0;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Unwraps the ring into the front of a buffer twice the size
+void NetMessageQueue::Grow( )
+{
+	size_t newCapacity = m_capacity * 2;
+	NetMessage ** newMessages = new NetMessage*[newCapacity];
+	for( size_t messageIndex = 0; messageIndex < m_count; ++messageIndex )
+	{
+		newMessages[messageIndex] = m_messages[( m_head + messageIndex ) & ( m_capacity - 1 )];
+	}
+
+	delete[] m_messages;
+	m_messages = newMessages;
+	m_capacity = newCapacity;
+	m_head = 0;
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Engine/Core/EngineCommon.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+class NetMessage;
+
+
+//-------------------------------------------------------------------------------------------------
+// FIFO of message pointers in a power of two ring. Grows by doubling and never shrinks, so a
+// connection stops allocating once it has seen its busiest tick.
+class NetMessageQueue
+{
+//-------------------------------------------------------------------------------------------------
+// Static Members
+//-------------------------------------------------------------------------------------------------
+public:
+	static size_t const START_CAPACITY = 64;
+
+//-------------------------------------------------------------------------------------------------
+// Members
+//-------------------------------------------------------------------------------------------------
+private:
+	NetMessage ** m_messages;
+	size_t m_capacity;
+	size_t m_head;
+	size_t m_count;
+	size_t m_pushCount; //Sequence of the next push, the front is at m_pushCount - m_count
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+public:
+	NetMessageQueue( );
+	~NetMessageQueue( );
+
+	size_t Push( NetMessage * message );
+	void Pop( );
+	NetMessage * Front( ) const;
+	NetMessage * Get( size_t sequence ) const;
+	NetMessage * Replace( size_t sequence, NetMessage * message );
+	size_t Size( ) const;
+	bool IsEmpty( ) const;
+
+private:
+	NetMessageQueue( NetMessageQueue const & ) = delete;
+	NetMessageQueue & operator=( NetMessageQueue const & ) = delete;
+	void Grow( );
+};
\ No newline at end of file
@@ -7,6 +7,7 @@
 //-------------------------------------------------------------------------------------------------
 NetPacket::NetPacket( )
 	: BytePacker( m_data, MAX_SIZE, 0 )
+	, m_messageCount( 0 )
 	, m_senderInfo( )
 {
 	//Nothing
@@ -16,10 +17,10 @@ NetPacket::NetPacket( )
 //-------------------------------------------------------------------------------------------------
 void NetPacket::WriteHeader( PacketHeader * header )
 {
-	Write<uint8_t>( header->fromConnIndex );
+	Write<uint16_t>( header->fromConnIndex );
 	Write<uint16_t>( header->packetAck );
 	Write<uint16_t>( header->mostRecentReceivedAck );
-	Write<uint16_t>( header->previousReceivedAcksBitfield );
+	Write<uint64_t>( header->previousReceivedAcksBitfield );
 }
 
 
@@ -37,7 +38,7 @@ bool NetPacket::CanWriteMessage( NetMessage const * message ) const
 	size_t totalSize = message->GetTotalWrittenMessageSize( );
 
 	//Make sure we can write this much
-	if( GetWritableBytesLeft( ) >= totalSize )
+	if( m_messageCount < MAX_MESSAGE_COUNT && GetWritableBytesLeft( ) >= totalSize )
 	{
 		//There is room left
 		return true;
@@ -67,7 +68,7 @@ bool NetPacket::WriteMessage( NetMessage const * message )
 		//header : sender index
 		if( !definition->IsConnectionless( ) )
 		{
-			Write<uint8_t>( (uint8_t) message->m_senderIndex );
+			Write<uint16_t>( message->m_senderIndex );
 		}
 
 		//header : reliable ID
@@ -84,23 +85,7 @@ bool NetPacket::WriteMessage( NetMessage const * message )
 
 		//payload
 		WriteForward( message->GetBuffer( ), message->GetPayloadSize( ) );
-
-		if( definition->IsReliable( ) && definition->IsSequence( ) )
-		{
-			NetSession::m_NetworkTrafficActivity.Printf( "\tMessage (type=%3u) (reliableID=%u) (sequenceID=%u) %4u Byte(s) ", definition->type, message->m_reliableID, message->m_sequenceID, message->GetTotalWrittenMessageSize( ) );
-		}
-		else if( definition->IsSequence( ) )
-		{
-			NetSession::m_NetworkTrafficActivity.Printf( "\tMessage (type=%3u) (sequenceID=%u) %4u Byte(s) ", definition->type, message->m_sequenceID, message->GetTotalWrittenMessageSize( ) );
-		}
-		else if( definition->IsReliable( ) )
-		{
-			NetSession::m_NetworkTrafficActivity.Printf( "\tMessage (type=%3u) (reliableID=%u) %4u Byte(s) ", definition->type, message->m_reliableID, message->GetTotalWrittenMessageSize( ) );
-		}
-		else
-		{
-			NetSession::m_NetworkTrafficActivity.Printf( "\tMessage (type=%3u) %4u Byte(s) ", definition->type, message->GetTotalWrittenMessageSize( ) );
-		}
+		++m_messageCount;
 		return true;
 	}
 	return false;
@@ -110,10 +95,10 @@ bool NetPacket::WriteMessage( NetMessage const * message )
 //-------------------------------------------------------------------------------------------------
 void NetPacket::ReadHeader( PacketHeader * header ) const
 {
-	Read<uint8_t>( &( header->fromConnIndex ) );
+	Read<uint16_t>( &( header->fromConnIndex ) );
 	Read<uint16_t>( &( header->packetAck ) );
 	Read<uint16_t>( &( header->mostRecentReceivedAck ) );
-	Read<uint16_t>( &( header->previousReceivedAcksBitfield ) );
+	Read<uint64_t>( &( header->previousReceivedAcksBitfield ) );
 	Read<uint8_t>( &( header->messageCount ) );
 }
 
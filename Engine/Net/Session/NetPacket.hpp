@@ -26,16 +26,16 @@ public:
 class PacketHeader
 {
 public:
-	uint8_t fromConnIndex;
+	uint16_t fromConnIndex; //16 bit since NET_VERSION 4
 	uint16_t packetAck;
 	uint16_t mostRecentReceivedAck;
-	uint16_t previousReceivedAcksBitfield;
+	uint64_t previousReceivedAcksBitfield; //Acks before mostRecentReceivedAck, 64 wide since NET_VERSION 3
 	uint8_t messageCount;
 
 public:
 	size_t const GetTotalWrittenHeaderSize( )
 	{
-		return sizeof( uint8_t ) * 2 + sizeof( uint16_t ) * 3;
+		return sizeof( uint8_t ) + sizeof( uint16_t ) * 3 + sizeof( uint64_t );
 	};
 };
 
@@ -48,12 +48,17 @@ class NetPacket : public BytePacker
 //-------------------------------------------------------------------------------------------------
 public:
 	static size_t const MAX_SIZE = 1444;
+	static size_t const ACK_BITFIELD_BITS = 64;
+	static size_t const HEADER_SIZE = 14; //Everything before the message count
+	static size_t const MAX_MESSAGE_COUNT = 254;
+	static uint8_t const COMPRESSED_MESSAGE_COUNT = 0xFF; //The message count and messages follow compressed, see NetSession::SendPacket()
 
 //-------------------------------------------------------------------------------------------------
 // Members
 //-------------------------------------------------------------------------------------------------
 private:
 	byte_t m_data[MAX_SIZE];
+	size_t m_messageCount; //Written so far, a full count byte would read as compressed
 
 public:
 	NetSender m_senderInfo;
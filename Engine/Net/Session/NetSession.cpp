@@ -1,5 +1,7 @@
 #include "Engine/Net/Session/NetSession.hpp"
 
+#include <chrono>
+#include <cstring>
 #include "Engine/DebugSystem/BProfiler.hpp"
 #include "Engine/Core/NamedProperties.hpp"
 #include "Engine/Core/Time.hpp"
@@ -15,16 +17,25 @@
 //-------------------------------------------------------------------------------------------------
 STATIC float const NetSession::SEND_RATE = 1.f / 60.f; //60 Hz
 
-STATIC int const NetSession::MAX_PACKET_SEND_AMOUNT_PER_CONNECTION = 5;
+STATIC int const NetSession::MAX_PACKET_SEND_AMOUNT_PER_CONNECTION = 16;
 STATIC float const NetSession::HEARTBEAT_INTERVAL_SECONDS = 1.f;
 STATIC float const NetSession::BAD_CONNECTION_INTERVAL_SECONDS = 5.f;
 STATIC float const NetSession::DISCONNECT_INTERVAL_SECONDS = 15.f;
+STATIC double const NetSession::NET_THREAD_SLEEP_SECONDS = 0.001;
+STATIC char const * NetSession::PREPARE_SNAPSHOT_EVENT = "PrepareSnapshotEvent";
 STATIC char const * NetSession::PREPARE_PACKET_EVENT = "PreparePacketEvent";
+STATIC char const * NetSession::FINISH_SNAPSHOT_EVENT = "FinishSnapshotEvent";
 STATIC char const * NetSession::ON_CONNECTION_JOIN_EVENT = "ConnectionJoinEvent";
 STATIC char const * NetSession::ON_CONNECTION_LEAVE_EVENT = "ConnectionLeaveEvent";
 STATIC char const * NetSession::ON_GAME_JOIN_VALIDATION_EVENT = "GameJoinValidation";
 STATIC char const * NetSession::ON_JOIN_DENY_EVENT = "JoinDenyEvent";
-STATIC DebugLog NetSession::m_NetworkTrafficActivity = DebugLog( "Data/Logs/NetworkTraffic.txt" );
+
+
+//-------------------------------------------------------------------------------------------------
+static void NetThreadEntry( void * data )
+{
+	( (NetSession*) data )->RunNetThread( );
+}
 
 
 //-------------------------------------------------------------------------------------------------
@@ -44,7 +55,7 @@ void OnPing( NetSender const & sender, NetMessage const & message )
 	sockaddr_in addr = sender.fromAddress;
 	g_ConsoleSystem->AddLog( Stringf( "Received Ping from %s: %s", StringFromSockAddr(&addr), sent ), Console::GOOD );
 
-	NetMessage pong( eNetMessageType_PONG );
+	OwnedNetMessage pong( eNetMessageType_PONG );
 	sender.session->SendDirect( addr, pong );
 }
 
@@ -75,6 +86,8 @@ void OnJoinRequest( NetSender const & sender, NetMessage const & message )
 	message.Read<uint32_t>( &( request.nuonce ) );
 	message.ReadString( &( request.username ) );
 	message.Read<size_t>( &( request.password ) );
+	request.dictionaryHash = 0U;
+	message.Read<uint32_t>( &( request.dictionaryHash ) );
 
 	if( request.version != currentSession->GetNetSessionVersion( ) )
 	{
@@ -89,8 +102,8 @@ void OnJoinRequest( NetSender const & sender, NetMessage const & message )
 	{
 		currentSession->SendDeny( sender.fromAddress, eNetSessionError_JOIN_DENIED_NOT_ACCEPTING_NEW_CONNECTIONS, request.nuonce );
 	}
-	//TODO: implement max capacity
-	else if( false )
+	//Every index up to the connection limit is taken
+	else if( currentSession->GetNextFreeIndex( ) == NetSession::INVALID_INDEX )
 	{
 		currentSession->SendDeny( sender.fromAddress, eNetSessionError_JOIN_DENIED_FULL, request.nuonce );
 	}
@@ -105,7 +118,7 @@ void OnJoinRequest( NetSender const & sender, NetMessage const & message )
 		joinEvent.Set( "request", &request );
 		joinEvent.Set( "error", eNetSessionError_NONE );
 		joinEvent.Set( "canJoin", true );
-		EventSystem::TriggerEvent( NetSession::ON_GAME_JOIN_VALIDATION_EVENT, joinEvent );
+		currentSession->BroadcastEvent( NetSession::ON_GAME_JOIN_VALIDATION_EVENT, joinEvent );
 
 		//Find out if join was successful
 		bool success = false;
@@ -114,10 +127,11 @@ void OnJoinRequest( NetSender const & sender, NetMessage const & message )
 		if( success )
 		{
 			//Create new connection
-			byte_t index = currentSession->GetNextFreeIndex( );
+			uint16_t index = currentSession->GetNextFreeIndex( );
 			ConnectionInfo newConnectionInfo( index, sender.fromAddress, StringFromSockAddr( &sender.fromAddress ), request.username );
 			NetConnection * newConnection = currentSession->CreateConnection( newConnectionInfo );
 			newConnection->SetPassword( request.password );
+			newConnection->SetCompressPackets( request.dictionaryHash != 0U && request.dictionaryHash == currentSession->GetPacketDictionaryHash( ) );
 
 			//Send Acceptance
 			currentSession->SendAccept( newConnection, request.nuonce );
@@ -147,7 +161,8 @@ public:
 //-------------------------------------------------------------------------------------------------
 void OnJoinDeny( NetSender const & sender, NetMessage const & message )
 {
-	EventSystem::TriggerEvent( NetSession::ON_JOIN_DENY_EVENT );
+	NamedProperties denyEvent;
+	sender.session->BroadcastEvent( NetSession::ON_JOIN_DENY_EVENT, denyEvent );
 	g_ConsoleSystem->AddLog( Stringf( "Join Deny Received: %s", StringFromSockAddr( &sender.fromAddress ) ), Console::REMOTE );
 	uint32_t nuonce;
 	message.Read<uint32_t>( &nuonce );
@@ -209,8 +224,8 @@ void OnJoinAccept( NetSender const & sender, NetMessage const & message )
 	}
 	
 	//Read host info
-	byte_t index;
-	message.Read<byte_t>( &index );
+	uint16_t index;
+	message.Read<uint16_t>( &index );
 	char * hostUsername;
 	message.ReadString( &( hostUsername ) );
 	ConnectionInfo hostInfo( index, sender.fromAddress, StringFromSockAddr( &sender.fromAddress ), hostUsername );
@@ -221,10 +236,15 @@ void OnJoinAccept( NetSender const & sender, NetMessage const & message )
 	currentSession->Connect( host );
 
 	//Read my info
-	message.Read<byte_t>( &index );
+	message.Read<uint16_t>( &index );
 	ConnectionInfo joineeInfo = ConnectionInfo( index, currentConnection->GetAddress( ), currentConnection->GetGUID( ), currentConnection->GetUsername() );
 	currentConnection->SetConnectionInfo( joineeInfo );
 
+	//Host only echoes the dictionary back if it has the same one
+	uint32_t dictionaryHash = 0U;
+	message.Read<uint32_t>( &dictionaryHash );
+	host->SetCompressPackets( dictionaryHash != 0U && dictionaryHash == currentSession->GetPacketDictionaryHash( ) );
+
 	//Establish Connection
 	currentSession->Connect( currentConnection );
 
@@ -252,14 +272,42 @@ void OnLeave( NetSender const & sender, NetMessage const & )
 }
 
 
+//-------------------------------------------------------------------------------------------------
+void OnFragment( NetSender const & sender, NetMessage const & message )
+{
+	sender.connection->ProcessFragment( sender, message );
+}
+
+
 //-------------------------------------------------------------------------------------------------
 NetSession::NetSession( uint16_t gameVersion /*= 0U*/ )
 	: m_channel( )
+	, m_messageArena( )
+	, m_trafficCapture( )
+	, m_packetDictionary( )
+	, m_packetSamples( )
+	, m_compressionStats( )
+	, m_activeConnections( )
+	, m_connectionLimit( (uint16_t) MAX_CONNECTIONS )
+	, m_connectionLookup( )
 	, m_self( nullptr )
 	, m_host( nullptr )
 	, m_state( eNetSessionState_INVALID )
 	, m_definitionCount( 0 )
 	, m_connectionTimeouts( true )
+	, m_broadcastEvents( true )
+	, m_sendScheduler( 1.0 / SEND_RATE, 1 )
+	, m_lastUpdateSeconds( 0.0 )
+	, m_telemetryFile( nullptr )
+	, m_telemetryInterval( 0.0 )
+	, m_nextTelemetryTime( 0.0 )
+	, m_netThread( nullptr )
+	, m_netThreadRunning( false )
+	, m_sendRequested( false )
+	, m_netLock( )
+	, m_gameLockDepth( 0 )
+	, m_incomingHandoff( nullptr )
+	, m_outgoingHandoff( nullptr )
 	, m_invalidPacketCount( 0 )
 	, m_invalidMessageCount( 0 )
 	, m_lastError( eNetSessionError_NONE )
@@ -271,7 +319,9 @@ NetSession::NetSession( uint16_t gameVersion /*= 0U*/ )
 	for( size_t index = 0; index < MAX_CONNECTIONS; ++index )
 	{
 		m_connections[index] = nullptr;
+		m_activePositions[index] = INVALID_INDEX;
 	}
+	m_activeConnections.reserve( MAX_CONNECTIONS );
 
 	//Clear out all messages
 	for( size_t defIndex = 0; defIndex < MAX_DEFINITIONS; ++defIndex )
@@ -305,6 +355,11 @@ NetSession::NetSession( uint16_t gameVersion /*= 0U*/ )
 	controlFlags = NetMessageDefinition::CONNECTIONLESS_CONTROL_FLAG;
 	optionFlags = NetMessageDefinition::RELIABLE_OPTION_FLAG;
 	RegisterMessage( eNetMessageType_JOIN_ACCEPT, OnJoinAccept, controlFlags, optionFlags );
+
+	//Connection Required, Reliable, Sequence
+	controlFlags = 0;
+	optionFlags = NetMessageDefinition::RELIABLE_OPTION_FLAG | NetMessageDefinition::SEQUENCE_OPTION_FLAG;
+	RegisterMessage( eNetMessageType_FRAGMENT, OnFragment, controlFlags, optionFlags, FRAGMENT_CHANNEL );
 }
 
 
@@ -312,6 +367,8 @@ NetSession::NetSession( uint16_t gameVersion /*= 0U*/ )
 NetSession::~NetSession( )
 {
 	EventSystem::Unregister( this );
+	StopNetThread( );
+	StopTelemetryExport( );
 
 
 	//Delete all registered messages
@@ -327,6 +384,7 @@ NetSession::~NetSession( )
 	DisconnectOtherClientConnections( );
 	Disconnect( &m_host );
 
+	m_channel.FlushPackets( );
 	m_channel.Unbind( );
 }
 
@@ -334,13 +392,25 @@ NetSession::~NetSession( )
 //-------------------------------------------------------------------------------------------------
 void NetSession::OnUpdate( NamedProperties & )
 {
+	double updateStart = Time::GetCurrentTimeSeconds( );
+	LockNetThread( );
 	UpdateState( m_state );
+	UnlockNetThread( );
+	UpdateTelemetryExport( );
+	m_lastUpdateSeconds = Time::GetCurrentTimeSeconds( ) - updateStart;
 }
 
 
 //-------------------------------------------------------------------------------------------------
 void NetSession::ProcessIncomingPackets( )
 {
+	//The network thread already received and acked them, only the callbacks are left
+	if( IsNetThreadRunning( ) )
+	{
+		DispatchIncomingMessages( );
+		return;
+	}
+
 	m_channel.RecvPackets( this );
 }
 
@@ -348,28 +418,42 @@ void NetSession::ProcessIncomingPackets( )
 //-------------------------------------------------------------------------------------------------
 void NetSession::ProcessOutgoingPackets( )
 {
-	static float timeSinceLastUpdate = 0.f;
-	timeSinceLastUpdate += Time::DELTA_SECONDS;
-	if( timeSinceLastUpdate >= SEND_RATE )
+	//A late update sends once, the ticks it missed are dropped rather than burst
+	if( m_sendScheduler.Advance( Time::GetCurrentTimeSeconds( ) ) > 0 )
 	{
-		for(size_t index = 0; index < MAX_CONNECTIONS; ++index )
+		double sendStart = Time::GetCurrentTimeSeconds( );
+
+		//Encode shared state once, then fan it out per connection
+		NamedProperties snapshotEvent;
+		BroadcastEvent( PREPARE_SNAPSHOT_EVENT, snapshotEvent );
+		for( size_t activeIndex = 0; activeIndex < m_activeConnections.size( ); ++activeIndex )
 		{
-			if( !m_connections[index] )
+			NetConnection * connection = m_activeConnections[activeIndex];
+			NamedProperties netEvent;
+			netEvent.Set( "connection", connection );
+			BroadcastEvent( PREPARE_PACKET_EVENT, netEvent );
+			if( !IsNetThreadRunning( ) )
 			{
-				continue;
+				connection->SendPacket( );
 			}
-			NamedProperties netEvent;
-			netEvent.Set( "connection", m_connections[index] );
-			EventSystem::TriggerEvent( PREPARE_PACKET_EVENT, netEvent );
-			m_connections[index]->SendPacket( );
 		}
+		BroadcastEvent( FINISH_SNAPSHOT_EVENT, snapshotEvent );
 
-		//I only want to process packets at most once per frame
-		while( timeSinceLastUpdate >= SEND_RATE )
+		//The network thread sends on its own tick, ask it not to wait for it with a fresh snapshot
+		if( IsNetThreadRunning( ) )
 		{
-			timeSinceLastUpdate -= SEND_RATE;
+			m_sendRequested = true;
 		}
+		else
+		{
+			m_channel.MarkTick( );
+			m_messageArena.MarkTick( );
+		}
+		m_sendScheduler.RecordTick( Time::GetCurrentTimeSeconds( ) - sendStart );
 	}
+
+	//Everything queued this frame goes out together
+	m_channel.FlushPackets( );
 }
 
 
@@ -378,7 +462,7 @@ void NetSession::CheckForDisconnect( )
 {
 	if( m_host )
 	{
-		float timeElapsed = (float) ( Time::TOTAL_SECONDS - m_host->m_timeLastRecv );
+		float timeElapsed = (float) ( Time::GetCurrentTimeSeconds( ) - m_host->m_timeLastRecv );
 		if( timeElapsed > DISCONNECT_INTERVAL_SECONDS && m_connectionTimeouts )
 		{
 			g_ConsoleSystem->AddLog( "Connection to host timed out", Console::BAD );
@@ -386,25 +470,358 @@ void NetSession::CheckForDisconnect( )
 		}
 	}
 
-	for( size_t index = 0; index < MAX_CONNECTIONS; ++index )
+	if( !m_connectionTimeouts )
+	{
+		return;
+	}
+
+	//Backwards, a disconnect moves the last connection into its place
+	double currentTime = Time::GetCurrentTimeSeconds( );
+	for( size_t activeIndex = m_activeConnections.size( ); activeIndex > 0; --activeIndex )
 	{
-		if( !m_connections[index] )
+		if( activeIndex > m_activeConnections.size( ) )
 		{
 			continue;
 		}
-		
-		float timeElapsed = ( float )( Time::TOTAL_SECONDS - m_connections[index]->m_timeLastRecv );
-		if( timeElapsed > DISCONNECT_INTERVAL_SECONDS && m_connectionTimeouts )
+
+		NetConnection * connection = m_activeConnections[activeIndex - 1];
+		float timeElapsed = ( float )( currentTime - connection->m_timeLastRecv );
+		if( timeElapsed > DISCONNECT_INTERVAL_SECONDS )
+		{
+			g_ConsoleSystem->AddLog( Stringf( "Connection %u timed out", connection->GetIndex( ) ), Console::BAD );
+			Disconnect( &m_connections[connection->GetIndex( )] );
+		}
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Session events go through the global EventSystem, so a muted session keeps them to itself
+void NetSession::BroadcastEvent( char const * eventName, NamedProperties & eventData ) const
+{
+	if( m_broadcastEvents )
+	{
+		EventSystem::TriggerEvent( eventName, eventData );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Moves receiving, acks, resends, heartbeats and sending onto their own thread so a long frame
+// doesn't hold them up. Message callbacks and session events stay on the game thread.
+bool NetSession::StartNetThread( )
+{
+	if( m_netThread )
+	{
+		return false;
+	}
+
+	//Each queue is ~1.5MB of payload slots, sessions without a network thread never pay for them
+	m_incomingHandoff = new SPSCQueue<HandoffMessage>( HANDOFF_QUEUE_SIZE );
+	m_outgoingHandoff = new SPSCQueue<HandoffMessage>( HANDOFF_QUEUE_SIZE );
+
+	//The thread's first pass waits on the lock until m_netThread is set
+	LockNetThread( );
+	m_netThreadRunning = true;
+	m_netThread = new Thread( NetThreadEntry, this );
+	UnlockNetThread( );
+	return true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void NetSession::StopNetThread( )
+{
+	if( !m_netThread )
+	{
+		return;
+	}
+
+	m_netThreadRunning = false;
+	m_netThread->Join( );
+	delete m_netThread;
+	m_netThread = nullptr;
+
+	//Nothing else produces now, hand over whatever was still in flight
+	DrainOutgoingMessages( );
+	DispatchIncomingMessages( );
+	while( !m_incomingOverflow.empty( ) )
+	{
+		FlushOverflow( *m_incomingHandoff, m_incomingOverflow );
+		DispatchIncomingMessages( );
+	}
+
+	delete m_incomingHandoff;
+	m_incomingHandoff = nullptr;
+	delete m_outgoingHandoff;
+	m_outgoingHandoff = nullptr;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Network thread loop. Every pass takes queued sends, receives and acks, and sends on the session
+// tick or as soon as the game thread finishes a snapshot, on a real clock instead of frame time.
+void NetSession::RunNetThread( )
+{
+	double lastTime = Time::GetCurrentTimeSeconds( );
+	double timeSinceLastSend = 0.0;
+	while( m_netThreadRunning )
+	{
+		double currentTime = Time::GetCurrentTimeSeconds( );
+		timeSinceLastSend += currentTime - lastTime;
+		lastTime = currentTime;
+
+		m_netLock.Lock( );
+		if( m_state != eNetSessionState_INVALID )
+		{
+			DrainOutgoingMessages( );
+			FlushOverflow( *m_incomingHandoff, m_incomingOverflow );
+			m_channel.RecvPackets( this );
+
+			bool sendRequested = m_sendRequested.exchange( false );
+			if( sendRequested || timeSinceLastSend >= m_sendScheduler.GetInterval( ) )
+			{
+				for( NetConnection * connection : m_activeConnections )
+				{
+					connection->SendPacket( );
+				}
+				m_channel.MarkTick( );
+				m_messageArena.MarkTick( );
+				timeSinceLastSend = 0.0;
+			}
+
+			m_channel.FlushPackets( );
+		}
+		m_netLock.Unlock( );
+
+		std::this_thread::sleep_for( std::chrono::duration<double>( NET_THREAD_SLEEP_SECONDS ) );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Game thread only, nests. Keeps the network thread out while session state changes, and first
+// queues anything handed off so it stays in order with what gets sent under the lock.
+void NetSession::LockNetThread( ) const
+{
+	if( m_gameLockDepth++ == 0 )
+	{
+		m_netLock.Lock( );
+		DrainOutgoingMessages( );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void NetSession::UnlockNetThread( ) const
+{
+	if( --m_gameLockDepth == 0 )
+	{
+		m_netLock.Unlock( );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Runs the callback now, unless this is the network thread, then the game thread runs it next update
+void NetSession::DeliverMessage( NetSender const & sender, NetMessage const & message ) const
+{
+	if( m_netThread && m_netThread->IsCurrentThread( ) )
+	{
+		PushHandoff( *m_incomingHandoff, m_incomingOverflow, sender.connection, sender.fromAddress, message );
+		return;
+	}
+
+	message.Process( sender );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Game thread sends go through the handoff queue while the network thread runs, unless the game
+// thread holds the lock. Returns false if the caller should queue the message itself.
+bool NetSession::DeferMessage( NetConnection * connection, NetMessage const & message ) const
+{
+	if( !m_netThread || m_netThread->IsCurrentThread( ) || m_gameLockDepth > 0 )
+	{
+		return false;
+	}
+
+	sockaddr_in address = connection ? connection->GetAddress( ) : sockaddr_in( );
+	PushHandoff( *m_outgoingHandoff, m_outgoingOverflow, connection, address, message );
+	return true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Callbacks for everything the network thread decoded, in the order it came off the wire
+void NetSession::DispatchIncomingMessages( )
+{
+	if( m_incomingHandoff == nullptr )
+	{
+		return;
+	}
+
+	while( HandoffMessage * handoff = m_incomingHandoff->GetReadSlot( ) )
+	{
+		NetSender sender;
+		sender.session = this;
+		sender.connection = handoff->connection;
+		sender.fromAddress = handoff->fromAddress;
+
+		//Drop what's left from a connection that was disconnected while it waited
+		if( sender.connection == nullptr || IsLiveConnection( sender.connection, handoff->connectionIndex ) )
+		{
+			OwnedNetMessage message( handoff->payload, handoff->payloadSize );
+			ReadHandoff( *handoff, &message );
+			message.Process( sender );
+		}
+		m_incomingHandoff->CommitRead( );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Late updates write one set of lines, the missed intervals aren't made up
+void NetSession::UpdateTelemetryExport( )
+{
+	if( m_telemetryFile == nullptr )
+	{
+		return;
+	}
+
+	double currentTime = Time::GetCurrentTimeSeconds( );
+	if( currentTime < m_nextTelemetryTime )
+	{
+		return;
+	}
+	m_nextTelemetryTime = currentTime + m_telemetryInterval;
+
+	std::string telemetry;
+	WriteTelemetry( &telemetry );
+	if( !telemetry.empty( ) )
+	{
+		fwrite( telemetry.data( ), 1, telemetry.size( ), m_telemetryFile );
+		fflush( m_telemetryFile );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Under the lock. Queue entries are older than anything in the overflow, which only its producer,
+// the game thread, can touch. Nothing was handed off when the network thread isn't running.
+void NetSession::DrainOutgoingMessages( ) const
+{
+	if( m_outgoingHandoff == nullptr )
+	{
+		return;
+	}
+
+	while( HandoffMessage * handoff = m_outgoingHandoff->GetReadSlot( ) )
+	{
+		QueueHandoff( *handoff );
+		m_outgoingHandoff->CommitRead( );
+	}
+
+	if( !m_netThread || !m_netThread->IsCurrentThread( ) )
+	{
+		while( !m_outgoingOverflow.empty( ) )
+		{
+			QueueHandoff( m_outgoingOverflow.front( ) );
+			m_outgoingOverflow.pop_front( );
+		}
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void NetSession::QueueHandoff( HandoffMessage & handoff ) const
+{
+	OwnedNetMessage message( handoff.payload, handoff.payloadSize );
+	ReadHandoff( handoff, &message );
+
+	//Every client, serialized once like AddMessageToAllClients()
+	if( handoff.connection == nullptr )
+	{
+		NetMessage * shared = m_messageArena.Share( message );
+		for( NetConnection * connection : m_activeConnections )
+		{
+			connection->AddMessage( *shared );
+		}
+		m_messageArena.Release( shared );
+	}
+	else if( IsLiveConnection( handoff.connection, handoff.connectionIndex ) )
+	{
+		handoff.connection->AddMessage( message );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Keeps order, once anything has spilled everything behind it spills too until the queue catches up
+void NetSession::PushHandoff( SPSCQueue<HandoffMessage> & queue, std::deque<HandoffMessage> & overflow, NetConnection * connection, sockaddr_in const & address, NetMessage const & message ) const
+{
+	FlushOverflow( queue, overflow );
+
+	HandoffMessage * handoff = overflow.empty( ) ? queue.GetWriteSlot( ) : nullptr;
+	bool spilled = ( handoff == nullptr );
+	if( spilled )
+	{
+		overflow.emplace_back( );
+		handoff = &overflow.back( );
+	}
+
+	handoff->connection = connection;
+	handoff->connectionIndex = connection ? connection->GetIndex( ) : INVALID_INDEX;
+	handoff->fromAddress = address;
+	handoff->type = message.m_type;
+	handoff->senderIndex = message.m_senderIndex;
+	handoff->reliableID = message.m_reliableID;
+	handoff->sequenceID = message.m_sequenceID;
+	handoff->deliveryTag = message.m_deliveryTag;
+	handoff->coalesceKey = message.m_coalesceKey;
+	handoff->payloadSize = message.GetPayloadSize( );
+	memcpy( handoff->payload, message.GetBuffer( ), handoff->payloadSize );
+
+	if( !spilled )
+	{
+		queue.CommitWrite( );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void NetSession::FlushOverflow( SPSCQueue<HandoffMessage> & queue, std::deque<HandoffMessage> & overflow ) const
+{
+	while( !overflow.empty( ) )
+	{
+		HandoffMessage * handoff = queue.GetWriteSlot( );
+		if( !handoff )
 		{
-			g_ConsoleSystem->AddLog( Stringf( "Connection %d timed out", index ), Console::BAD );
-			Disconnect( &m_connections[index] );
+			return;
 		}
+		*handoff = overflow.front( );
+		queue.CommitWrite( );
+		overflow.pop_front( );
 	}
 }
 
 
 //-------------------------------------------------------------------------------------------------
-void NetSession::RegisterMessage( eNetMessageType const & type, MessageCallback * cb, byte_t const & setTypeFlags /*= 0*/, byte_t const & setOptionFlags /*= 0*/, byte_t const & setChannel /*= 0 */ )
+// Everything but the payload, which the message was constructed with
+void NetSession::ReadHandoff( HandoffMessage const & handoff, NetMessage * out_message ) const
+{
+	out_message->m_type = handoff.type;
+	out_message->m_definition = GetDefinition( (eNetMessageType) handoff.type );
+	out_message->m_senderIndex = handoff.senderIndex;
+	out_message->m_reliableID = handoff.reliableID;
+	out_message->m_sequenceID = handoff.sequenceID;
+	out_message->m_deliveryTag = handoff.deliveryTag;
+	out_message->m_coalesceKey = handoff.coalesceKey;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void NetSession::RegisterMessage( eNetMessageType const & type, MessageCallback * cb, byte_t const & setTypeFlags /*= 0*/, byte_t const & setOptionFlags /*= 0*/, byte_t const & setChannel /*= 0 */, eNetMessagePriority const & setPriority /*= eNetMessagePriority_NORMAL */ )
 {
 	if( GetState( ) != eNetSessionState_INVALID )
 	{
@@ -418,6 +835,7 @@ void NetSession::RegisterMessage( eNetMessageType const & type, MessageCallback
 	def->controlFlags = setTypeFlags;
 	def->optionFlags = setOptionFlags;
 	def->sequenceChannelID = setChannel;
+	def->priority = setPriority;
 	def->CalculateHeaderSize( );
 	def->callback = cb;
 	m_messageDefinitions[type] = def;
@@ -433,6 +851,7 @@ bool NetSession::Start( unsigned int port, unsigned int range /*= PORT_RANGE*/ )
 		return false;
 	}
 
+	LockNetThread( );
 	ChangeState( eNetSessionState_SETUP );
 	m_channel.Bind( NetworkUtils::GetLocalHostName( ), port, range );
 
@@ -445,12 +864,14 @@ bool NetSession::Start( unsigned int port, unsigned int range /*= PORT_RANGE*/ )
 
 		//#TODO: Unique identifier for the definitions registered
 		m_definitionHash = m_definitionCount;
+		UnlockNetThread( );
 		return true;
 	}
 	else
 	{
 		m_lastError = eNetSessionError_SOCKET_CREATION_FAILED;
 		ChangeState( eNetSessionState_INVALID );
+		UnlockNetThread( );
 		g_ConsoleSystem->AddLog( "Start Net Session failed", Console::BAD );
 		return false;
 	}
@@ -471,8 +892,11 @@ void NetSession::Stop( )
 		return;
 	}
 
+	LockNetThread( );
+	m_channel.FlushPackets( );
 	m_channel.Unbind( );
 	ChangeState( eNetSessionState_INVALID );
+	UnlockNetThread( );
 	g_ConsoleSystem->AddLog( "Successfully stopped Net Session", Console::GOOD );
 }
 
@@ -487,6 +911,7 @@ void NetSession::Host( char const * username, size_t password /*= 0*/ )
 	}
 
 	//Make a connection for yourself at conn_index 0
+	LockNetThread( );
 	ChangeState( eNetSessionState_HOSTING );
 	m_host = CreateConnection( HOST_INDEX, m_channel.GetAddress( ), GetAddressString(), username );
 	if( m_host )
@@ -502,6 +927,7 @@ void NetSession::Host( char const * username, size_t password /*= 0*/ )
 		ChangeState( eNetSessionState_DISCONNECTED );
 		m_lastError = eNetSessionError_HOST_CREATION_FAILED;
 	}
+	UnlockNetThread( );
 }
 
 
@@ -515,6 +941,7 @@ void NetSession::Join( sockaddr_in const & hostAddress, char const * username, s
 	}
 
 	g_ConsoleSystem->AddLog( Stringf( "Joining: %s", StringFromSockAddr( &hostAddress ) ), Console::GOOD );
+	LockNetThread( );
 	m_host = CreateConnection( HOST_INDEX, hostAddress, StringFromSockAddr( &hostAddress ), " " );
 	if( m_host )
 	{
@@ -525,11 +952,12 @@ void NetSession::Join( sockaddr_in const & hostAddress, char const * username, s
 		m_self->SetPassword( password );
 		m_self->m_lastJoinRequestNuonce = GetNuonce( );
 
-		NetMessage request( eNetMessageType_JOIN_REQUEST );
+		OwnedNetMessage request( eNetMessageType_JOIN_REQUEST );
 		request.Write<uint64_t>( GetNetSessionVersion( ) );
 		request.Write<uint32_t>( m_self->m_lastJoinRequestNuonce );
 		request.WriteString( username );
 		request.Write<size_t>( password );
+		request.Write<uint32_t>( GetPacketDictionaryHash( ) );
 		m_host->AddMessage( request );
 		m_host->SendPacket( );
 	}
@@ -538,6 +966,7 @@ void NetSession::Join( sockaddr_in const & hostAddress, char const * username, s
 		ChangeState( eNetSessionState_DISCONNECTED );
 		m_lastError = eNetSessionError_HOST_CREATION_FAILED;
 	}
+	UnlockNetThread( );
 }
 
 
@@ -551,19 +980,21 @@ void NetSession::Leave( )
 	}
 
 	//send everyone else a LEAVE message
-	NetMessage leave( eNetMessageType_LEAVE, GetSelf( )->GetIndex( ) );
-	for( uint8_t connIndex = 0; connIndex < MAX_CONNECTIONS; ++connIndex )
+	LockNetThread( );
+	OwnedNetMessage leave( eNetMessageType_LEAVE, GetSelf( )->GetIndex( ) );
+	for( NetConnection * conn : m_activeConnections )
 	{
-		NetConnection * conn = GetNetConnection( connIndex );
-		if( conn && conn != m_self )
+		if( conn != m_self )
 		{
 			conn->AddMessage( leave );
 			conn->SendPacket( );
 		}
 	}
+	m_channel.FlushPackets( );
 
 	//Disconnect self & others & host
 	ChangeState( eNetSessionState_DISCONNECTED );
+	UnlockNetThread( );
 
 	g_ConsoleSystem->AddLog( "Successful leave", Console::GOOD );
 }
@@ -577,7 +1008,7 @@ NetConnection * NetSession::CreateConnection( ConnectionInfo const & connInfo )
 
 
 //-------------------------------------------------------------------------------------------------
-NetConnection * NetSession::CreateConnection( byte_t index, sockaddr_in const & address, std::string const & guid, std::string const & username ) const
+NetConnection * NetSession::CreateConnection( uint16_t index, sockaddr_in const & address, std::string const & guid, std::string const & username ) const
 {
 	if( GetState( ) == eNetSessionState_INVALID )
 	{
@@ -585,7 +1016,8 @@ NetConnection * NetSession::CreateConnection( byte_t index, sockaddr_in const &
 		return nullptr;
 	}
 
-	if( m_connections[index] )
+	//Our own connection has no index until the host accepts it
+	if( index != INVALID_INDEX && ( index >= MAX_CONNECTIONS || m_connections[index] ) )
 	{
 		g_ConsoleSystem->AddLog( "Connection index already exists", Console::BAD );
 		return nullptr;
@@ -605,19 +1037,26 @@ NetConnection * NetSession::CreateConnection( byte_t index, sockaddr_in const &
 //-------------------------------------------------------------------------------------------------
 void NetSession::DisconnectOtherClientConnections( )
 {
-	for( size_t index = 0; index < MAX_CONNECTIONS; ++index )
+	//Backwards, a disconnect moves the last connection into its place
+	for( size_t activeIndex = m_activeConnections.size( ); activeIndex > 0; --activeIndex )
 	{
-		if( m_connections[index] == m_host )
+		if( activeIndex > m_activeConnections.size( ) )
+		{
+			continue;
+		}
+
+		NetConnection * connection = m_activeConnections[activeIndex - 1];
+		if( connection == m_host )
 		{
 			//Nothing
 		}
-		else if( m_connections[index] == m_self )
+		else if( connection == m_self )
 		{
 			//Nothing
 		}
 		else
 		{
-			Disconnect( &m_connections[index] );
+			Disconnect( &m_connections[connection->GetIndex( )] );
 		}
 	}
 }
@@ -626,19 +1065,28 @@ void NetSession::DisconnectOtherClientConnections( )
 //-------------------------------------------------------------------------------------------------
 void NetSession::Connect( NetConnection * connection )
 {
-	if( m_connections[connection->GetIndex( )] )
+	uint16_t index = connection->GetIndex( );
+	if( index >= MAX_CONNECTIONS )
+	{
+		g_ConsoleSystem->AddLog( "Connection index out of range", Console::BAD );
+		return;
+	}
+	if( m_connections[index] )
 	{
 		g_ConsoleSystem->AddLog( "Connection already exists", Console::BAD );
 		return;
 	}
 
 	//Set Connection
-	m_connections[connection->GetIndex()] = connection;
+	m_connections[index] = connection;
+	m_activePositions[index] = (uint16_t) m_activeConnections.size( );
+	m_activeConnections.push_back( connection );
+	m_connectionLookup.Add( index, connection->GetAddress( ), connection->GetGUID( ) );
 
 	//Trigger Join Event
 	NamedProperties netEvent;
 	netEvent.Set( "connection", connection );
-	EventSystem::TriggerEvent( ON_CONNECTION_JOIN_EVENT, netEvent );
+	BroadcastEvent( ON_CONNECTION_JOIN_EVENT, netEvent );
 
 	g_ConsoleSystem->AddLog( Stringf( "Connection %u established", connection->GetIndex() ), Console::GOOD );
 }
@@ -659,11 +1107,11 @@ void NetSession::Disconnect( NetConnection ** connection )
 		//Trigger Leave Event
 		NamedProperties netEvent;
 		netEvent.Set("connection", *connection );
-		EventSystem::TriggerEvent( ON_CONNECTION_LEAVE_EVENT, netEvent );
+		BroadcastEvent( ON_CONNECTION_LEAVE_EVENT, netEvent );
 		m_host = nullptr;
 	}
 
-	byte_t index = ( *connection )->GetIndex( );
+	uint16_t index = ( *connection )->GetIndex( );
 	//Must have been temp, delete them
 	if( index == INVALID_INDEX )
 	{
@@ -673,7 +1121,7 @@ void NetSession::Disconnect( NetConnection ** connection )
 	}
 	//You don't exist, this is a problem... but we'll still clear you out anyways
 	//Aaand the 'temp' host will call this, this is fine
-	else if( m_connections[index] == nullptr )
+	else if( index >= MAX_CONNECTIONS || m_connections[index] == nullptr )
 	{
 		delete *connection;
 		*connection = nullptr;
@@ -684,9 +1132,17 @@ void NetSession::Disconnect( NetConnection ** connection )
 	//Trigger Leave Event
 	NamedProperties netEvent;
 	netEvent.Set( "connection", *connection );
-	EventSystem::TriggerEvent( ON_CONNECTION_LEAVE_EVENT, netEvent );
+	BroadcastEvent( ON_CONNECTION_LEAVE_EVENT, netEvent );
+
+	//Clear connection, the last active connection fills its place
+	uint16_t position = m_activePositions[index];
+	NetConnection * moved = m_activeConnections.back( );
+	m_activeConnections[position] = moved;
+	m_activePositions[moved->GetIndex( )] = position;
+	m_activeConnections.pop_back( );
+	m_activePositions[index] = INVALID_INDEX;
 
-	//Clear connection
+	m_connectionLookup.Remove( index );
 	delete m_connections[index];
 	m_connections[index] = nullptr;
 	*connection = nullptr;
@@ -698,15 +1154,33 @@ void NetSession::Disconnect( NetConnection ** connection )
 //-------------------------------------------------------------------------------------------------
 void NetSession::AddMessageToAllClients( NetMessage & message )
 {
-	for( byte_t connIndex = 0; connIndex < MAX_CONNECTIONS; ++connIndex )
+	if( DeferMessage( nullptr, message ) )
 	{
-		if( m_connections[connIndex] == nullptr )
-		{
-			continue;
-		}
+		return;
+	}
+
+	//Serialize once, every connection queue references the same payload
+	NetMessage * shared = m_messageArena.Share( message );
+	for( NetConnection * connection : m_activeConnections )
+	{
+		connection->AddMessage( *shared );
+	}
+	m_messageArena.Release( shared );
+}
 
-		m_connections[connIndex]->AddMessage( message );
+
+//-------------------------------------------------------------------------------------------------
+// Held so the fragments queue straight onto each connection instead of crossing the handoff one by one
+bool NetSession::AddFragmentedMessageToAllClients( byte_t type, byte_t const * data, size_t dataSize )
+{
+	bool added = true;
+	LockNetThread( );
+	for( NetConnection * connection : m_activeConnections )
+	{
+		added = connection->AddFragmentedMessage( type, data, dataSize ) && added;
 	}
+	UnlockNetThread( );
+	return added;
 }
 
 
@@ -727,9 +1201,12 @@ void NetSession::SendDirect( sockaddr_in const & address, NetMessage & message )
 		return;
 	}
 
+	//Held so the temporary connection queues and sends right here
+	LockNetThread( );
 	NetConnection conn( INVALID_INDEX, address, "", "", this);
 	conn.AddMessage( message );
 	conn.SendPacket( );
+	UnlockNetThread( );
 }
 
 
@@ -737,7 +1214,7 @@ void NetSession::SendDirect( sockaddr_in const & address, NetMessage & message )
 void NetSession::SendDeny( sockaddr_in const & address, eNetSessionError const & reason, uint32_t nuonce ) const
 {
 	g_ConsoleSystem->AddLog( Stringf( "Deny Sent: %s", StringFromSockAddr( &address ) ), Console::REMOTE );
-	NetMessage deny( eNetMessageType_JOIN_DENY );
+	OwnedNetMessage deny( eNetMessageType_JOIN_DENY );
 	deny.Write<uint32_t>( nuonce );
 	deny.Write<uint8_t>( (uint8_t) reason );
 	SendDirect( address, deny );
@@ -748,12 +1225,13 @@ void NetSession::SendDeny( sockaddr_in const & address, eNetSessionError const &
 void NetSession::SendAccept( NetConnection * connection, uint32_t nuonce ) const
 {
 	g_ConsoleSystem->AddLog( Stringf( "Accept Sent: %s", StringFromSockAddr( &connection->GetAddress() ) ), Console::REMOTE );
-	NetMessage accept( eNetMessageType_JOIN_ACCEPT );
+	OwnedNetMessage accept( eNetMessageType_JOIN_ACCEPT );
 
 	accept.Write<uint32_t>( nuonce );
-	accept.Write<byte_t>( m_host->GetIndex( ) );
+	accept.Write<uint16_t>( m_host->GetIndex( ) );
 	accept.WriteString( m_host->GetUsername( ) );
-	accept.Write<byte_t>( connection->GetIndex() );
+	accept.Write<uint16_t>( connection->GetIndex() );
+	accept.Write<uint32_t>( connection->IsCompressingPackets( ) ? GetPacketDictionaryHash( ) : 0U );
 
 	connection->AddMessage( accept );
 	//Do not need to immediately send a packet, it's connected, so it will automatically send OnUpdate()
@@ -761,20 +1239,81 @@ void NetSession::SendAccept( NetConnection * connection, uint32_t nuonce ) const
 
 
 //-------------------------------------------------------------------------------------------------
-void NetSession::SendPacket( sockaddr_in const & address, byte_t const * data, size_t dataSize ) const
+// Bytes that went on the wire. Capture and samples see the packet uncompressed, compression keeps
+// the header as is and only goes out if it saves at least a byte.
+size_t NetSession::SendPacket( sockaddr_in const & address, byte_t const * data, size_t dataSize, bool compress /*= false*/ ) const
 {
+	m_trafficCapture.RecordPacket( true, data, dataSize );
+	if( dataSize > NetPacket::HEADER_SIZE )
+	{
+		m_packetSamples.Add( data + NetPacket::HEADER_SIZE, dataSize - NetPacket::HEADER_SIZE );
+	}
+
+	//Heartbeats are just the header and count, nothing to gain
+	if( compress && !m_packetDictionary.IsEmpty( ) && dataSize > NetPacket::HEADER_SIZE + 2 )
+	{
+		byte_t compressed[NetPacket::MAX_SIZE];
+		size_t bodySize = dataSize - NetPacket::HEADER_SIZE;
+		size_t compressedSize = PacketCompressor::Compress( &m_packetDictionary, data + NetPacket::HEADER_SIZE, bodySize, compressed + NetPacket::HEADER_SIZE + 1, bodySize - 2 );
+		if( compressedSize > 0 )
+		{
+			memcpy( compressed, data, NetPacket::HEADER_SIZE );
+			compressed[NetPacket::HEADER_SIZE] = NetPacket::COMPRESSED_MESSAGE_COUNT;
+			size_t sentSize = NetPacket::HEADER_SIZE + 1 + compressedSize;
+			++m_compressionStats.compressedCount;
+			m_compressionStats.rawBytes += dataSize;
+			m_compressionStats.compressedBytes += sentSize;
+			m_channel.SendPackets( address, compressed, sentSize );
+			return sentSize;
+		}
+		++m_compressionStats.skippedCount;
+	}
+
 	m_channel.SendPackets( address, data, dataSize );
+	return dataSize;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Decompresses in place before the packet is validated, false if it can't be read
+bool NetSession::ExpandPacket( NetPacket & packet ) const
+{
+	size_t packetSize = packet.GetSize( );
+	byte_t * buffer = packet.GetBuffer( );
+	if( packetSize <= NetPacket::HEADER_SIZE || buffer[NetPacket::HEADER_SIZE] != NetPacket::COMPRESSED_MESSAGE_COUNT )
+	{
+		return true;
+	}
+
+	//Sent by someone who thought we agreed on a dictionary
+	if( m_packetDictionary.IsEmpty( ) )
+	{
+		return false;
+	}
+
+	byte_t body[NetPacket::MAX_SIZE];
+	size_t bodySize = PacketCompressor::Decompress( &m_packetDictionary, buffer + NetPacket::HEADER_SIZE + 1, packetSize - NetPacket::HEADER_SIZE - 1, body, NetPacket::MAX_SIZE - NetPacket::HEADER_SIZE );
+	if( bodySize == 0 )
+	{
+		return false;
+	}
+
+	memcpy( buffer + NetPacket::HEADER_SIZE, body, bodySize );
+	packet.SetBufferSize( NetPacket::HEADER_SIZE + bodySize );
+	return true;
 }
 
 
 //-------------------------------------------------------------------------------------------------
 void NetSession::ProcessPacket( NetPacket & packet )
 {
+	m_trafficCapture.RecordPacket( false, packet.GetBuffer( ), packet.GetSize( ) );
+
 	PacketHeader header;
 	packet.ReadHeader( &header );
 
 	//Connection received packet
-	packet.m_senderInfo.connection = GetNetConnection( packet.m_senderInfo.fromAddress );
+	packet.m_senderInfo.connection = GetNetConnection( header.fromConnIndex, packet.m_senderInfo.fromAddress );
 
 	//Still need to make packets with no contents
 	if( header.messageCount == 0 )
@@ -788,7 +1327,7 @@ void NetSession::ProcessPacket( NetPacket & packet )
 	for( size_t messageIndex = 0; messageIndex < header.messageCount; ++messageIndex )
 	{
 		//Read Message
-		NetMessage message;
+		OwnedNetMessage message;
 		ReadMessage( packet, &message );
 
 		//Set Ack ID from packet (used in unreliable sequenced messages)
@@ -816,7 +1355,7 @@ void NetSession::ProcessPacket( NetPacket & packet )
 				continue;
 			}
 
-			message.Process( packet.m_senderInfo );
+			DeliverMessage( packet.m_senderInfo, message );
 			
 			//Check again and mark received
 			if( message.m_definition->IsReliable( ) )
@@ -857,7 +1396,7 @@ void NetSession::ReadMessage( NetPacket const & packet, NetMessage * out_message
 	if( !out_message->m_definition->IsConnectionless( ) )
 	{
 		packet.Read( &( out_message->m_senderIndex ) );
-		messageSize -= 1; //One less because we just read a byte
+		messageSize -= 2; //Two less because we just read 2 bytes
 	}
 
 	//Read ReliableID
@@ -977,7 +1516,6 @@ void NetSession::UpdateState( eNetSessionState const & state )
 		CheckForDisconnect( );
 		break;
 	}
-	m_NetworkTrafficActivity.WriteToFile( );
 	g_ProfilerSystem->StopSample( );
 }
 
@@ -985,29 +1523,64 @@ void NetSession::UpdateState( eNetSessionState const & state )
 //-------------------------------------------------------------------------------------------------
 NetConnection * NetSession::GetNetConnection( sockaddr_in const & address ) const
 {
-	for( size_t index = 0; index < MAX_CONNECTIONS; ++index )
+	uint16_t index = m_connectionLookup.FindAddress( address );
+	if( index == INVALID_INDEX )
 	{
-		if( !m_connections[index] )
-		{
-			continue;
-		}
-		if( IsEqual( m_connections[index]->GetAddress( ), address ) )
+		return nullptr;
+	}
+	return m_connections[index];
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// The packet header says who sent it, trust it only if the address matches that connection
+NetConnection * NetSession::GetNetConnection( uint16_t fromConnIndex, sockaddr_in const & address ) const
+{
+	if( fromConnIndex < MAX_CONNECTIONS )
+	{
+		NetConnection * connection = m_connections[fromConnIndex];
+		if( connection && IsEqual( connection->GetAddress( ), address ) )
 		{
-			return m_connections[index];
+			return connection;
 		}
 	}
-
-	return nullptr;
+	return GetNetConnection( address );
 }
 
 
 //-------------------------------------------------------------------------------------------------
-NetConnection * NetSession::GetNetConnection( uint8_t netIndex )
+NetConnection * NetSession::GetNetConnection( uint16_t netIndex )
 {
+	if( netIndex >= MAX_CONNECTIONS )
+	{
+		return nullptr;
+	}
 	return m_connections[netIndex];
 }
 
 
+//-------------------------------------------------------------------------------------------------
+// Every established connection, self and host included, in no particular order
+std::vector<NetConnection*> const & NetSession::GetActiveConnections( ) const
+{
+	return m_activeConnections;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t NetSession::GetConnectionCount( ) const
+{
+	return m_activeConnections.size( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+uint16_t NetSession::GetConnectionLimit( ) const
+{
+	return m_connectionLimit;
+}
+
+
 //-------------------------------------------------------------------------------------------------
 PacketChannel const & NetSession::GetPacketChannel( ) const
 {
@@ -1015,6 +1588,13 @@ PacketChannel const & NetSession::GetPacketChannel( ) const
 }
 
 
+//-------------------------------------------------------------------------------------------------
+NetMessageArena & NetSession::GetMessageArena( ) const
+{
+	return m_messageArena;
+}
+
+
 //-------------------------------------------------------------------------------------------------
 UDPSock const & NetSession::GetSocket( ) const
 {
@@ -1057,17 +1637,41 @@ eNetSessionState NetSession::GetState( ) const
 }
 
 
+//-------------------------------------------------------------------------------------------------
+// Wall time of the last OnUpdate(), including every message handler and event it ran
+double NetSession::GetLastUpdateSeconds( ) const
+{
+	return m_lastUpdateSeconds;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+double NetSession::GetSendInterval( ) const
+{
+	return m_sendScheduler.GetInterval( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+TickScheduler const & NetSession::GetSendScheduler( ) const
+{
+	return m_sendScheduler;
+}
+
+
 //-------------------------------------------------------------------------------------------------
 float NetSession::GetSimDropRate( ) const
 {
-	return m_channel.m_dropRate;
+	return m_channel.GetIncomingLink( ).GetProfile( ).goodLossRate;
 }
 
 
 //-------------------------------------------------------------------------------------------------
 Range<double> const NetSession::GetLatency( ) const
 {
-	return m_channel.m_latency;
+	LinkProfile const & profile = m_channel.GetIncomingLink( ).GetProfile( );
+	double minimum = profile.latency - profile.jitter;
+	return Range<double>( minimum > 0.0 ? minimum : 0.0, profile.latency + profile.jitter );
 }
 
 
@@ -1096,16 +1700,18 @@ uint32_t NetSession::GetNuonce( ) const
 
 
 //-------------------------------------------------------------------------------------------------
-byte_t NetSession::GetNextFreeIndex( ) const
+// Lowest free index, so indices stay under the limit. INVALID_INDEX once the limit is reached
+uint16_t NetSession::GetNextFreeIndex( ) const
 {
-	byte_t check = 0;
+	if( m_activeConnections.size( ) >= m_connectionLimit )
+	{
+		return INVALID_INDEX;
+	}
+
+	uint16_t check = 0;
 	while( m_connections[check] )
 	{
 		++check;
-		if( check == INVALID_INDEX )
-		{
-			return INVALID_INDEX;
-		}
 	}
 	return check;
 }
@@ -1187,7 +1793,7 @@ bool NetSession::IsValidMessage( NetSender const & senderInfo, NetMessage const
 
 
 //-------------------------------------------------------------------------------------------------
-bool NetSession::IsValidConnectionIndex( byte_t index ) const
+bool NetSession::IsValidConnectionIndex( uint16_t index ) const
 {
 	if( index < MAX_CONNECTIONS )
 	{
@@ -1200,41 +1806,303 @@ bool NetSession::IsValidConnectionIndex( byte_t index ) const
 //-------------------------------------------------------------------------------------------------
 bool NetSession::IsDuplicateGUID( std::string const & check ) const
 {
-	for( byte_t connIndex = 0; connIndex < MAX_CONNECTIONS; ++connIndex )
+	return m_connectionLookup.FindGUID( check.c_str( ) ) != INVALID_INDEX;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool NetSession::IsHost( ) const
+{
+	return m_self == m_host && m_host != nullptr;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool NetSession::IsNetThreadRunning( ) const
+{
+	return m_netThread != nullptr;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// The index is what the connection had when the pointer was taken, in case the pointer is stale
+bool NetSession::IsLiveConnection( NetConnection const * connection, uint16_t index ) const
+{
+	if( connection == nullptr )
 	{
-		//Skip connections that don't exist
-		if( !m_connections[connIndex] )
+		return false;
+	}
+	else if( connection == m_self || connection == m_host )
+	{
+		return true;
+	}
+	return index < MAX_CONNECTIONS && m_connections[index] == connection;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Uniform loss on the incoming link, anything else in its profile is kept
+void NetSession::SetDropRate( float dropRate )
+{
+	LockNetThread( );
+	LinkEmulator & link = m_channel.GetIncomingLink( );
+	LinkProfile profile = link.GetProfile( );
+	profile.name = "custom";
+	profile.goodLossRate = dropRate;
+	profile.goodToBadChance = 0.f;
+	profile.badLossRate = dropRate;
+	link.SetProfile( profile );
+	UnlockNetThread( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Incoming link delay picked evenly between min and max, anything else in its profile is kept
+void NetSession::SetLatency( Range<double> latency )
+{
+	double minimum = latency.Get( 0.f );
+	double maximum = latency.Get( 1.f );
+
+	LockNetThread( );
+	LinkEmulator & link = m_channel.GetIncomingLink( );
+	LinkProfile profile = link.GetProfile( );
+	profile.name = "custom";
+	profile.latency = ( minimum + maximum ) * 0.5;
+	profile.jitter = ( maximum - minimum ) * 0.5;
+	link.SetProfile( profile );
+	UnlockNetThread( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Same profile both ways, each direction gets its own stream from the seed
+void NetSession::SetLinkProfile( LinkProfile const & profile, uint64_t seed )
+{
+	LockNetThread( );
+	m_channel.GetOutgoingLink( ).SetProfile( profile );
+	m_channel.GetOutgoingLink( ).SetSeed( seed );
+	m_channel.GetIncomingLink( ).SetProfile( profile );
+	m_channel.GetIncomingLink( ).SetSeed( seed + 1 );
+	UnlockNetThread( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void NetSession::ResetSocketStats( )
+{
+	LockNetThread( );
+	m_channel.ResetStats( );
+	UnlockNetThread( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void NetSession::ResetSendStats( )
+{
+	LockNetThread( );
+	m_sendScheduler.ResetStats( );
+	UnlockNetThread( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Every packet sent and received from here on, the ring keeps the newest recordCount records
+void NetSession::StartTrafficCapture( size_t recordCount )
+{
+	LockNetThread( );
+	m_trafficCapture.Start( recordCount );
+	UnlockNetThread( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void NetSession::StopTrafficCapture( )
+{
+	LockNetThread( );
+	m_trafficCapture.Stop( );
+	UnlockNetThread( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Capture keeps running, see TrafficCapture::WriteReport() to read the file back
+bool NetSession::DumpTrafficCapture( char const * path ) const
+{
+	LockNetThread( );
+	bool dumped = m_trafficCapture.Dump( path );
+	UnlockNetThread( );
+	return dumped;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// JSON lines, one object per remote connection, see NetConnection::AppendTelemetryJSON()
+void NetSession::WriteTelemetry( std::string * out_json ) const
+{
+	double time = Time::GetCurrentTimeSeconds( );
+	LockNetThread( );
+	for( NetConnection const * connection : m_activeConnections )
+	{
+		if( connection->IsSelf( ) )
 		{
 			continue;
 		}
+		connection->AppendTelemetryJSON( time, out_json );
+		out_json->push_back( '\n' );
+	}
+	UnlockNetThread( );
+}
 
-		if( strcmp( m_connections[connIndex]->GetGUID( ), check.c_str( ) ) == 0 )
-		{
-			return true;
-		}
+
+//-------------------------------------------------------------------------------------------------
+// Appends to the file every interval from OnUpdate(), restarting replaces any export already running
+bool NetSession::StartTelemetryExport( char const * path, double intervalSeconds )
+{
+	StopTelemetryExport( );
+	if( intervalSeconds <= 0.0 )
+	{
+		return false;
 	}
-	return false;
+
+	errno_t errorSuccess = fopen_s( &m_telemetryFile, path, "ab" );
+	if( errorSuccess != 0 || m_telemetryFile == nullptr )
+	{
+		m_telemetryFile = nullptr;
+		return false;
+	}
+
+	m_telemetryInterval = intervalSeconds;
+	m_nextTelemetryTime = Time::GetCurrentTimeSeconds( );
+	return true;
 }
 
 
 //-------------------------------------------------------------------------------------------------
-bool NetSession::IsHost( ) const
+void NetSession::StopTelemetryExport( )
 {
-	return m_self == m_host && m_host != nullptr;
+	if( m_telemetryFile != nullptr )
+	{
+		fclose( m_telemetryFile );
+		m_telemetryFile = nullptr;
+	}
 }
 
 
 //-------------------------------------------------------------------------------------------------
-void NetSession::SetDropRate( float dropRate )
+bool NetSession::IsExportingTelemetry( ) const
 {
-	m_channel.m_dropRate = dropRate;
+	return m_telemetryFile != nullptr;
 }
 
 
 //-------------------------------------------------------------------------------------------------
-void NetSession::SetLatency( Range<double> latency )
+// Both ends need the same one, it's agreed per connection at join, so it can't change while connected
+bool NetSession::SetPacketDictionary( PacketDictionary const & dictionary )
 {
-	m_channel.m_latency = latency;
+	if( GetState( ) != eNetSessionState_INVALID && GetState( ) != eNetSessionState_DISCONNECTED )
+	{
+		return false;
+	}
+
+	LockNetThread( );
+	m_packetDictionary = dictionary;
+	UnlockNetThread( );
+	return true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+uint32_t NetSession::GetPacketDictionaryHash( ) const
+{
+	return m_packetDictionary.GetHash( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+PacketCompressionStats NetSession::GetCompressionStats( ) const
+{
+	LockNetThread( );
+	PacketCompressionStats stats = m_compressionStats;
+	UnlockNetThread( );
+	return stats;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void NetSession::ResetCompressionStats( )
+{
+	LockNetThread( );
+	memset( &m_compressionStats, 0, sizeof( m_compressionStats ) );
+	UnlockNetThread( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Records the next sent packet bodies, up to the count, see PacketDictionary::Train()
+void NetSession::StartPacketSampling( size_t sampleCount )
+{
+	LockNetThread( );
+	m_packetSamples.Start( sampleCount );
+	UnlockNetThread( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void NetSession::StopPacketSampling( )
+{
+	LockNetThread( );
+	m_packetSamples.Stop( );
+	UnlockNetThread( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool NetSession::SavePacketSamples( char const * path ) const
+{
+	LockNetThread( );
+	bool saved = m_packetSamples.Save( path );
+	UnlockNetThread( );
+	return saved;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t NetSession::GetPacketSampleCount( ) const
+{
+	LockNetThread( );
+	size_t sampleCount = m_packetSamples.GetCount( );
+	UnlockNetThread( );
+	return sampleCount;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void NetSession::SetBroadcastEvents( bool broadcastEvents )
+{
+	m_broadcastEvents = broadcastEvents;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Snapshots and packets per second, independent of the frame rate
+void NetSession::SetSendRate( double sendsPerSecond )
+{
+	LockNetThread( );
+	m_sendScheduler.SetRate( sendsPerSecond );
+	UnlockNetThread( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Most connections a host accepts, self included. Joins past it are denied as full, connections
+// already past it stay.
+void NetSession::SetConnectionLimit( uint16_t connectionLimit )
+{
+	if( connectionLimit > MAX_CONNECTIONS )
+	{
+		connectionLimit = (uint16_t) MAX_CONNECTIONS;
+	}
+	m_connectionLimit = connectionLimit;
 }
 
 
@@ -1,12 +1,28 @@
 #pragma once
 
-#include "Engine/DebugSystem/DebugLog.hpp"
+#include <atomic>
+#include <stdio.h>
+#include <deque>
+#include <vector>
+#include "Engine/Core/TickScheduler.hpp"
+#include "Engine/Math/Range.hpp"
+#include "Engine/Net/Session/ConnectionLookup.hpp"
 #include "Engine/Net/Session/PacketChannel.hpp"
 #include "Engine/Net/Session/NetMessage.hpp"
+#include "Engine/Net/Session/NetMessageArena.hpp"
+#include "Engine/Net/Session/PacketCompressor.hpp"
+#include "Engine/Net/Session/TrafficCapture.hpp"
+#include "Engine/Threads/CriticalSection.hpp"
+#include "Engine/Threads/SPSCQueue.hpp"
+#include "Engine/Threads/Thread.hpp"
 #include "Engine/Utils/NetworkUtils.hpp"
 
-#define NET_VERSION 2
+#define NET_VERSION 6
 /* Version Log
+	6:  Packet dictionary hash in the join request and accept, compressed packets
+	5:  Fragment message for payloads larger than one message
+	4:  16 bit connection indices in the packet header, message header and join accept
+	3:  64 bit previous acks bitfield in the packet header
 	2:  SEND_RATE = 1/60, MAX_PACKETS = 5, MTU = 1444
 	1:	First version
 */
@@ -27,6 +43,7 @@ void OnJoinRequest( NetSender const &, NetMessage const & );
 void OnJoinDeny( NetSender const &, NetMessage const & );
 void OnJoinAccept( NetSender const &, NetMessage const & );
 void OnLeave( NetSender const &, NetMessage const & );
+void OnFragment( NetSender const &, NetMessage const & );
 
 
 //-------------------------------------------------------------------------------------------------
@@ -66,6 +83,27 @@ public:
 	uint32_t nuonce;
 	char * username;
 	size_t password;
+	uint32_t dictionaryHash; //0 without a packet dictionary
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// A decoded message crossing between the network thread and the game thread. Copied whole, the
+// arena and connection queues belong to whichever thread holds the session lock.
+class HandoffMessage
+{
+public:
+	NetConnection * connection; //Incoming: nullptr if connectionless. Outgoing: nullptr for every client
+	uint16_t connectionIndex; //Checked against the table with the pointer, the connection may be gone
+	sockaddr_in fromAddress;
+	byte_t type;
+	uint16_t senderIndex;
+	uint16_t reliableID;
+	uint16_t sequenceID;
+	uint32_t deliveryTag;
+	uint32_t coalesceKey;
+	size_t payloadSize;
+	byte_t payload[NetPacket::MAX_SIZE];
 };
 
 
@@ -77,36 +115,68 @@ class NetSession
 //-------------------------------------------------------------------------------------------------
 private:
 	static int const PORT_RANGE = 12; //default
-	static int const MAX_CONNECTIONS = 255; //largest number possible of Byte - 1
+	static int const MAX_CONNECTIONS = 2048; //Slots in the table, see SetConnectionLimit() for how many a host accepts
 	static int const MAX_DEFINITIONS = 256; //largest number possible of Byte
-	static float const SEND_RATE; //seconds per packets
-	static uint8_t const HOST_INDEX = 0;
+	static uint16_t const HOST_INDEX = 0;
 
 public:
-	static byte_t const INVALID_INDEX = 255; //last connection index is the invalid index
-	static int const MAX_PACKET_SEND_AMOUNT_PER_CONNECTION; //max number of packets sent during ProcessOutgoingPackets();
+	static float const SEND_RATE; //default seconds per packets, see SetSendRate()
+	static uint16_t const INVALID_INDEX = 0xFFFF;
+	static byte_t const FRAGMENT_CHANNEL = 255; //Reserved sequence channel, large messages arrive in the order they were sent
+	static int const MAX_PACKET_SEND_AMOUNT_PER_CONNECTION; //hard cap per ProcessOutgoingPackets(), each connection's rate controller sets the real budget
 	static float const HEARTBEAT_INTERVAL_SECONDS;
 	static float const BAD_CONNECTION_INTERVAL_SECONDS;
 	static float const DISCONNECT_INTERVAL_SECONDS;
+	static size_t const HANDOFF_QUEUE_SIZE = 1024; //Messages each way between the network and game threads
+	static double const NET_THREAD_SLEEP_SECONDS; //Between network thread passes
+	static char const * PREPARE_SNAPSHOT_EVENT; //once per send tick, before any PREPARE_PACKET_EVENT
 	static char const * PREPARE_PACKET_EVENT;
+	static char const * FINISH_SNAPSHOT_EVENT; //once per send tick, after every packet is sent
 	static char const * ON_CONNECTION_JOIN_EVENT;
 	static char const * ON_CONNECTION_LEAVE_EVENT;
 	static char const * ON_GAME_JOIN_VALIDATION_EVENT;
 	static char const * ON_JOIN_DENY_EVENT;
-	static DebugLog m_NetworkTrafficActivity;
 
 //-------------------------------------------------------------------------------------------------
 // Members
 //-------------------------------------------------------------------------------------------------
 private:
 	PacketChannel m_channel;
+	mutable NetMessageArena m_messageArena; //Connections only hold a const session
+	mutable TrafficCapture m_trafficCapture; //Recorded from the const send path
+	PacketDictionary m_packetDictionary; //Empty means packets are never compressed
+	mutable PacketSamples m_packetSamples; //Sent packet bodies for training a dictionary
+	mutable PacketCompressionStats m_compressionStats;
 	NetConnection * m_connections[MAX_CONNECTIONS];
+	std::vector<NetConnection*> m_activeConnections; //Dense, per tick loops walk this instead of every slot
+	uint16_t m_activePositions[MAX_CONNECTIONS]; //Where each index sits in m_activeConnections
+	uint16_t m_connectionLimit;
+	ConnectionLookup m_connectionLookup; //Address and GUID to index, kept in sync by Connect/Disconnect
 	NetConnection * m_self;
 	NetConnection * m_host;
 	eNetSessionState m_state;
 	NetMessageDefinition * m_messageDefinitions[MAX_DEFINITIONS];
 	byte_t m_definitionCount;
 	bool m_connectionTimeouts;
+	bool m_broadcastEvents; //Off for sessions that share the process but not the game, like load test bots
+	TickScheduler m_sendScheduler; //On the real clock, at most one send per update
+	double m_lastUpdateSeconds;
+
+	//Periodic telemetry export, game thread only, see StartTelemetryExport()
+	FILE * m_telemetryFile;
+	double m_telemetryInterval;
+	double m_nextTelemetryTime;
+
+	//Optional network thread, see StartNetThread()
+	Thread * m_netThread;
+	std::atomic<bool> m_netThreadRunning;
+	std::atomic<bool> m_sendRequested; //Game thread queued a snapshot, send without waiting for the next tick
+	mutable CriticalSection m_netLock; //Held by the network thread for each pass, and by the game thread around session work
+	mutable int m_gameLockDepth; //Game thread only, lets LockNetThread() nest
+	SPSCQueue<HandoffMessage> * m_incomingHandoff; //Network thread to game thread, only exists while the thread runs
+	SPSCQueue<HandoffMessage> * m_outgoingHandoff; //Game thread to network thread, only exists while the thread runs
+	mutable std::deque<HandoffMessage> m_incomingOverflow; //Producer side spill while a queue is full
+	mutable std::deque<HandoffMessage> m_outgoingOverflow;
 
 	uint16_t m_netVersion;
 	uint32_t m_definitionHash;
@@ -128,23 +198,33 @@ public:
 	void ProcessIncomingPackets( );
 	void ProcessOutgoingPackets( );
 	void CheckForDisconnect( );
+	void BroadcastEvent( char const * eventName, NamedProperties & eventData ) const;
+	bool StartNetThread( );
+	void StopNetThread( );
+	void RunNetThread( );
+	void LockNetThread( ) const;
+	void UnlockNetThread( ) const;
+	void DeliverMessage( NetSender const & sender, NetMessage const & message ) const;
+	bool DeferMessage( NetConnection * connection, NetMessage const & message ) const;
 
-	void RegisterMessage( eNetMessageType const & type, MessageCallback * cb, byte_t const & setTypeFlags = 0, byte_t const & setOptionFlags = 0, byte_t const & setChannel = 0 );
+	void RegisterMessage( eNetMessageType const & type, MessageCallback * cb, byte_t const & setTypeFlags = 0, byte_t const & setOptionFlags = 0, byte_t const & setChannel = 0, eNetMessagePriority const & setPriority = eNetMessagePriority_NORMAL );
 	bool Start( unsigned int port, unsigned int range = PORT_RANGE );
 	void Stop( );
 	void Host( char const * username, size_t password = 0 );
 	void Join( sockaddr_in const & hostAddress, char const * username, size_t password = 0 );
 	void Leave( );
 	NetConnection * CreateConnection( ConnectionInfo const & connInfo ) const;
-	NetConnection * CreateConnection( byte_t index, sockaddr_in const & addr, std::string const & guid, std::string const & username ) const;
+	NetConnection * CreateConnection( uint16_t index, sockaddr_in const & addr, std::string const & guid, std::string const & username ) const;
 	void DisconnectOtherClientConnections( );
 	void Connect( NetConnection * connection );
 	void Disconnect( NetConnection ** connection );
 	void AddMessageToAllClients( NetMessage & message );
+	bool AddFragmentedMessageToAllClients( byte_t type, byte_t const * data, size_t dataSize );
 	void SendDirect( sockaddr_in const & address, NetMessage & message ) const;
 	void SendDeny( sockaddr_in const & address, eNetSessionError const & reason, uint32_t nuonce ) const;
 	void SendAccept( NetConnection * connInfo, uint32_t nuonce ) const;
-	void SendPacket( sockaddr_in const & address, byte_t const * data, size_t dataSize ) const;
+	size_t SendPacket( sockaddr_in const & address, byte_t const * data, size_t dataSize, bool compress = false ) const;
+	bool ExpandPacket( NetPacket & packet ) const;
 	void ProcessPacket( NetPacket & packet );
 	void ReadMessage( NetPacket const & packet, NetMessage * out_message );
 	void PrintError( eNetSessionError const & error );
@@ -155,27 +235,67 @@ public:
 	void UpdateState( eNetSessionState const & state );
 
 	NetConnection * GetNetConnection( sockaddr_in const & address ) const;
-	NetConnection * GetNetConnection( uint8_t netIndex );
+	NetConnection * GetNetConnection( uint16_t fromConnIndex, sockaddr_in const & address ) const;
+	NetConnection * GetNetConnection( uint16_t netIndex );
+	std::vector<NetConnection*> const & GetActiveConnections( ) const;
+	size_t GetConnectionCount( ) const;
+	uint16_t GetConnectionLimit( ) const;
 	PacketChannel const & GetPacketChannel( ) const;
+	NetMessageArena & GetMessageArena( ) const;
 	UDPSock const & GetSocket( ) const;
 	char const * GetAddressString( ) const;
 	NetMessageDefinition const * GetDefinition( eNetMessageType const & type ) const;
 	NetConnection * GetSelf( ) const;
 	NetConnection * GetHost( ) const;
 	eNetSessionState GetState( ) const;
+	double GetLastUpdateSeconds( ) const;
+	double GetSendInterval( ) const;
+	TickScheduler const & GetSendScheduler( ) const;
 	float GetSimDropRate( ) const;
 	Range<double> const GetLatency( ) const;
 	uint64_t GetNetSessionVersion( ) const;
 	uint32_t GetNuonce( ) const;
-	byte_t GetNextFreeIndex( ) const;
+	uint16_t GetNextFreeIndex( ) const;
 	bool IsConnected( ) const;
 	bool IsValidPacket( NetPacket const & packet, size_t packetSize ) const;
 	bool IsValidMessage( NetSender const & senderInfo, NetMessage const & message ) const;
-	bool IsValidConnectionIndex( byte_t index ) const;
+	bool IsValidConnectionIndex( uint16_t index ) const;
 	bool IsDuplicateGUID( std::string const & check ) const;
 	bool IsHost( ) const;
+	bool IsNetThreadRunning( ) const;
+	bool IsLiveConnection( NetConnection const * connection, uint16_t index ) const;
 
 	void SetDropRate( float dropRate );
 	void SetLatency( Range<double> latency );
+	void SetLinkProfile( LinkProfile const & profile, uint64_t seed );
+	void ResetSocketStats( );
+	void ResetSendStats( );
+	void StartTrafficCapture( size_t recordCount );
+	void StopTrafficCapture( );
+	bool DumpTrafficCapture( char const * path ) const;
+	void WriteTelemetry( std::string * out_json ) const;
+	bool StartTelemetryExport( char const * path, double intervalSeconds );
+	void StopTelemetryExport( );
+	bool IsExportingTelemetry( ) const;
+	bool SetPacketDictionary( PacketDictionary const & dictionary );
+	uint32_t GetPacketDictionaryHash( ) const;
+	PacketCompressionStats GetCompressionStats( ) const;
+	void ResetCompressionStats( );
+	void StartPacketSampling( size_t sampleCount );
+	void StopPacketSampling( );
+	bool SavePacketSamples( char const * path ) const;
+	size_t GetPacketSampleCount( ) const;
+	void SetBroadcastEvents( bool broadcastEvents );
+	void SetSendRate( double sendsPerSecond );
+	void SetConnectionLimit( uint16_t connectionLimit );
 	bool ToggleTimeouts( );
+
+private:
+	void DispatchIncomingMessages( );
+	void UpdateTelemetryExport( );
+	void DrainOutgoingMessages( ) const;
+	void QueueHandoff( HandoffMessage & handoff ) const;
+	void PushHandoff( SPSCQueue<HandoffMessage> & queue, std::deque<HandoffMessage> & overflow, NetConnection * connection, sockaddr_in const & address, NetMessage const & message ) const;
+	void FlushOverflow( SPSCQueue<HandoffMessage> & queue, std::deque<HandoffMessage> & overflow ) const;
+	void ReadHandoff( HandoffMessage const & handoff, NetMessage * out_message ) const;
 };
\ No newline at end of file
@@ -1,8 +1,6 @@
 #include "Engine/Net/Session/PacketChannel.hpp"
 
 #include "Engine/Core/Time.hpp"
-#include "Engine/Utils/MathUtils.hpp"
-#include "Engine/Net/Session/NetPacket.hpp"
 #include "Engine/Net/Session/NetSession.hpp"
 #include "Engine/Net/Session/NetConnection.hpp"
 
@@ -10,91 +8,209 @@
 //-------------------------------------------------------------------------------------------------
 PacketChannel::PacketChannel( )
 	: UDPSock( )
-	, m_dropRate( 0.f )
-	, m_latency( Range<double>::ZERO )
+	, m_outgoingLink( DEFAULT_LINK_SEED )
+	, m_incomingLink( DEFAULT_LINK_SEED + 1 )
+	, m_outgoingCount( 0 )
 {
-	//Nothing
+	for( size_t packetIndex = 0; packetIndex < MAX_QUEUED_PACKETS; ++packetIndex )
+	{
+		m_incomingDatagrams[packetIndex].data = m_incomingPackets[packetIndex].GetBuffer( );
+		m_incomingDatagrams[packetIndex].dataMax = NetPacket::MAX_SIZE;
+		m_incomingDatagrams[packetIndex].dataSize = 0;
+
+		m_outgoingDatagrams[packetIndex].data = m_outgoingData[packetIndex];
+		m_outgoingDatagrams[packetIndex].dataMax = NetPacket::MAX_SIZE;
+		m_outgoingDatagrams[packetIndex].dataSize = 0;
+	}
+	ResetStats( );
 }
 
 
 //-------------------------------------------------------------------------------------------------
 PacketChannel::~PacketChannel( )
 {
-	for( auto packetIter : m_orderedPackets )
+	//Nothing
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Queues the packet, it goes out on the next FlushPackets() once it's across the outgoing link
+void PacketChannel::SendPackets( sockaddr_in addr, byte_t const * data, size_t dataSize ) const
+{
+	if( m_outgoingLink.IsActive( ) )
 	{
-		delete packetIter.second;
-		packetIter.second = nullptr;
+		m_outgoingLink.Submit( Time::GetCurrentTimeSeconds( ), addr, data, dataSize );
+		return;
 	}
-	m_orderedPackets.clear( );
+
+	QueueDatagram( addr, data, dataSize );
 }
 
 
 //-------------------------------------------------------------------------------------------------
-void PacketChannel::SendPackets( sockaddr_in addr, byte_t const * data, size_t dataSize ) const
+void PacketChannel::FlushPackets( ) const
 {
-	Send( addr, data, dataSize );
+	if( m_outgoingLink.IsActive( ) )
+	{
+		double currentTime = Time::GetCurrentTimeSeconds( );
+		while( EmulatedPacket * packet = m_outgoingLink.PopReady( currentTime ) )
+		{
+			QueueDatagram( packet->address, packet->data, packet->dataSize );
+			m_outgoingLink.Recycle( packet );
+		}
+	}
+
+	SendQueuedDatagrams( );
 }
 
+
 //-------------------------------------------------------------------------------------------------
 void PacketChannel::RecvPackets( NetSession * currentSession )
 {
 	double currentTime = Time::GetCurrentTimeSeconds( );
+	size_t syscallsBefore = GetSyscallCount( );
 
-	NetPacket packet;
-	sockaddr_in address;
-	size_t read = Recv( &address, packet.GetBuffer( ), NetPacket::MAX_SIZE );
-	packet.SetBufferSize( read );
-
-	packet.m_senderInfo.session = currentSession;
-	
-	//Recieve Packets
-	while( read > 0 )
+	//Recieve Packets, a full batch means there may be more waiting
+	size_t read = MAX_QUEUED_PACKETS;
+	while( read == MAX_QUEUED_PACKETS )
 	{
-		//Packet is Invalid
-		if( !currentSession->IsValidPacket( packet, read ) )
-		{
-			read = Recv( &address, packet.GetBuffer( ), NetPacket::MAX_SIZE );
-			++currentSession->m_invalidPacketCount;
-			continue;
-		}
+		read = RecvBatch( m_incomingDatagrams, MAX_QUEUED_PACKETS );
+		m_stats.packetsReceived += read;
 
-		//Skip packet if within drop rate
-		if( RandomFloatZeroToOne( ) >= m_dropRate )
+		for( size_t packetIndex = 0; packetIndex < read; ++packetIndex )
 		{
-			packet.m_senderInfo.fromAddress = address;
-			if( m_latency == Range<double>::ZERO )
-			{
-				currentSession->ProcessPacket( packet );
-			}
-			else
+			NetPacket & packet = m_incomingPackets[packetIndex];
+			UDPDatagram const & datagram = m_incomingDatagrams[packetIndex];
+			m_stats.bytesReceived += datagram.dataSize;
+			packet.Rewind( );
+			packet.SetBufferSize( datagram.dataSize );
+			packet.m_senderInfo.session = currentSession;
+
+			//Packet is Invalid, compressed ones are checked once expanded
+			if( !currentSession->ExpandPacket( packet ) || !currentSession->IsValidPacket( packet, packet.GetSize( ) ) )
 			{
-				double readTime = currentTime + m_latency.GetRandom( );
-				m_orderedPackets.insert( std::pair<double, NetPacket*>( readTime, packet.Copy() ) );
+				++currentSession->m_invalidPacketCount;
+				continue;
 			}
-		}
 
-		//Continue to the next packet
-		read = Recv( &address, packet.GetBuffer( ), NetPacket::MAX_SIZE );
-		packet.Rewind( );
-		packet.SetBufferSize( read );
-	}
-	
-	//Process Packets
-	if( m_orderedPackets.size( ) > 0 )
-	{
-		for( auto packetIter = m_orderedPackets.begin( ); packetIter != m_orderedPackets.end( ); /*Nothing*/ )
-		{
-			if( packetIter->first <= currentTime )
+			if( m_incomingLink.IsActive( ) )
 			{
-				currentSession->ProcessPacket( *(packetIter->second) );
-				delete packetIter->second;
-				packetIter->second = nullptr;
-				packetIter = m_orderedPackets.erase( packetIter );
+				m_incomingLink.Submit( currentTime, datagram.address, packet.GetBuffer( ), packet.GetSize( ) );
 			}
 			else
 			{
-				break;
+				packet.m_senderInfo.fromAddress = datagram.address;
+				currentSession->ProcessPacket( packet );
 			}
 		}
 	}
-}
\ No newline at end of file
+	m_stats.syscallCount += GetSyscallCount( ) - syscallsBefore;
+	
+	//Process packets that made it across the incoming link, the batch buffers are free again
+	NetPacket & heldPacket = m_incomingPackets[0];
+	while( EmulatedPacket * emulated = m_incomingLink.PopReady( currentTime ) )
+	{
+		memcpy( heldPacket.GetBuffer( ), emulated->data, emulated->dataSize );
+		heldPacket.Rewind( );
+		heldPacket.SetBufferSize( emulated->dataSize );
+		heldPacket.m_senderInfo.session = currentSession;
+		heldPacket.m_senderInfo.fromAddress = emulated->address;
+		m_incomingLink.Recycle( emulated );
+
+		currentSession->ProcessPacket( heldPacket );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void PacketChannel::MarkTick( )
+{
+	++m_stats.ticks;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+PacketChannelStats PacketChannel::GetStats( ) const
+{
+	return m_stats;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+LinkEmulator const & PacketChannel::GetOutgoingLink( ) const
+{
+	return m_outgoingLink;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+LinkEmulator const & PacketChannel::GetIncomingLink( ) const
+{
+	return m_incomingLink;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+LinkEmulator & PacketChannel::GetOutgoingLink( )
+{
+	return m_outgoingLink;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+LinkEmulator & PacketChannel::GetIncomingLink( )
+{
+	return m_incomingLink;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void PacketChannel::ResetStats( )
+{
+	m_stats.syscallCount = 0;
+	m_stats.packetsSent = 0;
+	m_stats.packetsReceived = 0;
+	m_stats.bytesSent = 0;
+	m_stats.bytesReceived = 0;
+	m_stats.ticks = 0;
+	m_stats.startTime = Time::GetCurrentTimeSeconds( );
+	m_outgoingLink.ResetStats( );
+	m_incomingLink.ResetStats( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void PacketChannel::QueueDatagram( sockaddr_in const & addr, byte_t const * data, size_t dataSize ) const
+{
+	//Queue is full, make room
+	if( m_outgoingCount == MAX_QUEUED_PACKETS )
+	{
+		SendQueuedDatagrams( );
+	}
+
+	UDPDatagram & datagram = m_outgoingDatagrams[m_outgoingCount];
+	datagram.address = addr;
+	memcpy( datagram.data, data, dataSize );
+	datagram.dataSize = dataSize;
+	++m_outgoingCount;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void PacketChannel::SendQueuedDatagrams( ) const
+{
+	if( m_outgoingCount == 0 )
+	{
+		return;
+	}
+
+	size_t syscallsBefore = GetSyscallCount( );
+	size_t sent = SendBatch( m_outgoingDatagrams, m_outgoingCount );
+	m_stats.syscallCount += GetSyscallCount( ) - syscallsBefore;
+	m_stats.packetsSent += sent;
+	for( size_t packetIndex = 0; packetIndex < sent; ++packetIndex )
+	{
+		m_stats.bytesSent += m_outgoingDatagrams[packetIndex].dataSize;
+	}
+	m_outgoingCount = 0;
+}
@@ -1,28 +1,57 @@
 #pragma once
 
-#include <map>
 #include "Engine/Net/UDPIP/UDPSock.hpp"
-#include "Engine/Math/Range.hpp"
+#include "Engine/Net/Session/NetPacket.hpp"
+#include "Engine/Net/Session/LinkEmulator.hpp"
 
 
 //-------------------------------------------------------------------------------------------------
 class NetSession;
-class NetPacket;
 class PacketHeader;
 
 
+//-------------------------------------------------------------------------------------------------
+// Socket traffic counted since the last ResetStats()
+class PacketChannelStats
+{
+public:
+	size_t syscallCount;
+	size_t packetsSent;
+	size_t packetsReceived;
+	size_t bytesSent;
+	size_t bytesReceived;
+	size_t ticks;
+	double startTime;
+};
+
+
 //-------------------------------------------------------------------------------------------------
 class PacketChannel : public UDPSock
 {
 //-------------------------------------------------------------------------------------------------
-// Members
+// Static Members
 //-------------------------------------------------------------------------------------------------
 public:
-	float m_dropRate;
-	Range<double> m_latency;
+	static size_t const MAX_QUEUED_PACKETS = UDPSock::MAX_BATCH_SIZE;
+	static uint64_t const DEFAULT_LINK_SEED = 1;
 
+//-------------------------------------------------------------------------------------------------
+// Members
+//-------------------------------------------------------------------------------------------------
 private:
-	std::map<double, NetPacket*> m_orderedPackets;
+	//Simulated network in each direction, passthrough unless a profile is set
+	mutable LinkEmulator m_outgoingLink;
+	LinkEmulator m_incomingLink;
+
+	//Incoming packets are read straight into these
+	NetPacket m_incomingPackets[MAX_QUEUED_PACKETS];
+	UDPDatagram m_incomingDatagrams[MAX_QUEUED_PACKETS];
+
+	//Outgoing packets wait here until FlushPackets() (mutable so const sends can queue)
+	mutable byte_t m_outgoingData[MAX_QUEUED_PACKETS][NetPacket::MAX_SIZE];
+	mutable UDPDatagram m_outgoingDatagrams[MAX_QUEUED_PACKETS];
+	mutable size_t m_outgoingCount;
+	mutable PacketChannelStats m_stats;
 
 //-------------------------------------------------------------------------------------------------
 // Functions
@@ -32,5 +61,18 @@ public:
 	~PacketChannel( );
 
 	void SendPackets( sockaddr_in addr, byte_t const * data, size_t dataSize ) const;
+	void FlushPackets( ) const;
 	void RecvPackets( NetSession * currentSession );
-};
\ No newline at end of file
+	void MarkTick( );
+
+	PacketChannelStats GetStats( ) const;
+	LinkEmulator const & GetOutgoingLink( ) const;
+	LinkEmulator const & GetIncomingLink( ) const;
+	LinkEmulator & GetOutgoingLink( );
+	LinkEmulator & GetIncomingLink( );
+	void ResetStats( );
+
+private:
+	void QueueDatagram( sockaddr_in const & addr, byte_t const * data, size_t dataSize ) const;
+	void SendQueuedDatagrams( ) const;
+};
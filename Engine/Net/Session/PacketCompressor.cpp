@@ -0,0 +1,669 @@
+#include "Engine/Net/Session/PacketCompressor.hpp"
+
+#include <cstring>
+#include <stdio.h>
+
+
+//-------------------------------------------------------------------------------------------------
+// Sample and segment a training candidate comes from
+class TrainCandidate
+{
+public:
+	uint32_t sampleIndex;
+	uint16_t start;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+static size_t GetNGramSlot( byte_t const * data )
+{
+	uint64_t ngram;
+	memcpy( &ngram, data, sizeof( ngram ) );
+	return (size_t) ( ( ngram * 0x9E3779B97F4A7C15ULL ) >> ( 64 - PacketDictionary::TRAIN_FREQUENCY_BITS ) );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+PacketSamples::PacketSamples( )
+	: m_data( )
+	, m_offsets( )
+	, m_sampleLimit( 0 )
+{
+	//Nothing
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Drops anything recorded before
+void PacketSamples::Start( size_t sampleLimit )
+{
+	m_data.clear( );
+	m_offsets.clear( );
+	m_sampleLimit = sampleLimit;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Keeps what was recorded
+void PacketSamples::Stop( )
+{
+	m_sampleLimit = 0;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void PacketSamples::Add( byte_t const * data, size_t dataSize )
+{
+	if( m_offsets.size( ) >= m_sampleLimit || dataSize == 0 || dataSize > 0xFFFF )
+	{
+		return;
+	}
+
+	m_offsets.push_back( m_data.size( ) );
+	m_data.insert( m_data.end( ), data, data + dataSize );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool PacketSamples::Save( char const * path ) const
+{
+	FILE * file = nullptr;
+	errno_t errorSuccess = fopen_s( &file, path, "wb" );
+	if( errorSuccess != 0 || file == nullptr )
+	{
+		return false;
+	}
+
+	uint32_t magic = MAGIC;
+	uint32_t sampleCount = (uint32_t) GetCount( );
+	fwrite( &magic, sizeof( magic ), 1, file );
+	fwrite( &sampleCount, sizeof( sampleCount ), 1, file );
+	for( size_t sampleIndex = 0; sampleIndex < GetCount( ); ++sampleIndex )
+	{
+		size_t sampleSize;
+		byte_t const * sample = GetSample( sampleIndex, &sampleSize );
+		uint16_t writtenSize = (uint16_t) sampleSize;
+		fwrite( &writtenSize, sizeof( writtenSize ), 1, file );
+		fwrite( sample, 1, sampleSize, file );
+	}
+
+	fclose( file );
+	return true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Replaces the current samples, not recording afterwards
+bool PacketSamples::Load( char const * path )
+{
+	FILE * file = nullptr;
+	errno_t errorSuccess = fopen_s( &file, path, "rb" );
+	if( errorSuccess != 0 || file == nullptr )
+	{
+		return false;
+	}
+
+	Start( 0 );
+	uint32_t magic = 0;
+	uint32_t sampleCount = 0;
+	bool valid = fread( &magic, sizeof( magic ), 1, file ) == 1
+		&& fread( &sampleCount, sizeof( sampleCount ), 1, file ) == 1
+		&& magic == MAGIC;
+
+	for( uint32_t sampleIndex = 0; valid && sampleIndex < sampleCount; ++sampleIndex )
+	{
+		uint16_t sampleSize = 0;
+		if( fread( &sampleSize, sizeof( sampleSize ), 1, file ) != 1 || sampleSize == 0 )
+		{
+			valid = false;
+			break;
+		}
+
+		size_t offset = m_data.size( );
+		m_data.resize( offset + sampleSize );
+		if( fread( &m_data[offset], 1, sampleSize, file ) != sampleSize )
+		{
+			valid = false;
+			break;
+		}
+		m_offsets.push_back( offset );
+	}
+
+	fclose( file );
+	if( !valid )
+	{
+		Start( 0 );
+	}
+	return valid;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool PacketSamples::IsRecording( ) const
+{
+	return m_offsets.size( ) < m_sampleLimit;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t PacketSamples::GetCount( ) const
+{
+	return m_offsets.size( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t PacketSamples::GetTotalSize( ) const
+{
+	return m_data.size( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+byte_t const * PacketSamples::GetSample( size_t sampleIndex, size_t * out_sampleSize ) const
+{
+	size_t end = sampleIndex + 1 < m_offsets.size( ) ? m_offsets[sampleIndex + 1] : m_data.size( );
+	*out_sampleSize = end - m_offsets[sampleIndex];
+	return &m_data[m_offsets[sampleIndex]];
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Segment selection in the style of zstd's cover trainer. Every 8 byte n-gram is counted once per
+// sample it shows up in, so bytes repeated across packets score and bytes unique to one don't. The
+// candidates are split into one epoch per segment of dictionary, each epoch adds its best segment
+// and zeroes the counts it covered so the next picks cover something else.
+STATIC bool PacketDictionary::Train( PacketSamples const & samples, size_t dictionarySize, PacketDictionary * out_dictionary )
+{
+	if( dictionarySize > MAX_SIZE )
+	{
+		dictionarySize = MAX_SIZE;
+	}
+	if( samples.GetCount( ) == 0 || dictionarySize < TRAIN_SEGMENT_SIZE )
+	{
+		return false;
+	}
+
+	//N-gram document frequency, collisions just merge counts
+	std::vector<uint32_t> frequencies( (size_t) 1 << TRAIN_FREQUENCY_BITS, 0 );
+	std::vector<uint32_t> lastSample( (size_t) 1 << TRAIN_FREQUENCY_BITS, 0 );
+	std::vector<TrainCandidate> candidates;
+	for( size_t sampleIndex = 0; sampleIndex < samples.GetCount( ); ++sampleIndex )
+	{
+		size_t sampleSize;
+		byte_t const * sample = samples.GetSample( sampleIndex, &sampleSize );
+		for( size_t position = 0; position + TRAIN_NGRAM_SIZE <= sampleSize; ++position )
+		{
+			size_t slot = GetNGramSlot( sample + position );
+			if( lastSample[slot] != sampleIndex + 1 )
+			{
+				lastSample[slot] = (uint32_t) ( sampleIndex + 1 );
+				++frequencies[slot];
+			}
+		}
+
+		for( size_t start = 0; start + TRAIN_SEGMENT_SIZE <= sampleSize; start += TRAIN_SEGMENT_STRIDE )
+		{
+			TrainCandidate candidate;
+			candidate.sampleIndex = (uint32_t) sampleIndex;
+			candidate.start = (uint16_t) start;
+			candidates.push_back( candidate );
+		}
+	}
+
+	if( candidates.empty( ) )
+	{
+		return false;
+	}
+
+	size_t const ngramsPerSegment = TRAIN_SEGMENT_SIZE - TRAIN_NGRAM_SIZE + 1;
+	size_t epochCount = dictionarySize / TRAIN_SEGMENT_SIZE;
+	size_t epochSize = ( candidates.size( ) + epochCount - 1 ) / epochCount;
+	std::vector<byte_t> dictionary;
+	dictionary.reserve( dictionarySize );
+	for( size_t epochStart = 0; epochStart < candidates.size( ) && dictionary.size( ) + TRAIN_SEGMENT_SIZE <= dictionarySize; epochStart += epochSize )
+	{
+		size_t epochEnd = epochStart + epochSize < candidates.size( ) ? epochStart + epochSize : candidates.size( );
+		uint64_t bestScore = 0;
+		byte_t const * bestSegment = nullptr;
+		for( size_t candidateIndex = epochStart; candidateIndex < epochEnd; ++candidateIndex )
+		{
+			size_t sampleSize;
+			byte_t const * segment = samples.GetSample( candidates[candidateIndex].sampleIndex, &sampleSize ) + candidates[candidateIndex].start;
+			uint64_t score = 0;
+			for( size_t position = 0; position < ngramsPerSegment; ++position )
+			{
+				score += frequencies[GetNGramSlot( segment + position )];
+			}
+			if( score > bestScore )
+			{
+				bestScore = score;
+				bestSegment = segment;
+			}
+		}
+
+		//Nothing in this epoch repeats across packets on average, it would only take up room
+		if( bestSegment == nullptr || bestScore <= ngramsPerSegment )
+		{
+			continue;
+		}
+
+		dictionary.insert( dictionary.end( ), bestSegment, bestSegment + TRAIN_SEGMENT_SIZE );
+		for( size_t position = 0; position < ngramsPerSegment; ++position )
+		{
+			frequencies[GetNGramSlot( bestSegment + position )] = 0;
+		}
+	}
+
+	if( dictionary.empty( ) )
+	{
+		return false;
+	}
+
+	out_dictionary->Set( &dictionary[0], dictionary.size( ) );
+	return true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+PacketDictionary::PacketDictionary( )
+	: m_data( )
+	, m_hash( 0U )
+{
+	Clear( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void PacketDictionary::Set( byte_t const * data, size_t dataSize )
+{
+	Clear( );
+	if( dataSize == 0 )
+	{
+		return;
+	}
+	if( dataSize > MAX_SIZE )
+	{
+		dataSize = MAX_SIZE;
+	}
+	m_data.assign( data, data + dataSize );
+
+	//Later positions overwrite earlier ones, any of them is as good for a match
+	for( size_t position = 0; position + PacketCompressor::MIN_MATCH <= m_data.size( ); ++position )
+	{
+		m_table[PacketCompressor::HashSequence( &m_data[position], HASH_BITS )] = (uint16_t) position;
+	}
+
+	//FNV-1a, never 0 so a dictionary can't be mistaken for none
+	uint32_t hash = 2166136261U;
+	for( size_t index = 0; index < m_data.size( ); ++index )
+	{
+		hash ^= m_data[index];
+		hash *= 16777619U;
+	}
+	m_hash = hash != 0U ? hash : 1U;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void PacketDictionary::Clear( )
+{
+	m_data.clear( );
+	m_hash = 0U;
+	for( size_t slot = 0; slot < ( (size_t) 1 << HASH_BITS ); ++slot )
+	{
+		m_table[slot] = EMPTY_SLOT;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Raw bytes, nothing else in the file
+bool PacketDictionary::Save( char const * path ) const
+{
+	FILE * file = nullptr;
+	errno_t errorSuccess = fopen_s( &file, path, "wb" );
+	if( errorSuccess != 0 || file == nullptr )
+	{
+		return false;
+	}
+
+	bool written = m_data.empty( ) || fwrite( &m_data[0], 1, m_data.size( ), file ) == m_data.size( );
+	fclose( file );
+	return written;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool PacketDictionary::Load( char const * path )
+{
+	FILE * file = nullptr;
+	errno_t errorSuccess = fopen_s( &file, path, "rb" );
+	if( errorSuccess != 0 || file == nullptr )
+	{
+		return false;
+	}
+
+	std::vector<byte_t> data( MAX_SIZE + 1 );
+	size_t readSize = fread( &data[0], 1, data.size( ), file );
+	fclose( file );
+
+	//Too large means it wasn't made for this, don't silently cut it
+	if( readSize == 0 || readSize > MAX_SIZE )
+	{
+		return false;
+	}
+
+	Set( &data[0], readSize );
+	return true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+byte_t const * PacketDictionary::GetData( ) const
+{
+	return m_data.empty( ) ? nullptr : &m_data[0];
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t PacketDictionary::GetSize( ) const
+{
+	return m_data.size( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+uint32_t PacketDictionary::GetHash( ) const
+{
+	return m_hash;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Dictionary position with this sequence hash, EMPTY_SLOT if none. The bytes still need comparing.
+uint16_t PacketDictionary::GetPosition( uint32_t sequenceHash ) const
+{
+	return m_table[sequenceHash];
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool PacketDictionary::IsEmpty( ) const
+{
+	return m_data.empty( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Bytes written, 0 if it didn't fit in the capacity. Pass a capacity below the source size to
+// only get output that saves something.
+STATIC size_t PacketCompressor::Compress( PacketDictionary const * dictionary, byte_t const * source, size_t sourceSize, byte_t * out_data, size_t dataCapacity )
+{
+	if( sourceSize == 0 || sourceSize > MAX_SOURCE_SIZE || dataCapacity == 0 )
+	{
+		return 0;
+	}
+
+	byte_t const * dictionaryData = nullptr;
+	size_t dictionarySize = 0;
+	if( dictionary != nullptr && !dictionary->IsEmpty( ) )
+	{
+		dictionaryData = dictionary->GetData( );
+		dictionarySize = dictionary->GetSize( );
+	}
+
+	uint16_t table[1 << HASH_BITS];
+	memset( table, 0xFF, sizeof( table ) );
+
+	byte_t * out = out_data;
+	byte_t const * outEnd = out_data + dataCapacity;
+	size_t anchor = 0;
+	size_t position = 0;
+	while( position + MIN_MATCH <= sourceSize )
+	{
+		size_t bestLength = 0;
+		size_t bestOffset = 0;
+
+		//Earlier in this packet
+		uint32_t packetHash = HashSequence( source + position, HASH_BITS );
+		uint16_t packetCandidate = table[packetHash];
+		table[packetHash] = (uint16_t) position;
+		if( packetCandidate != PacketDictionary::EMPTY_SLOT )
+		{
+			bestLength = GetMatchLength( source + packetCandidate, source + position, sourceSize - position );
+			bestOffset = position - packetCandidate;
+		}
+
+		//Dictionary, only if it beats the nearer match
+		if( dictionaryData != nullptr )
+		{
+			uint16_t dictionaryCandidate = dictionary->GetPosition( HashSequence( source + position, PacketDictionary::HASH_BITS ) );
+			if( dictionaryCandidate != PacketDictionary::EMPTY_SLOT )
+			{
+				size_t maxLength = dictionarySize - dictionaryCandidate;
+				if( maxLength > sourceSize - position )
+				{
+					maxLength = sourceSize - position;
+				}
+				size_t length = GetMatchLength( dictionaryData + dictionaryCandidate, source + position, maxLength );
+				size_t offset = dictionarySize - dictionaryCandidate + position;
+				if( length > bestLength && offset <= 0xFFFF )
+				{
+					bestLength = length;
+					bestOffset = offset;
+				}
+			}
+		}
+
+		if( bestLength < MIN_MATCH )
+		{
+			++position;
+			continue;
+		}
+
+		if( !WriteSequence( source + anchor, position - anchor, bestLength, bestOffset, &out, outEnd ) )
+		{
+			return 0;
+		}
+
+		//Index inside the match too, the next repeat of these bytes can refer back here
+		for( size_t matched = position + 1; matched < position + bestLength && matched + MIN_MATCH <= sourceSize; ++matched )
+		{
+			table[HashSequence( source + matched, HASH_BITS )] = (uint16_t) matched;
+		}
+		position += bestLength;
+		anchor = position;
+	}
+
+	//Remaining literals, no match after them ends the block
+	size_t literalLength = sourceSize - anchor;
+	if( out >= outEnd )
+	{
+		return 0;
+	}
+	byte_t * token = out++;
+	*token = (byte_t) ( ( literalLength < 15 ? literalLength : 15 ) << 4 );
+	if( literalLength >= 15 && !WriteLength( literalLength - 15, &out, outEnd ) )
+	{
+		return 0;
+	}
+	if( (size_t) ( outEnd - out ) < literalLength )
+	{
+		return 0;
+	}
+	memcpy( out, source + anchor, literalLength );
+	out += literalLength;
+
+	return (size_t) ( out - out_data );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Bytes written, 0 if the block is malformed, refers outside the dictionary or doesn't fit.
+// Matches are copied a byte at a time so they can overlap what they're writing.
+STATIC size_t PacketCompressor::Decompress( PacketDictionary const * dictionary, byte_t const * source, size_t sourceSize, byte_t * out_data, size_t dataCapacity )
+{
+	byte_t const * dictionaryData = nullptr;
+	size_t dictionarySize = 0;
+	if( dictionary != nullptr && !dictionary->IsEmpty( ) )
+	{
+		dictionaryData = dictionary->GetData( );
+		dictionarySize = dictionary->GetSize( );
+	}
+
+	byte_t const * in = source;
+	byte_t const * inEnd = source + sourceSize;
+	byte_t * out = out_data;
+	byte_t * outEnd = out_data + dataCapacity;
+	while( in < inEnd )
+	{
+		byte_t token = *in++;
+
+		size_t literalLength = token >> 4;
+		if( literalLength == 15 && !ReadLength( &in, inEnd, &literalLength ) )
+		{
+			return 0;
+		}
+		if( literalLength > (size_t) ( inEnd - in ) || literalLength > (size_t) ( outEnd - out ) )
+		{
+			return 0;
+		}
+		memcpy( out, in, literalLength );
+		in += literalLength;
+		out += literalLength;
+
+		//Last sequence has no match
+		if( in == inEnd )
+		{
+			return (size_t) ( out - out_data );
+		}
+
+		if( inEnd - in < 2 )
+		{
+			return 0;
+		}
+		size_t offset = (size_t) in[0] | ( (size_t) in[1] << 8 );
+		in += 2;
+
+		size_t matchLength = token & 0x0F;
+		if( matchLength == 15 && !ReadLength( &in, inEnd, &matchLength ) )
+		{
+			return 0;
+		}
+		matchLength += MIN_MATCH;
+
+		size_t written = (size_t) ( out - out_data );
+		if( offset == 0 || offset > written + dictionarySize || matchLength > (size_t) ( outEnd - out ) )
+		{
+			return 0;
+		}
+
+		//Starts in the dictionary when it reaches back past the output
+		for( size_t index = 0; index < matchLength; ++index )
+		{
+			size_t from = written + index;
+			*out++ = from >= offset ? out_data[from - offset] : dictionaryData[dictionarySize + from - offset];
+		}
+	}
+	return 0;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Fibonacci hashing of the next 4 bytes
+STATIC uint32_t PacketCompressor::HashSequence( byte_t const * data, size_t hashBits )
+{
+	uint32_t sequence;
+	memcpy( &sequence, data, sizeof( sequence ) );
+	return ( sequence * 2654435769U ) >> ( 32 - hashBits );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC size_t PacketCompressor::GetMatchLength( byte_t const * first, byte_t const * second, size_t maxLength )
+{
+	size_t length = 0;
+	while( length < maxLength && first[length] == second[length] )
+	{
+		++length;
+	}
+	return length;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC bool PacketCompressor::WriteSequence( byte_t const * literals, size_t literalLength, size_t matchLength, size_t offset, byte_t ** io_out, byte_t const * outEnd )
+{
+	byte_t * out = *io_out;
+	size_t extraMatchLength = matchLength - MIN_MATCH;
+	if( out >= outEnd )
+	{
+		return false;
+	}
+	*out++ = (byte_t) ( ( ( literalLength < 15 ? literalLength : 15 ) << 4 ) | ( extraMatchLength < 15 ? extraMatchLength : 15 ) );
+
+	if( literalLength >= 15 && !WriteLength( literalLength - 15, &out, outEnd ) )
+	{
+		return false;
+	}
+	if( (size_t) ( outEnd - out ) < literalLength + 2 )
+	{
+		return false;
+	}
+	memcpy( out, literals, literalLength );
+	out += literalLength;
+	*out++ = (byte_t) ( offset & 0xFF );
+	*out++ = (byte_t) ( offset >> 8 );
+
+	if( extraMatchLength >= 15 && !WriteLength( extraMatchLength - 15, &out, outEnd ) )
+	{
+		return false;
+	}
+
+	*io_out = out;
+	return true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// What's left past a full nibble, 255 per byte until a smaller one ends it
+STATIC bool PacketCompressor::WriteLength( size_t length, byte_t ** io_out, byte_t const * outEnd )
+{
+	byte_t * out = *io_out;
+	while( length >= 255 )
+	{
+		if( out >= outEnd )
+		{
+			return false;
+		}
+		*out++ = 255;
+		length -= 255;
+	}
+	if( out >= outEnd )
+	{
+		return false;
+	}
+	*out++ = (byte_t) length;
+	*io_out = out;
+	return true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC bool PacketCompressor::ReadLength( byte_t const ** io_in, byte_t const * inEnd, size_t * io_length )
+{
+	byte_t const * in = *io_in;
+	byte_t lengthByte = 255;
+	while( lengthByte == 255 )
+	{
+		if( in >= inEnd )
+		{
+			return false;
+		}
+		lengthByte = *in++;
+		*io_length += lengthByte;
+	}
+	*io_in = in;
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <vector>
+#include "Engine/Core/EngineCommon.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+// Recorded packet bodies, everything after the packet header, to train a dictionary from and to
+// benchmark against. File format: magic, sample count, then each sample's 16 bit size and bytes.
+class PacketSamples
+{
+//-------------------------------------------------------------------------------------------------
+// Static Members
+//-------------------------------------------------------------------------------------------------
+public:
+	static uint32_t const MAGIC = 0x5350434E; //"NCPS"
+
+//-------------------------------------------------------------------------------------------------
+// Members
+//-------------------------------------------------------------------------------------------------
+private:
+	std::vector<byte_t> m_data;
+	std::vector<size_t> m_offsets; //Start of each sample in m_data
+	size_t m_sampleLimit; //Add() is ignored past this, 0 while not recording
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+public:
+	PacketSamples( );
+
+	void Start( size_t sampleLimit );
+	void Stop( );
+	void Add( byte_t const * data, size_t dataSize );
+	bool Save( char const * path ) const;
+	bool Load( char const * path );
+
+	bool IsRecording( ) const;
+	size_t GetCount( ) const;
+	size_t GetTotalSize( ) const;
+	byte_t const * GetSample( size_t sampleIndex, size_t * out_sampleSize ) const;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Bytes both ends preload as match history, so even the first message of a packet can refer back
+// to typical traffic. Identified by a hash exchanged at join, 0 means no dictionary.
+class PacketDictionary
+{
+//-------------------------------------------------------------------------------------------------
+// Static Members
+//-------------------------------------------------------------------------------------------------
+public:
+	static size_t const MAX_SIZE = 32768; //Offsets are 16 bit, the dictionary and a whole packet stay in range
+	static size_t const DEFAULT_SIZE = 8192;
+	static size_t const HASH_BITS = 12;
+	static uint16_t const EMPTY_SLOT = 0xFFFF;
+	static size_t const TRAIN_NGRAM_SIZE = 8;
+	static size_t const TRAIN_SEGMENT_SIZE = 32; //Dictionary is built from segments this long
+	static size_t const TRAIN_SEGMENT_STRIDE = 4;
+	static size_t const TRAIN_FREQUENCY_BITS = 18;
+
+//-------------------------------------------------------------------------------------------------
+// Members
+//-------------------------------------------------------------------------------------------------
+private:
+	std::vector<byte_t> m_data;
+	uint16_t m_table[1 << HASH_BITS]; //Last dictionary position of each 4 byte hash
+	uint32_t m_hash;
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+public:
+	static bool Train( PacketSamples const & samples, size_t dictionarySize, PacketDictionary * out_dictionary );
+
+	PacketDictionary( );
+
+	void Set( byte_t const * data, size_t dataSize );
+	void Clear( );
+	bool Save( char const * path ) const;
+	bool Load( char const * path );
+
+	byte_t const * GetData( ) const;
+	size_t GetSize( ) const;
+	uint32_t GetHash( ) const;
+	uint16_t GetPosition( uint32_t sequenceHash ) const;
+	bool IsEmpty( ) const;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+class PacketCompressionStats
+{
+public:
+	uint64_t compressedCount;
+	uint64_t skippedCount; //Tried, but wouldn't have been smaller
+	uint64_t rawBytes; //Of the compressed packets only
+	uint64_t compressedBytes;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// LZ77 in the style of LZ4 blocks. Each sequence is a token with the literal length in the high
+// nibble and the match length past MIN_MATCH in the low one, extended by 255 bytes when a nibble
+// is full, then the literals and a 16 bit offset back into the dictionary and output so far. The
+// last sequence is literals only. One greedy hash lookup per position, built for small packets.
+class PacketCompressor
+{
+//-------------------------------------------------------------------------------------------------
+// Static Members
+//-------------------------------------------------------------------------------------------------
+public:
+	static size_t const MIN_MATCH = 4;
+	static size_t const HASH_BITS = 10; //Packets are small, the table is cleared for each one
+	static size_t const MAX_SOURCE_SIZE = 0xFFFF;
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+public:
+	static size_t Compress( PacketDictionary const * dictionary, byte_t const * source, size_t sourceSize, byte_t * out_data, size_t dataCapacity );
+	static size_t Decompress( PacketDictionary const * dictionary, byte_t const * source, size_t sourceSize, byte_t * out_data, size_t dataCapacity );
+	static uint32_t HashSequence( byte_t const * data, size_t hashBits );
+
+private:
+	static size_t GetMatchLength( byte_t const * first, byte_t const * second, size_t maxLength );
+	static bool WriteSequence( byte_t const * literals, size_t literalLength, size_t matchLength, size_t offset, byte_t ** io_out, byte_t const * outEnd );
+	static bool WriteLength( size_t length, byte_t ** io_out, byte_t const * outEnd );
+	static bool ReadLength( byte_t const ** io_in, byte_t const * inEnd, size_t * io_length );
+};
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include "Engine/Net/Session/RateController.hpp"
+
+#include "Engine/Net/Session/NetPacket.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC double AIMDRateController::s_minSendRate = 16.0 * 1024.0;
+STATIC double AIMDRateController::s_startSendRate = 128.0 * 1024.0;
+STATIC double AIMDRateController::s_maxSendRate = 1024.0 * 1024.0;
+STATIC double AIMDRateController::s_increaseBytesPerRoundTrip = (double) NetPacket::MAX_SIZE;
+STATIC double AIMDRateController::s_decreaseFactor = 0.75;
+STATIC double AIMDRateController::s_maxBurstSeconds = 2.0 / 60.0; //Two ticks
+STATIC double AIMDRateController::s_delayIncreaseFactor = 2.0;
+
+
+//-------------------------------------------------------------------------------------------------
+// Round trips are adjusted at most once per tick even on a LAN
+static double const MIN_ADJUST_INTERVAL = 1.0 / 60.0;
+
+
+//-------------------------------------------------------------------------------------------------
+AIMDRateController::AIMDRateController( double currentTime )
+	: m_sendRate( s_startSendRate )
+	, m_tokens( (double) NetPacket::MAX_SIZE ) //First packet can always go out
+	, m_lastUpdateTime( currentTime )
+	, m_lastAdjustTime( currentTime )
+	, m_minRoundTripTime( -1.0 )
+	, m_acksSinceAdjust( 0 )
+	, m_lossesSinceAdjust( 0 )
+{
+	//Nothing
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void AIMDRateController::Update( double currentTime, double roundTripTime )
+{
+	double interval = roundTripTime;
+	if( interval < MIN_ADJUST_INTERVAL )
+	{
+		interval = MIN_ADJUST_INTERVAL;
+	}
+	if( currentTime - m_lastAdjustTime >= interval )
+	{
+		AdjustRate( roundTripTime );
+		m_lastAdjustTime = currentTime;
+	}
+
+	//Refill, never banking more than a short burst so an idle connection can't flood later
+	m_tokens += m_sendRate * ( currentTime - m_lastUpdateTime );
+	m_lastUpdateTime = currentTime;
+	double maxTokens = m_sendRate * s_maxBurstSeconds;
+	if( maxTokens < (double) NetPacket::MAX_SIZE )
+	{
+		maxTokens = (double) NetPacket::MAX_SIZE;
+	}
+	if( m_tokens > maxTokens )
+	{
+		m_tokens = maxTokens;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void AIMDRateController::OnPacketSent( size_t packetBytes )
+{
+	m_tokens -= (double) packetBytes;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void AIMDRateController::OnPacketAcked( double roundTripSample )
+{
+	++m_acksSinceAdjust;
+	if( m_minRoundTripTime < 0.0 || roundTripSample < m_minRoundTripTime )
+	{
+		m_minRoundTripTime = roundTripSample;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void AIMDRateController::OnPacketLost( )
+{
+	++m_lossesSinceAdjust;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool AIMDRateController::CanSend( ) const
+{
+	return m_tokens > 0.0;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+double AIMDRateController::GetSendRate( ) const
+{
+	return m_sendRate;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// One decision per round trip, so a burst of losses from one congestion event only cuts once
+void AIMDRateController::AdjustRate( double roundTripTime )
+{
+	bool delayRising = m_minRoundTripTime > 0.0
+		&& roundTripTime > m_minRoundTripTime * s_delayIncreaseFactor + MIN_ADJUST_INTERVAL;
+
+	if( m_lossesSinceAdjust > 0 || delayRising )
+	{
+		m_sendRate *= s_decreaseFactor;
+	}
+	else if( m_acksSinceAdjust > 0 )
+	{
+		double interval = roundTripTime;
+		if( interval < MIN_ADJUST_INTERVAL )
+		{
+			interval = MIN_ADJUST_INTERVAL;
+		}
+		m_sendRate += s_increaseBytesPerRoundTrip / interval;
+	}
+
+	if( m_sendRate < s_minSendRate )
+	{
+		m_sendRate = s_minSendRate;
+	}
+	else if( m_sendRate > s_maxSendRate )
+	{
+		m_sendRate = s_maxSendRate;
+	}
+
+	m_acksSinceAdjust = 0;
+	m_lossesSinceAdjust = 0;
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Engine/Core/EngineCommon.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+// Decides how many bytes a connection may send. NetConnection reports every packet sent, acked
+// and lost, then asks once per tick whether it may keep sending.
+class IRateController
+{
+public:
+	virtual ~IRateController( ) { }
+
+	virtual void Update( double currentTime, double roundTripTime ) = 0;
+	virtual void OnPacketSent( size_t packetBytes ) = 0;
+	virtual void OnPacketAcked( double roundTripSample ) = 0;
+	virtual void OnPacketLost( ) = 0;
+	virtual bool CanSend( ) const = 0;
+	virtual double GetSendRate( ) const = 0; //bytes per second
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Token bucket refilled at the send rate. The rate grows by one packet per round trip while the
+// link is clean, and is cut when packets are lost or the round trip climbs well above its floor.
+class AIMDRateController : public IRateController
+{
+//-------------------------------------------------------------------------------------------------
+// Static Members
+//-------------------------------------------------------------------------------------------------
+public:
+	static double s_minSendRate;
+	static double s_startSendRate;
+	static double s_maxSendRate;
+	static double s_increaseBytesPerRoundTrip;
+	static double s_decreaseFactor;
+	static double s_maxBurstSeconds;
+	static double s_delayIncreaseFactor; //Round trips this many times the floor count as congestion
+
+//-------------------------------------------------------------------------------------------------
+// Members
+//-------------------------------------------------------------------------------------------------
+private:
+	double m_sendRate;
+	double m_tokens; //Goes negative when the last packet of a tick overshoots, paid back next tick
+	double m_lastUpdateTime;
+	double m_lastAdjustTime;
+	double m_minRoundTripTime;
+	size_t m_acksSinceAdjust;
+	size_t m_lossesSinceAdjust;
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+public:
+	AIMDRateController( double currentTime );
+
+	virtual void Update( double currentTime, double roundTripTime ) override;
+	virtual void OnPacketSent( size_t packetBytes ) override;
+	virtual void OnPacketAcked( double roundTripSample ) override;
+	virtual void OnPacketLost( ) override;
+	virtual bool CanSend( ) const override;
+	virtual double GetSendRate( ) const override;
+
+private:
+	void AdjustRate( double roundTripTime );
+};
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "Engine/Net/Session/SequenceChannel.hpp"
+
+#include "Engine/Net/Session/NetMessage.hpp"
+#include "Engine/Net/Session/NetMessageArena.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+SequenceChannel::SequenceChannel( )
+	: m_count( 0 )
+{
+	for( size_t slot = 0; slot < WINDOW; ++slot )
+	{
+		m_slots[slot] = nullptr;
+	}
+	for( size_t word = 0; word < WINDOW / 32; ++word )
+	{
+		m_present[word] = 0U;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Returns false if the message is outside the window or its slot is taken, the caller still owns it then
+bool SequenceChannel::Insert( NetMessage * message, uint16_t nextExpectedID )
+{
+	uint16_t distance = message->m_sequenceID - nextExpectedID;
+	if( distance >= WINDOW )
+	{
+		return false;
+	}
+
+	size_t slot = message->m_sequenceID % WINDOW;
+	if( IsPresent( slot ) )
+	{
+		return false;
+	}
+
+	m_slots[slot] = message;
+	SetPresent( slot, true );
+	++m_count;
+	return true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Hands over the message for nextExpectedID if it has arrived
+NetMessage * SequenceChannel::TakeNext( uint16_t nextExpectedID )
+{
+	if( m_count == 0 )
+	{
+		return nullptr;
+	}
+
+	size_t slot = nextExpectedID % WINDOW;
+	if( !IsPresent( slot ) )
+	{
+		return nullptr;
+	}
+
+	NetMessage * message = m_slots[slot];
+	m_slots[slot] = nullptr;
+	SetPresent( slot, false );
+	--m_count;
+	return message;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void SequenceChannel::Clear( NetMessageArena & arena )
+{
+	for( size_t word = 0; word < WINDOW / 32 && m_count > 0; ++word )
+	{
+		//Skip empty stretches a word at a time
+		if( m_present[word] == 0U )
+		{
+			continue;
+		}
+
+		for( size_t bit = 0; bit < 32; ++bit )
+		{
+			size_t slot = word * 32 + bit;
+			if( IsPresent( slot ) )
+			{
+				arena.Release( m_slots[slot] );
+				m_slots[slot] = nullptr;
+				--m_count;
+			}
+		}
+		m_present[word] = 0U;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t SequenceChannel::GetCount( ) const
+{
+	return m_count;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool SequenceChannel::IsPresent( size_t slot ) const
+{
+	return ( m_present[slot / 32] & ( 1U << ( slot % 32 ) ) ) != 0U;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void SequenceChannel::SetPresent( size_t slot, bool present )
+{
+	if( present )
+	{
+		m_present[slot / 32] |= ( 1U << ( slot % 32 ) );
+	}
+	else
+	{
+		m_present[slot / 32] &= ~( 1U << ( slot % 32 ) );
+	}
+}
\ No newline at end of file
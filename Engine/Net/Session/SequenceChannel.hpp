@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Engine/Core/EngineCommon.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+class NetMessage;
+class NetMessageArena;
+
+
+//-------------------------------------------------------------------------------------------------
+// Reorder buffer for one reliable sequence channel. Early messages are slotted by
+// sequenceID % WINDOW with a bitmap of which slots are filled, so inserts are O(1) and
+// draining walks forward from the next expected ID.
+class SequenceChannel
+{
+//-------------------------------------------------------------------------------------------------
+// Static Members
+//-------------------------------------------------------------------------------------------------
+public:
+	//Same as NetConnection::MAX_RELIABLE_RANGE, a sender can't get further ahead than that
+	static size_t const WINDOW = 1024;
+
+//-------------------------------------------------------------------------------------------------
+// Members
+//-------------------------------------------------------------------------------------------------
+private:
+	NetMessage * m_slots[WINDOW];
+	uint32_t m_present[WINDOW / 32];
+	size_t m_count;
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+public:
+	SequenceChannel( );
+
+	bool Insert( NetMessage * message, uint16_t nextExpectedID );
+	NetMessage * TakeNext( uint16_t nextExpectedID );
+	void Clear( NetMessageArena & arena );
+	size_t GetCount( ) const;
+
+private:
+	bool IsPresent( size_t slot ) const;
+	void SetPresent( size_t slot, bool present );
+};
\ No newline at end of file
@@ -0,0 +1,287 @@
+#include "Engine/Net/Session/TrafficCapture.hpp"
+
+#include <stdio.h>
+#include "Engine/Core/Time.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+static uint16_t ReadLittleEndianUint16( byte_t const * data )
+{
+	return (uint16_t) ( data[0] | ( data[1] << 8 ) );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+class TrafficTotals
+{
+public:
+	uint64_t count;
+	uint64_t bytes;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Reads a dump back and writes a CSV: per direction, every message type's count, bytes, bytes per
+// second over the capture and share of that direction's bytes, then the packet header overhead.
+// Runs on any dump, the session that made it doesn't need to exist.
+STATIC bool TrafficCapture::WriteReport( char const * capturePath, char const * reportPath )
+{
+	FILE * captureFile = nullptr;
+	errno_t errorSuccess = fopen_s( &captureFile, capturePath, "rb" );
+	if( errorSuccess != 0 || captureFile == nullptr )
+	{
+		return false;
+	}
+
+	TrafficCaptureFileHeader header;
+	if( fread( &header, sizeof( header ), 1, captureFile ) != 1 ||
+		header.magic != TrafficCaptureFileHeader::MAGIC ||
+		header.version != TrafficCaptureFileHeader::VERSION ||
+		header.recordSize != sizeof( TrafficRecord ) )
+	{
+		fclose( captureFile );
+		return false;
+	}
+
+	//[0] sent, [1] received
+	TrafficTotals messageTotals[2][256];
+	TrafficTotals packetTotals[2];
+	memset( messageTotals, 0, sizeof( messageTotals ) );
+	memset( packetTotals, 0, sizeof( packetTotals ) );
+	double firstTime = 0.0;
+	double lastTime = 0.0;
+	for( uint32_t recordIndex = 0; recordIndex < header.recordCount; ++recordIndex )
+	{
+		TrafficRecord record;
+		if( fread( &record, sizeof( record ), 1, captureFile ) != 1 )
+		{
+			break;
+		}
+
+		if( recordIndex == 0 )
+		{
+			firstTime = record.time;
+		}
+		lastTime = record.time;
+
+		switch( record.kind )
+		{
+		case eTrafficRecordKind_PACKET_SENT:
+		case eTrafficRecordKind_PACKET_RECEIVED:
+		{
+			TrafficTotals & totals = packetTotals[record.kind == eTrafficRecordKind_PACKET_SENT ? 0 : 1];
+			++totals.count;
+			totals.bytes += record.size;
+			break;
+		}
+		case eTrafficRecordKind_MESSAGE_SENT:
+		case eTrafficRecordKind_MESSAGE_RECEIVED:
+		{
+			TrafficTotals & totals = messageTotals[record.kind == eTrafficRecordKind_MESSAGE_SENT ? 0 : 1][record.messageType];
+			++totals.count;
+			totals.bytes += record.size;
+			break;
+		}
+		default:
+			break;
+		}
+	}
+	fclose( captureFile );
+
+	FILE * reportFile = nullptr;
+	errorSuccess = fopen_s( &reportFile, reportPath, "wb" );
+	if( errorSuccess != 0 || reportFile == nullptr )
+	{
+		return false;
+	}
+
+	//A capture shorter than a second reports per second as if it were one
+	double seconds = lastTime - firstTime;
+	if( seconds < 1.0 )
+	{
+		seconds = 1.0;
+	}
+
+	char const * directionNames[2] = { "sent", "received" };
+	fprintf( reportFile, "direction,type,count,bytes,bytes_per_sec,share\n" );
+	for( size_t direction = 0; direction < 2; ++direction )
+	{
+		TrafficTotals const & packets = packetTotals[direction];
+		if( packets.count == 0 )
+		{
+			continue;
+		}
+
+		uint64_t messageBytes = 0;
+		for( size_t type = 0; type < 256; ++type )
+		{
+			TrafficTotals const & totals = messageTotals[direction][type];
+			if( totals.count == 0 )
+			{
+				continue;
+			}
+
+			messageBytes += totals.bytes;
+			fprintf( reportFile, "%s,%u,%llu,%llu,%.1f,%.4f\n", directionNames[direction], (unsigned int) type,
+				(unsigned long long) totals.count, (unsigned long long) totals.bytes, (double) totals.bytes / seconds, (double) totals.bytes / (double) packets.bytes );
+		}
+
+		//Packet header and message count, the rest of each packet's bytes
+		uint64_t headerBytes = packets.bytes - messageBytes;
+		fprintf( reportFile, "%s,header,%llu,%llu,%.1f,%.4f\n", directionNames[direction],
+			(unsigned long long) packets.count, (unsigned long long) headerBytes, (double) headerBytes / seconds, (double) headerBytes / (double) packets.bytes );
+		fprintf( reportFile, "%s,total,%llu,%llu,%.1f,1.0000\n", directionNames[direction],
+			(unsigned long long) packets.count, (unsigned long long) packets.bytes, (double) packets.bytes / seconds );
+	}
+
+	fclose( reportFile );
+	return true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+TrafficCapture::TrafficCapture( )
+	: m_mask( 0 )
+	, m_recordedCount( 0 )
+{
+	//Nothing
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Rounds up to a power of two, anything recorded before is dropped
+void TrafficCapture::Start( size_t recordCount )
+{
+	size_t capacity = 1;
+	while( capacity < recordCount )
+	{
+		capacity <<= 1;
+	}
+
+	m_records.assign( capacity, TrafficRecord( ) );
+	m_mask = capacity - 1;
+	m_recordedCount = 0;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void TrafficCapture::Stop( )
+{
+	std::vector<TrafficRecord>( ).swap( m_records );
+	m_mask = 0;
+	m_recordedCount = 0;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// data is the packet as it goes on or came off the wire. Stops at the first message that runs past
+// the end, a malformed packet is recorded as far as it makes sense.
+void TrafficCapture::RecordPacket( bool sent, byte_t const * data, size_t dataSize )
+{
+	if( m_records.empty( ) || dataSize < PACKET_HEADER_SIZE )
+	{
+		return;
+	}
+
+	double time = Time::GetCurrentTimeSeconds( );
+	uint16_t connectionIndex = ReadLittleEndianUint16( data );
+	uint16_t packetAck = ReadLittleEndianUint16( data + sizeof( uint16_t ) );
+	AddRecord( time, connectionIndex, packetAck, dataSize, sent ? eTrafficRecordKind_PACKET_SENT : eTrafficRecordKind_PACKET_RECEIVED, 0 );
+
+	//Each message is its size, then the type and the rest of the header and payload
+	eTrafficRecordKind messageKind = sent ? eTrafficRecordKind_MESSAGE_SENT : eTrafficRecordKind_MESSAGE_RECEIVED;
+	uint8_t messageCount = data[PACKET_HEADER_SIZE - 1];
+	size_t offset = PACKET_HEADER_SIZE;
+	for( uint8_t messageIndex = 0; messageIndex < messageCount; ++messageIndex )
+	{
+		if( offset + sizeof( uint16_t ) + 1 > dataSize )
+		{
+			break;
+		}
+
+		size_t messageSize = ReadLittleEndianUint16( data + offset ) + sizeof( uint16_t );
+		if( offset + messageSize > dataSize )
+		{
+			break;
+		}
+
+		AddRecord( time, connectionIndex, packetAck, messageSize, messageKind, data[offset + sizeof( uint16_t )] );
+		offset += messageSize;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool TrafficCapture::Dump( char const * path ) const
+{
+	FILE * file = nullptr;
+	errno_t errorSuccess = fopen_s( &file, path, "wb" );
+	if( errorSuccess != 0 || file == nullptr )
+	{
+		return false;
+	}
+
+	size_t recordCount = GetRecordCount( );
+	TrafficCaptureFileHeader header;
+	header.magic = TrafficCaptureFileHeader::MAGIC;
+	header.version = TrafficCaptureFileHeader::VERSION;
+	header.recordSize = (uint16_t) sizeof( TrafficRecord );
+	header.recordCount = (uint32_t) recordCount;
+	header.overwrittenCount = (uint32_t) ( m_recordedCount - recordCount );
+	fwrite( &header, sizeof( header ), 1, file );
+
+	//Oldest first, once the ring has wrapped that's the slot about to be overwritten
+	if( recordCount > 0 )
+	{
+		size_t oldest = (size_t) ( ( m_recordedCount - recordCount ) & m_mask );
+		size_t firstPart = m_records.size( ) - oldest;
+		if( firstPart > recordCount )
+		{
+			firstPart = recordCount;
+		}
+		fwrite( &m_records[oldest], sizeof( TrafficRecord ), firstPart, file );
+		fwrite( &m_records[0], sizeof( TrafficRecord ), recordCount - firstPart, file );
+	}
+
+	fclose( file );
+	return true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool TrafficCapture::IsCapturing( ) const
+{
+	return !m_records.empty( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t TrafficCapture::GetCapacity( ) const
+{
+	return m_records.size( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t TrafficCapture::GetRecordCount( ) const
+{
+	if( m_recordedCount < (uint64_t) m_records.size( ) )
+	{
+		return (size_t) m_recordedCount;
+	}
+	return m_records.size( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void TrafficCapture::AddRecord( double time, uint16_t connectionIndex, uint16_t packetAck, size_t size, eTrafficRecordKind kind, uint8_t messageType )
+{
+	TrafficRecord & record = m_records[(size_t) ( m_recordedCount & m_mask )];
+	record.time = time;
+	record.connectionIndex = connectionIndex;
+	record.packetAck = packetAck;
+	record.size = (uint16_t) size;
+	record.kind = (uint8_t) kind;
+	record.messageType = messageType;
+	++m_recordedCount;
+}
\ No newline at end of file
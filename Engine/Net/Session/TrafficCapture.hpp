@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vector>
+#include "Engine/Core/EngineCommon.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+enum eTrafficRecordKind : uint8_t
+{
+	eTrafficRecordKind_PACKET_SENT,
+	eTrafficRecordKind_PACKET_RECEIVED,
+	eTrafficRecordKind_MESSAGE_SENT,
+	eTrafficRecordKind_MESSAGE_RECEIVED,
+	eTrafficRecordKind_COUNT,
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// 16 bytes. A packet record is followed by one message record per message in it.
+class TrafficRecord
+{
+public:
+	double time;
+	uint16_t connectionIndex; //From the packet header, the same slot on both ends
+	uint16_t packetAck;
+	uint16_t size; //Whole packet before compression, or one message with its size field
+	uint8_t kind; //eTrafficRecordKind
+	uint8_t messageType; //Message records only
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Written at the start of a dump, the records follow oldest first
+class TrafficCaptureFileHeader
+{
+public:
+	static uint32_t const MAGIC = 0x5041434E; //"NCAP"
+	static uint16_t const VERSION = 1;
+
+public:
+	uint32_t magic;
+	uint16_t version;
+	uint16_t recordSize;
+	uint32_t recordCount;
+	uint32_t overwrittenCount; //Older records the ring had already dropped
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Binary capture of every packet a session sends and receives: the packet header and each message's
+// type and size, into a preallocated ring. Recording just walks the message size fields, there's no
+// formatting or allocation on the send path. Dump() writes the ring to a file on demand and
+// WriteReport() turns a dump into per message type bandwidth, offline.
+class TrafficCapture
+{
+//-------------------------------------------------------------------------------------------------
+// Static Members
+//-------------------------------------------------------------------------------------------------
+public:
+	static size_t const DEFAULT_RECORD_COUNT = 65536; //1 MB
+	static size_t const PACKET_HEADER_SIZE = 15; //See NetPacket::WriteHeader, then the message count
+
+//-------------------------------------------------------------------------------------------------
+// Members
+//-------------------------------------------------------------------------------------------------
+private:
+	std::vector<TrafficRecord> m_records; //Empty while stopped
+	size_t m_mask;
+	uint64_t m_recordedCount;
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+public:
+	static bool WriteReport( char const * capturePath, char const * reportPath );
+
+	TrafficCapture( );
+
+	void Start( size_t recordCount );
+	void Stop( );
+	void RecordPacket( bool sent, byte_t const * data, size_t dataSize );
+	bool Dump( char const * path ) const;
+
+	bool IsCapturing( ) const;
+	size_t GetCapacity( ) const;
+	size_t GetRecordCount( ) const;
+
+private:
+	void AddRecord( double time, uint16_t connectionIndex, uint16_t packetAck, size_t size, eTrafficRecordKind kind, uint8_t messageType );
+};
\ No newline at end of file
@@ -8,6 +8,7 @@
 UDPSock::UDPSock( )
 	: m_socket( INVALID_SOCKET )
 	, m_addr( )
+	, m_syscallCount( 0 )
 {
 
 }
@@ -178,6 +179,13 @@ sockaddr_in const & UDPSock::GetAddress( ) const
 }
 
 
+//-------------------------------------------------------------------------------------------------
+size_t UDPSock::GetSyscallCount( ) const
+{
+	return m_syscallCount;
+}
+
+
 //-------------------------------------------------------------------------------------------------
 size_t SocketSendTo( SOCKET mySocket,
 	sockaddr_in & toAddr,
@@ -211,6 +219,7 @@ size_t SocketSendTo( SOCKET mySocket,
 //-------------------------------------------------------------------------------------------------
 size_t UDPSock::Send( sockaddr_in addr, byte_t const * data, size_t dataSize ) const
 {
+	++m_syscallCount;
 	return SocketSendTo( m_socket, addr, data, dataSize );
 }
 
@@ -260,5 +269,124 @@ size_t SocketReceiveFrom( sockaddr_in * out_fromAddr,
 //-------------------------------------------------------------------------------------------------
 size_t UDPSock::Recv( sockaddr_in * out_addr, byte_t * data, size_t maxSize /*max you can read into data*/ )
 {
+	++m_syscallCount;
 	return SocketReceiveFrom( out_addr, m_socket, data, maxSize );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Returns the number of datagrams handed to the socket
+size_t UDPSock::SendBatch( UDPDatagram const * datagrams, size_t count ) const
+{
+	if( m_socket == INVALID_SOCKET || count == 0 )
+	{
+		return 0U;
+	}
+
+#if defined( __linux__ )
+	mmsghdr messages[MAX_BATCH_SIZE];
+	iovec payloads[MAX_BATCH_SIZE];
+	size_t totalSent = 0;
+	while( totalSent < count )
+	{
+		size_t batchCount = count - totalSent;
+		if( batchCount > MAX_BATCH_SIZE )
+		{
+			batchCount = MAX_BATCH_SIZE;
+		}
+
+		memset( messages, 0, sizeof( mmsghdr ) * batchCount );
+		for( size_t batchIndex = 0; batchIndex < batchCount; ++batchIndex )
+		{
+			UDPDatagram const & datagram = datagrams[totalSent + batchIndex];
+			payloads[batchIndex].iov_base = datagram.data;
+			payloads[batchIndex].iov_len = datagram.dataSize;
+			messages[batchIndex].msg_hdr.msg_name = (void*) &datagram.address;
+			messages[batchIndex].msg_hdr.msg_namelen = sizeof( sockaddr_in );
+			messages[batchIndex].msg_hdr.msg_iov = &payloads[batchIndex];
+			messages[batchIndex].msg_hdr.msg_iovlen = 1;
+		}
+
+		++m_syscallCount;
+		int sent = ::sendmmsg( m_socket, messages, (unsigned int) batchCount, 0 );
+		if( sent <= 0 )
+		{
+			//Drop the datagram we are stuck on, same as a failed sendto
+			++totalSent;
+			continue;
+		}
+		totalSent += (size_t) sent;
+	}
+	return totalSent;
+#else
+	//Per datagram fallback
+	size_t totalSent = 0;
+	for( size_t datagramIndex = 0; datagramIndex < count; ++datagramIndex )
+	{
+		UDPDatagram const & datagram = datagrams[datagramIndex];
+		if( Send( datagram.address, datagram.data, datagram.dataSize ) > 0 )
+		{
+			++totalSent;
+		}
+	}
+	return totalSent;
+#endif
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Fills up to count datagrams, returns how many were read
+size_t UDPSock::RecvBatch( UDPDatagram * out_datagrams, size_t count )
+{
+	if( m_socket == INVALID_SOCKET || count == 0 )
+	{
+		return 0U;
+	}
+
+	if( count > MAX_BATCH_SIZE )
+	{
+		count = MAX_BATCH_SIZE;
+	}
+
+#if defined( __linux__ )
+	mmsghdr messages[MAX_BATCH_SIZE];
+	iovec payloads[MAX_BATCH_SIZE];
+	memset( messages, 0, sizeof( mmsghdr ) * count );
+	for( size_t batchIndex = 0; batchIndex < count; ++batchIndex )
+	{
+		payloads[batchIndex].iov_base = out_datagrams[batchIndex].data;
+		payloads[batchIndex].iov_len = out_datagrams[batchIndex].dataMax;
+		messages[batchIndex].msg_hdr.msg_name = &out_datagrams[batchIndex].address;
+		messages[batchIndex].msg_hdr.msg_namelen = sizeof( sockaddr_in );
+		messages[batchIndex].msg_hdr.msg_iov = &payloads[batchIndex];
+		messages[batchIndex].msg_hdr.msg_iovlen = 1;
+	}
+
+	++m_syscallCount;
+	int received = ::recvmmsg( m_socket, messages, (unsigned int) count, MSG_DONTWAIT, nullptr );
+	if( received <= 0 )
+	{
+		return 0U;
+	}
+
+	for( int batchIndex = 0; batchIndex < received; ++batchIndex )
+	{
+		out_datagrams[batchIndex].dataSize = messages[batchIndex].msg_len;
+	}
+	return (size_t) received;
+#else
+	//Per datagram fallback
+	size_t totalReceived = 0;
+	while( totalReceived < count )
+	{
+		UDPDatagram & datagram = out_datagrams[totalReceived];
+		datagram.dataSize = Recv( &datagram.address, datagram.data, datagram.dataMax );
+		if( datagram.dataSize == 0 )
+		{
+			break;
+		}
+		++totalReceived;
+	}
+	return totalReceived;
+#endif
 }
\ No newline at end of file
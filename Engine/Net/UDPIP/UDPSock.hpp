@@ -3,15 +3,34 @@
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Utils/NetworkUtils.hpp"
 
+//-------------------------------------------------------------------------------------------------
+// One datagram in a batched send or receive, data points at caller owned memory
+class UDPDatagram
+{
+public:
+	sockaddr_in address;
+	byte_t * data;
+	size_t dataMax;
+	size_t dataSize;
+};
+
+
 //-------------------------------------------------------------------------------------------------
 class UDPSock
 {
+//-------------------------------------------------------------------------------------------------
+// Static Members
+//-------------------------------------------------------------------------------------------------
+public:
+	static size_t const MAX_BATCH_SIZE = 64; //Most datagrams moved per syscall
+
 //-------------------------------------------------------------------------------------------------
 // Members
 //-------------------------------------------------------------------------------------------------
 private:
 	SOCKET m_socket;
 	sockaddr_in m_addr;
+	mutable size_t m_syscallCount; //Counted on const Send() as well
 
 //-------------------------------------------------------------------------------------------------
 // Functions
@@ -25,8 +44,11 @@ public:
 	bool IsConnected( ) const;
 	char const * GetAddressString( ) const;
 	sockaddr_in const & GetAddress( ) const;
+	size_t GetSyscallCount( ) const;
 
 protected:
 	size_t Send( sockaddr_in addr, byte_t const * data, size_t dataSize ) const;
 	size_t Recv( sockaddr_in * out_addr, byte_t * data, size_t maxSize /*max you can read into data*/ );
+	size_t SendBatch( UDPDatagram const * datagrams, size_t count ) const;
+	size_t RecvBatch( UDPDatagram * out_datagrams, size_t count );
 };
\ No newline at end of file
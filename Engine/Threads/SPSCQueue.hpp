@@ -0,0 +1,99 @@
+#pragma once
+#include <atomic>
+#include "Engine/Memory/MemoryAnalytics.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+// Bounded ring for exactly one producer thread and one consumer thread, no locks. Slots are
+// written and read in place, so large elements are never copied through a temporary.
+template<typename Type>
+class SPSCQueue
+{
+//-------------------------------------------------------------------------------------------------
+// Members
+//-------------------------------------------------------------------------------------------------
+private:
+	Type * m_slots;
+	size_t m_mask; //Capacity is a power of two
+
+	//Only the consumer writes the head and only the producer writes the tail, kept on separate cache lines
+	alignas( 64 ) std::atomic<size_t> m_head;
+	alignas( 64 ) std::atomic<size_t> m_tail;
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+public:
+	//-------------------------------------------------------------------------------------------------
+	SPSCQueue( size_t capacity )
+		: m_slots( nullptr )
+		, m_mask( 0 )
+		, m_head( 0 )
+		, m_tail( 0 )
+	{
+		size_t roundedCapacity = 1;
+		while( roundedCapacity < capacity )
+		{
+			roundedCapacity <<= 1;
+		}
+		m_slots = new Type[roundedCapacity];
+		m_mask = roundedCapacity - 1;
+	}
+
+	//-------------------------------------------------------------------------------------------------
+	~SPSCQueue( )
+	{
+		delete[] m_slots;
+		m_slots = nullptr;
+	}
+
+	SPSCQueue( SPSCQueue const & copy ) = delete;
+
+	//---------------------------------------------------------------------------------------------
+	// Producer only, nullptr when full. Fill the slot then CommitWrite()
+	Type * GetWriteSlot( )
+	{
+		size_t tail = m_tail.load( std::memory_order_relaxed );
+		if( tail - m_head.load( std::memory_order_acquire ) > m_mask )
+		{
+			return nullptr;
+		}
+		return &m_slots[tail & m_mask];
+	}
+
+	//---------------------------------------------------------------------------------------------
+	void CommitWrite( )
+	{
+		m_tail.store( m_tail.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+	}
+
+	//---------------------------------------------------------------------------------------------
+	// Consumer only, nullptr when empty. The slot stays valid until CommitRead()
+	Type * GetReadSlot( )
+	{
+		size_t head = m_head.load( std::memory_order_relaxed );
+		if( head == m_tail.load( std::memory_order_acquire ) )
+		{
+			return nullptr;
+		}
+		return &m_slots[head & m_mask];
+	}
+
+	//---------------------------------------------------------------------------------------------
+	void CommitRead( )
+	{
+		m_head.store( m_head.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+	}
+
+	//---------------------------------------------------------------------------------------------
+	size_t GetCount( ) const
+	{
+		return m_tail.load( std::memory_order_acquire ) - m_head.load( std::memory_order_acquire );
+	}
+
+	//---------------------------------------------------------------------------------------------
+	size_t GetCapacity( ) const
+	{
+		return m_mask + 1;
+	}
+};
\ No newline at end of file
@@ -9,6 +9,14 @@ Thread::Thread( EntryCallback * functionPtr )
 }
 
 
+//-------------------------------------------------------------------------------------------------
+Thread::Thread( EntryCallback * functionPtr, void * data )
+	: m_handle( functionPtr, data )
+{
+
+}
+
+
 //-------------------------------------------------------------------------------------------------
 void Thread::Join( )
 {
@@ -20,4 +28,11 @@ void Thread::Join( )
 void Thread::Detach( )
 {
 	m_handle.detach( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool Thread::IsCurrentThread( ) const
+{
+	return std::this_thread::get_id( ) == m_handle.get_id( );
 }
\ No newline at end of file
@@ -20,6 +20,8 @@ private:
 //-------------------------------------------------------------------------------------------------
 public:
 	Thread( EntryCallback * functionPtr );
+	Thread( EntryCallback * functionPtr, void * data );
 	void Join( );
 	void Detach( );
+	bool IsCurrentThread( ) const;
 };
\ No newline at end of file
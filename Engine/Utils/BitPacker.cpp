@@ -0,0 +1,326 @@
+#include "Engine/Utils/BitPacker.hpp"
+
+#include "Engine/DebugSystem/ErrorWarningAssert.hpp"
+#include "Engine/Math/Vector2f.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+static size_t const VARINT_GROUP_BITS = 7;
+
+
+//-------------------------------------------------------------------------------------------------
+static uint32_t GetMaxQuantized( size_t bitCount )
+{
+	if( bitCount >= 32 )
+	{
+		return 0xFFFFFFFFU;
+	}
+	return ( 1U << bitCount ) - 1U;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+BitPacker::BitPacker( byte_t * buffer, size_t bufferMax )
+	: BitPacker( buffer, bufferMax, 0 )
+{
+	//Nothing
+}
+
+
+//-------------------------------------------------------------------------------------------------
+BitPacker::BitPacker( byte_t * buffer, size_t bufferMax, size_t bufferSize )
+	: m_buffer( buffer )
+	, m_bufferMax( bufferMax )
+	, m_bitsWritten( bufferSize * 8 )
+	, m_bitOffset( 0 )
+{
+	if( bufferMax < bufferSize )
+	{
+		ERROR_AND_DIE( "Buffer size too large" );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool BitPacker::WriteBits( uint32_t value, size_t bitCount )
+{
+	if( bitCount == 0 || bitCount > MAX_BITS_PER_WRITE )
+	{
+		return false;
+	}
+
+	//Make sure we don't go out of bounds
+	if( m_bitsWritten + bitCount > m_bufferMax * 8 )
+	{
+		return false;
+	}
+
+	//Only keep the bits we were asked to write
+	value &= GetMaxQuantized( bitCount );
+
+	//Fill the current partial byte, then whole bytes
+	size_t bitsLeft = bitCount;
+	while( bitsLeft > 0 )
+	{
+		size_t byteIndex = m_bitsWritten / 8;
+		size_t bitInByte = m_bitsWritten % 8;
+		size_t bitsThisByte = 8 - bitInByte;
+		if( bitsThisByte > bitsLeft )
+		{
+			bitsThisByte = bitsLeft;
+		}
+
+		if( bitInByte == 0 )
+		{
+			m_buffer[byteIndex] = 0;
+		}
+		byte_t bits = (byte_t) ( value & ( ( 1U << bitsThisByte ) - 1U ) );
+		m_buffer[byteIndex] |= (byte_t) ( bits << bitInByte );
+
+		value >>= bitsThisByte;
+		m_bitsWritten += bitsThisByte;
+		bitsLeft -= bitsThisByte;
+	}
+	return true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool BitPacker::WriteBool( bool value )
+{
+	return WriteBits( value ? 1U : 0U, 1 );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool BitPacker::WriteQuantizedFloat( float value, float min, float max, size_t bitCount )
+{
+	return WriteBits( QuantizeFloat( value, min, max, bitCount ), bitCount );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool BitPacker::WriteQuantizedVector2f( Vector2f const & value, Vector2f const & min, Vector2f const & max, size_t bitCountPerAxis )
+{
+	bool success = WriteQuantizedFloat( value.x, min.x, max.x, bitCountPerAxis );
+	success = success && WriteQuantizedFloat( value.y, min.y, max.y, bitCountPerAxis );
+	return success;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// 7 bits per group with a continue bit, small values only cost 8 bits
+bool BitPacker::WriteVarUint32( uint32_t value )
+{
+	while( value >= ( 1U << VARINT_GROUP_BITS ) )
+	{
+		if( !WriteBits( ( value & GetMaxQuantized( VARINT_GROUP_BITS ) ) | ( 1U << VARINT_GROUP_BITS ), VARINT_GROUP_BITS + 1 ) )
+		{
+			return false;
+		}
+		value >>= VARINT_GROUP_BITS;
+	}
+	return WriteBits( value, VARINT_GROUP_BITS + 1 );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool BitPacker::WriteZigZagInt32( int32_t value )
+{
+	return WriteVarUint32( ZigZagEncode( value ) );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool BitPacker::ReadBits( uint32_t * out_value, size_t bitCount ) const
+{
+	if( bitCount == 0 || bitCount > MAX_BITS_PER_WRITE )
+	{
+		return false;
+	}
+
+	//Make sure we don't go out of bounds
+	if( m_bitOffset + bitCount > m_bitsWritten )
+	{
+		return false;
+	}
+
+	uint32_t value = 0U;
+	size_t bitsRead = 0;
+	while( bitsRead < bitCount )
+	{
+		size_t byteIndex = m_bitOffset / 8;
+		size_t bitInByte = m_bitOffset % 8;
+		size_t bitsThisByte = 8 - bitInByte;
+		if( bitsThisByte > bitCount - bitsRead )
+		{
+			bitsThisByte = bitCount - bitsRead;
+		}
+
+		uint32_t bits = ( m_buffer[byteIndex] >> bitInByte ) & ( ( 1U << bitsThisByte ) - 1U );
+		value |= bits << bitsRead;
+
+		m_bitOffset += bitsThisByte;
+		bitsRead += bitsThisByte;
+	}
+
+	*out_value = value;
+	return true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool BitPacker::ReadBool( bool * out_value ) const
+{
+	uint32_t value = 0U;
+	bool success = ReadBits( &value, 1 );
+	*out_value = value == 1U;
+	return success;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool BitPacker::ReadQuantizedFloat( float * out_value, float min, float max, size_t bitCount ) const
+{
+	uint32_t quantized = 0U;
+	if( !ReadBits( &quantized, bitCount ) )
+	{
+		return false;
+	}
+	*out_value = DequantizeFloat( quantized, min, max, bitCount );
+	return true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool BitPacker::ReadQuantizedVector2f( Vector2f * out_value, Vector2f const & min, Vector2f const & max, size_t bitCountPerAxis ) const
+{
+	bool success = ReadQuantizedFloat( &out_value->x, min.x, max.x, bitCountPerAxis );
+	success = success && ReadQuantizedFloat( &out_value->y, min.y, max.y, bitCountPerAxis );
+	return success;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool BitPacker::ReadVarUint32( uint32_t * out_value ) const
+{
+	uint32_t value = 0U;
+	size_t shift = 0;
+	while( shift < 32 )
+	{
+		uint32_t group = 0U;
+		if( !ReadBits( &group, VARINT_GROUP_BITS + 1 ) )
+		{
+			return false;
+		}
+
+		value |= ( group & GetMaxQuantized( VARINT_GROUP_BITS ) ) << shift;
+		if( ( group & ( 1U << VARINT_GROUP_BITS ) ) == 0U )
+		{
+			*out_value = value;
+			return true;
+		}
+		shift += VARINT_GROUP_BITS;
+	}
+
+	//More groups than a uint32 can hold, the stream is bad
+	return false;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool BitPacker::ReadZigZagInt32( int32_t * out_value ) const
+{
+	uint32_t encoded = 0U;
+	if( !ReadVarUint32( &encoded ) )
+	{
+		return false;
+	}
+	*out_value = ZigZagDecode( encoded );
+	return true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t BitPacker::GetBitsWritten( ) const
+{
+	return m_bitsWritten;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t BitPacker::GetBitsReadableLeft( ) const
+{
+	return m_bitsWritten - m_bitOffset;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t BitPacker::GetByteCount( ) const
+{
+	return ( m_bitsWritten + 7 ) / 8;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Partial bytes count as read, the next field in a BytePacker starts on the following byte
+size_t BitPacker::GetBytesRead( ) const
+{
+	return ( m_bitOffset + 7 ) / 8;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+byte_t * BitPacker::GetBuffer( ) const
+{
+	return m_buffer;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void BitPacker::Rewind( ) const
+{
+	m_bitOffset = 0;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Maps signed to unsigned so small deltas in either direction stay small: 0, -1, 1, -2 -> 0, 1, 2, 3
+STATIC uint32_t BitPacker::ZigZagEncode( int32_t value )
+{
+	return ( (uint32_t) value << 1 ) ^ (uint32_t) ( value >> 31 );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC int32_t BitPacker::ZigZagDecode( uint32_t value )
+{
+	return (int32_t) ( value >> 1 ) ^ -(int32_t) ( value & 1U );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Rounds to the nearest step and clamps, so values outside the range don't wrap around
+STATIC uint32_t BitPacker::QuantizeFloat( float value, float min, float max, size_t bitCount )
+{
+	float zeroToOne = ( value - min ) / ( max - min );
+	if( zeroToOne < 0.f )
+	{
+		zeroToOne = 0.f;
+	}
+	else if( zeroToOne > 1.f )
+	{
+		zeroToOne = 1.f;
+	}
+
+	uint32_t maxQuantized = GetMaxQuantized( bitCount );
+	return (uint32_t) ( (double) maxQuantized * zeroToOne + 0.5 );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC float BitPacker::DequantizeFloat( uint32_t quantized, float min, float max, size_t bitCount )
+{
+	float zeroToOne = (float) ( (double) quantized / (double) GetMaxQuantized( bitCount ) );
+	return min + ( max - min ) * zeroToOne;
+}
\ No newline at end of file
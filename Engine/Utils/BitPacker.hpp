@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+#include "Engine/Core/EngineCommon.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+class Vector2f;
+
+
+//-------------------------------------------------------------------------------------------------
+// Bit-level counterpart to BytePacker. Values are packed least significant bit first, so the
+// stream is the same on every platform and needs no endian handling.
+class BitPacker
+{
+//-------------------------------------------------------------------------------------------------
+// Static Members
+//-------------------------------------------------------------------------------------------------
+public:
+	static size_t const MAX_BITS_PER_WRITE = 32;
+
+//-------------------------------------------------------------------------------------------------
+// Members
+//-------------------------------------------------------------------------------------------------
+protected:
+	byte_t * m_buffer;
+	size_t m_bufferMax; //bytes
+	size_t m_bitsWritten;
+	mutable size_t m_bitOffset; //Read cursor, can be changed even if you call something const
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+public:
+	BitPacker( byte_t * buffer, size_t bufferMax );
+	BitPacker( byte_t * buffer, size_t bufferMax, size_t bufferSize );
+
+	bool WriteBits( uint32_t value, size_t bitCount );
+	bool WriteBool( bool value );
+	bool WriteQuantizedFloat( float value, float min, float max, size_t bitCount );
+	bool WriteQuantizedVector2f( Vector2f const & value, Vector2f const & min, Vector2f const & max, size_t bitCountPerAxis );
+	bool WriteVarUint32( uint32_t value );
+	bool WriteZigZagInt32( int32_t value );
+
+	bool ReadBits( uint32_t * out_value, size_t bitCount ) const;
+	bool ReadBool( bool * out_value ) const;
+	bool ReadQuantizedFloat( float * out_value, float min, float max, size_t bitCount ) const;
+	bool ReadQuantizedVector2f( Vector2f * out_value, Vector2f const & min, Vector2f const & max, size_t bitCountPerAxis ) const;
+	bool ReadVarUint32( uint32_t * out_value ) const;
+	bool ReadZigZagInt32( int32_t * out_value ) const;
+
+	size_t GetBitsWritten( ) const;
+	size_t GetBitsReadableLeft( ) const;
+	size_t GetByteCount( ) const;
+	size_t GetBytesRead( ) const;
+	byte_t * GetBuffer( ) const;
+	void Rewind( ) const;
+
+	static uint32_t ZigZagEncode( int32_t value );
+	static int32_t ZigZagDecode( uint32_t value );
+	static uint32_t QuantizeFloat( float value, float min, float max, size_t bitCount );
+	static float DequantizeFloat( uint32_t quantized, float min, float max, size_t bitCount );
+};
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "Engine/Utils/BytePacker.hpp"
 
 #include "Engine/DebugSystem/ErrorWarningAssert.hpp"
+#include "Engine/Utils/BitPacker.hpp"
 
 
 //-------------------------------------------------------------------------------------------------
@@ -193,6 +194,26 @@ bool BytePacker::ReadString( char ** out_data ) const
 }
 
 
+//-------------------------------------------------------------------------------------------------
+// Appends the whole bytes of a bit stream, the last byte is padded with zeros
+bool BytePacker::WriteBits( BitPacker const & bits )
+{
+	if( bits.GetByteCount( ) == 0 )
+	{
+		return true;
+	}
+	return WriteForward( bits.GetBuffer( ), bits.GetByteCount( ) );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Bit stream over everything left to read. Advance by GetBytesRead( ) when done with it.
+BitPacker BytePacker::GetBitReader( ) const
+{
+	return BitPacker( GetHead( ), GetReadableBytesLeft( ), GetReadableBytesLeft( ) );
+}
+
+
 //-------------------------------------------------------------------------------------------------
 void BytePacker::Advance( size_t amount ) const
 {
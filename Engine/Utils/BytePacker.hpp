@@ -3,6 +3,10 @@
 #include "Engine/Utils/EndianUtils.hpp"
 
 
+//-------------------------------------------------------------------------------------------------
+class BitPacker;
+
+
 //-------------------------------------------------------------------------------------------------
 class BytePacker
 {
@@ -38,6 +42,7 @@ public:
 	bool WriteForward( byte_t const * data, size_t dataSize );
 	bool WriteBackwards( byte_t const * data, size_t dataSize );
 	bool WriteString( char const * data );
+	bool WriteBits( BitPacker const & bits );
 
 	template<typename DataType>
 	size_t Reserve( DataType const & data )
@@ -68,6 +73,7 @@ public:
 	bool ReadForward( byte_t * out_data, size_t readAmount ) const;
 	bool ReadBackwards( byte_t * out_data, size_t readAmount ) const;
 	bool ReadString( char ** out_data ) const;
+	BitPacker GetBitReader( ) const;
 	void Advance( size_t amount ) const;
 
 	size_t GetWritableBytesLeft( ) const;
@@ -810,6 +810,14 @@ bool IsBitSet( uint8_t bitFlags, size_t bitIndex )
 }
 
 
+//-------------------------------------------------------------------------------------------------
+// BIT() is an int shift, wide fields need a 64 bit one
+bool IsBitSet( uint64_t bitFlags, size_t bitIndex )
+{
+	return ( bitFlags & ( 1ULL << bitIndex ) ) != 0;
+}
+
+
 //-------------------------------------------------------------------------------------------------
 void SetBit( uint16_t * out_bitField, size_t bitToSet )
 {
@@ -824,6 +832,13 @@ void SetBit( uint8_t * out_bitField, size_t bitToSet )
 }
 
 
+//-------------------------------------------------------------------------------------------------
+void SetBit( uint64_t * out_bitField, size_t bitToSet )
+{
+	*out_bitField |= ( 1ULL << bitToSet );
+}
+
+
 //-------------------------------------------------------------------------------------------------
 size_t HashMemory( void const * memory, size_t const memorySize )
 {
@@ -99,8 +99,10 @@ bool IsBitfieldSet( uint16_t bitFlags, size_t bitMask );
 bool IsBitfieldSet( uint8_t bitFlags, size_t bitMask );
 bool IsBitSet( uint16_t bitFlags, size_t bit );
 bool IsBitSet( uint8_t bitFlags, size_t bit );
+bool IsBitSet( uint64_t bitFlags, size_t bit );
 void SetBit( uint16_t * out_bitField, size_t bitToSet );
 void SetBit( uint8_t * out_bitField, size_t bitToSet );
+void SetBit( uint64_t * out_bitField, size_t bitToSet );
 size_t HashMemory( void const * memory, size_t const memorySize );
 
 template<typename Item>
@@ -76,21 +76,21 @@ AllyShip::AllyShip( NetSender const & sender, NetMessage const & message )
 
 //-------------------------------------------------------------------------------------------------
 //Host Only
-void AllyShip::WriteToMessage( NetMessage * out_message )
+void AllyShip::WriteToBits( BitPacker * out_bits )
 {
-	Ship::WriteToMessage( out_message );
+	Ship::WriteToBits( out_bits );
 
-	Game::WriteUncompressedUint8( out_message, m_allyType );
+	Game::WriteUncompressedUint8( out_bits, m_allyType );
 }
 
 
 //-------------------------------------------------------------------------------------------------
 //Client Only
-void AllyShip::UpdateFromMessage( NetSender const & sender, NetMessage const & message )
+void AllyShip::UpdateFromBits( NetSender const & sender, BitPacker const & bits )
 {
-	Ship::UpdateFromMessage( sender, message );
+	Ship::UpdateFromBits( sender, bits );
 
-	Game::ReadUncompressedUint8( message, (uint8_t*) &m_allyType );
+	Game::ReadUncompressedUint8( bits, (uint8_t*) &m_allyType );
 
 	if( IsCrystal( ) )
 	{
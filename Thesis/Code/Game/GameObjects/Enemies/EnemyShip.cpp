@@ -102,21 +102,21 @@ EnemyShip::EnemyShip( NetSender const & sender, NetMessage const & message )
 
 //-------------------------------------------------------------------------------------------------
 //Host Only
-void EnemyShip::WriteToMessage( NetMessage * out_message )
+void EnemyShip::WriteToBits( BitPacker * out_bits )
 {
-	Ship::WriteToMessage( out_message );
+	Ship::WriteToBits( out_bits );
 
-	Game::WriteUncompressedUint8( out_message, m_enemyCode );
+	Game::WriteUncompressedUint8( out_bits, m_enemyCode );
 }
 
 
 //-------------------------------------------------------------------------------------------------
 //Only Clients would do this, update their copy of the net data
-void EnemyShip::UpdateFromMessage( NetSender const & sender, NetMessage const & message )
+void EnemyShip::UpdateFromBits( NetSender const & sender, BitPacker const & bits )
 {
-	Ship::UpdateFromMessage( sender, message );
+	Ship::UpdateFromBits( sender, bits );
 
-	Game::ReadUncompressedUint8( message, &m_netEnemyCode );
+	Game::ReadUncompressedUint8( bits, &m_netEnemyCode );
 }
 
 
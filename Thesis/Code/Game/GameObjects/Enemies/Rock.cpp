@@ -47,19 +47,19 @@ Rock::Rock( NetSender const & sender, NetMessage const & message )
 
 //-------------------------------------------------------------------------------------------------
 //Host Only
-void Rock::WriteToMessage( NetMessage * out_message )
+void Rock::WriteToBits( BitPacker * out_bits )
 {
-	Game::WriteCompressedPosition( out_message, m_position );
-	Game::WriteUncompressedUint16( out_message, m_health );
+	Game::WriteCompressedPosition( out_bits, m_position );
+	Game::WriteCompressedUint16( out_bits, m_health );
 }
 
 
 //-------------------------------------------------------------------------------------------------
 //Only Clients would do this, update their copy of the net data
-void Rock::UpdateFromMessage( NetSender const & sender, NetMessage const & message )
+void Rock::UpdateFromBits( NetSender const & sender, BitPacker const & bits )
 {
-	Game::ReadCompressedPosition( message, &m_netPosition );
-	Game::ReadUncompressedUint16( message, &m_netHealth );
+	Game::ReadCompressedPosition( bits, &m_netPosition );
+	Game::ReadCompressedUint16( bits, &m_netHealth );
 
 	//I know this isn't currently moving, but in case I want it to move in the future
 	//Predict current location
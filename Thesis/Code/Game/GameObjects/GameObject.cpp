@@ -5,6 +5,7 @@
 #include "Engine/Core/Time.hpp"
 #include "Engine/Net/Session/NetPacket.hpp"
 #include "Engine/Net/Session/NetConnection.hpp"
+#include "Engine/Utils/BitPacker.hpp"
 #include "Engine/Utils/StringUtils.hpp"
 #include "Engine/Utils/XMLUtils.hpp"
 #include "Engine/RenderSystem/SpriteRenderSystem/SpriteGameRenderer.hpp"
@@ -158,20 +159,40 @@ GameObject::~GameObject( )
 
 
 //-------------------------------------------------------------------------------------------------
+// Object state is bit packed, then appended to the message as whole bytes
 void GameObject::WriteToMessage( NetMessage * out_message )
 {
-	Game::WriteCompressedPosition( out_message, m_position );
-	Game::WriteCompressedVelocity( out_message, m_velocity );
-	Game::WriteCompressedRotation( out_message, m_rotationDegrees );
+	byte_t stateBuffer[MAX_NET_STATE_SIZE];
+	BitPacker bits( stateBuffer, MAX_NET_STATE_SIZE );
+	WriteToBits( &bits );
+	out_message->WriteBits( bits );
 }
 
 
 //-------------------------------------------------------------------------------------------------
 void GameObject::UpdateFromMessage( NetSender const & sender, NetMessage const & message )
 {
-	Game::ReadCompressedPosition( message, &m_netPosition );
-	Game::ReadCompressedVelocity( message, &m_velocity );
-	Game::ReadCompressedRotation( message, &m_netRotationDegrees );
+	BitPacker bits = message.GetBitReader( );
+	UpdateFromBits( sender, bits );
+	message.Advance( bits.GetBytesRead( ) );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void GameObject::WriteToBits( BitPacker * out_bits )
+{
+	Game::WriteCompressedPosition( out_bits, m_position );
+	Game::WriteCompressedVelocity( out_bits, m_velocity );
+	Game::WriteCompressedRotation( out_bits, m_rotationDegrees );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void GameObject::UpdateFromBits( NetSender const & sender, BitPacker const & bits )
+{
+	Game::ReadCompressedPosition( bits, &m_netPosition );
+	Game::ReadCompressedVelocity( bits, &m_velocity );
+	Game::ReadCompressedRotation( bits, &m_netRotationDegrees );
 
 	//Move things to where they probably are on the host at this moment in time
 	UpdateNetData( GetElapsedGameTime( sender ) );
@@ -4,6 +4,7 @@
 
 
 //-------------------------------------------------------------------------------------------------
+class BitPacker;
 class GameObject;
 class NetMessage;
 class NetSender;
@@ -38,6 +39,7 @@ public:
 	static byte_t const ENEMY_PLAYER_INDEX = 254;
 	static byte_t const ALLY_PLAYER_INDEX = 253;
 	static float const MAX_TIMEOUT_SECONDS;
+	static size_t const MAX_NET_STATE_SIZE = 64; //Largest bit packed update, in bytes
 	static SoundID * SOUND_HIT;
 	static std::map<hash_t, GameObjectXMLCreationFunc*> * s_registeredGameObjectsXML;
 	static std::map<eNetGameObjectType, GameObjectMessageCreationFunc*> * s_registeredGameObjectsMessage;
@@ -84,8 +86,10 @@ public:
 	GameObject( eNetGameObjectType const & type, bool hostObject );
 	virtual ~GameObject( );
 
-	virtual void WriteToMessage( NetMessage * out_message );
-	virtual void UpdateFromMessage( NetSender const & sender, NetMessage const & message );
+	void WriteToMessage( NetMessage * out_message );
+	void UpdateFromMessage( NetSender const & sender, NetMessage const & message );
+	virtual void WriteToBits( BitPacker * out_bits );
+	virtual void UpdateFromBits( NetSender const & sender, BitPacker const & bits );
 	virtual void WriteToXMLNode( XMLNode * out_xmlNode );
 	virtual void UpdateFromXMLNode( XMLNode const & node );
 	
@@ -43,21 +43,22 @@ Pickup::Pickup( NetSender const & sender, NetMessage const & message )
 
 //-------------------------------------------------------------------------------------------------
 //Host Only
-void Pickup::WriteToMessage( NetMessage * out_message )
+void Pickup::WriteToBits( BitPacker * out_bits )
 {
 	//(8) + (2) = 10 bytes
 	//(4) + (2) = 6 bytes
-	Game::WriteCompressedPosition( out_message, m_position );
-	Game::WriteUncompressedUint16( out_message, m_itemCode );
+	//(30) + (16) = 46 bits = 6 bytes
+	Game::WriteCompressedPosition( out_bits, m_position );
+	Game::WriteUncompressedUint16( out_bits, m_itemCode );
 }
 
 
 //-------------------------------------------------------------------------------------------------
 //Only Clients would do this, update their copy of the net data
-void Pickup::UpdateFromMessage( NetSender const & sender, NetMessage const & message )
+void Pickup::UpdateFromBits( NetSender const & sender, BitPacker const & bits )
 {
-	Game::ReadCompressedPosition( message, &m_netPosition );
-	Game::ReadUncompressedUint16( message, &m_netItemCode );
+	Game::ReadCompressedPosition( bits, &m_netPosition );
+	Game::ReadUncompressedUint16( bits, &m_netItemCode );
 
 	//I know this isn't currently moving, but in case I want it to move in the future
 	//Predict current location
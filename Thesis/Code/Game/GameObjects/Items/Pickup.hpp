@@ -47,8 +47,8 @@ public:
 //-------------------------------------------------------------------------------------------------
 public:
 	Pickup( NetSender const & sender, NetMessage const & message );
-	virtual void WriteToMessage( NetMessage * out_message ) override;
-	virtual void UpdateFromMessage( NetSender const & sender, NetMessage const & message ) override;
+	virtual void WriteToBits( BitPacker * out_bits ) override;
+	virtual void UpdateFromBits( NetSender const & sender, BitPacker const & bits ) override;
 	
 	Pickup( XMLNode const & node );
 	virtual void WriteToXMLNode( XMLNode * out_xmlNode ) override;
@@ -2,6 +2,8 @@
 
 #include "Engine/DebugSystem/ErrorWarningAssert.hpp"
 #include "Game/General/Game.hpp"
+#include "Game/General/InterestGrid.hpp"
+#include "Game/General/SnapshotDelta.hpp"
 #include "Game/GameObjects/GameObject.hpp"
 
 
@@ -13,6 +15,9 @@ STATIC size_t NetGameObject::s_nextNetID = 1;
 NetGameObject::NetGameObject( GameObject * linkedGameObject )
 	: m_netID( s_nextNetID++ )
 	, m_localObject( linkedGameObject )
+	, m_interestProxy( InterestGrid::INVALID_PROXY )
+	, m_snapshotUpdate( nullptr )
+	, m_receivedHistory( nullptr )
 {
 	if( !g_GameSystem->IsHost( ) )
 	{
@@ -25,6 +30,9 @@ NetGameObject::NetGameObject( GameObject * linkedGameObject )
 NetGameObject::NetGameObject( size_t netID, GameObject * linkedGameObject )
 	: m_netID( netID )
 	, m_localObject( linkedGameObject )
+	, m_interestProxy( InterestGrid::INVALID_PROXY )
+	, m_snapshotUpdate( nullptr )
+	, m_receivedHistory( nullptr )
 {
 	//Nothing
 }
@@ -35,6 +43,9 @@ NetGameObject::~NetGameObject( )
 {
 	delete m_localObject;
 	m_localObject = nullptr;
+
+	delete m_receivedHistory;
+	m_receivedHistory = nullptr;
 }
 
 
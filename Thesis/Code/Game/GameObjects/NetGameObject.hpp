@@ -5,6 +5,7 @@
 
 //-------------------------------------------------------------------------------------------------
 class GameObject;
+class SnapshotHistory;
 
 
 //-------------------------------------------------------------------------------------------------
@@ -24,6 +25,11 @@ private:
 	size_t m_netID;
 	GameObject * m_localObject;
 
+public:
+	size_t m_interestProxy; //Handle into the host's InterestGrid
+	NetMessage * m_snapshotUpdate; //Encoded this tick by HostBuildSnapshot, not owned
+	SnapshotHistory * m_receivedHistory; //Client side delta baselines, created on first delta
+
 //-------------------------------------------------------------------------------------------------
 // Functions
 //-------------------------------------------------------------------------------------------------
@@ -46,26 +46,27 @@ Bullet::Bullet( NetSender const & sender, NetMessage const & message )
 
 
 //-------------------------------------------------------------------------------------------------
-void Bullet::WriteToMessage( NetMessage * out_message )
+void Bullet::WriteToBits( BitPacker * out_bits )
 {
 	//(1) + (8) + (8) + (4) + (2) = 23 bytes
 	//(1) + (4) + (4) + (1) + (2) = 12 bytes
-	Game::WriteUncompressedUint8( out_message, m_playerIndex );
-	Game::WriteCompressedPosition( out_message, m_position );
-	Game::WriteCompressedVelocity( out_message, m_velocity );
-	Game::WriteCompressedRotation( out_message, m_rotationDegrees );
-	Game::WriteUncompressedUint16( out_message, m_itemCode );
+	//(8) + (30) + (24) + (9) + (16) = 87 bits = 11 bytes
+	Game::WriteUncompressedUint8( out_bits, m_playerIndex );
+	Game::WriteCompressedPosition( out_bits, m_position );
+	Game::WriteCompressedVelocity( out_bits, m_velocity );
+	Game::WriteCompressedRotation( out_bits, m_rotationDegrees );
+	Game::WriteUncompressedUint16( out_bits, m_itemCode );
 }
 
 
 //-------------------------------------------------------------------------------------------------
-void Bullet::UpdateFromMessage( NetSender const & sender, NetMessage const & message )
+void Bullet::UpdateFromBits( NetSender const & sender, BitPacker const & bits )
 {
-	Game::ReadUncompressedUint8( message, &m_playerIndex );
-	Game::ReadCompressedPosition( message, &m_netPosition );
-	Game::ReadCompressedVelocity( message, &m_netVelocity );
-	Game::ReadCompressedRotation( message, &m_netRotationDegrees );
-	Game::ReadUncompressedUint16( message, &m_netItemCode );
+	Game::ReadUncompressedUint8( bits, &m_playerIndex );
+	Game::ReadCompressedPosition( bits, &m_netPosition );
+	Game::ReadCompressedVelocity( bits, &m_netVelocity );
+	Game::ReadCompressedRotation( bits, &m_netRotationDegrees );
+	Game::ReadUncompressedUint16( bits, &m_netItemCode );
 
 	//Predict current location
 	UpdateNetData( GetElapsedGameTime( sender ) );
@@ -42,21 +42,22 @@ Emote::Emote( NetSender const & sender, NetMessage const & message )
 
 //-------------------------------------------------------------------------------------------------
 //Host Only
-void Emote::WriteToMessage( NetMessage * out_message )
+void Emote::WriteToBits( BitPacker * out_bits )
 {
 	//(8) + (1) = 9 bytes
 	//(4) + (1) = 5 bytes
-	Game::WriteUncompressedUint8( out_message, m_emoteType );
-	Game::WriteCompressedPosition( out_message, m_position );
+	//(8) + (30) = 38 bits = 5 bytes
+	Game::WriteUncompressedUint8( out_bits, m_emoteType );
+	Game::WriteCompressedPosition( out_bits, m_position );
 }
 
 
 //-------------------------------------------------------------------------------------------------
 //Only Clients would do this, update their copy of the net data
-void Emote::UpdateFromMessage( NetSender const & sender, NetMessage const & message )
+void Emote::UpdateFromBits( NetSender const & sender, BitPacker const & bits )
 {
-	Game::ReadUncompressedUint8( message, (uint8_t*) &m_emoteType );
-	Game::ReadCompressedPosition( message, &m_netPosition );
+	Game::ReadUncompressedUint8( bits, (uint8_t*) &m_emoteType );
+	Game::ReadCompressedPosition( bits, &m_netPosition );
 
 	//I know this isn't currently moving, but in case I want it to move in the future
 	//Predict current location
@@ -76,25 +76,25 @@ PlayerShip::PlayerShip( NetSender const & sender, NetMessage const & message )
 
 
 //-------------------------------------------------------------------------------------------------
-void PlayerShip::WriteToMessage( NetMessage * out_message )
+void PlayerShip::WriteToBits( BitPacker * out_bits )
 {
-	Ship::WriteToMessage( out_message );
+	Ship::WriteToBits( out_bits );
 
-	Game::WriteUncompressedUint8( out_message, m_playerIndex );
-	Game::WriteUncompressedUint16( out_message, m_inputBitfieldState );
-	Game::WriteCompressedBoolean( out_message, m_isWarping );
+	Game::WriteUncompressedUint8( out_bits, m_playerIndex );
+	Game::WriteUncompressedUint16( out_bits, m_inputBitfieldState );
+	Game::WriteCompressedBoolean( out_bits, m_isWarping );
 }
 
 
 //-------------------------------------------------------------------------------------------------
 //Client Only
-void PlayerShip::UpdateFromMessage( NetSender const & sender, NetMessage const & message )
+void PlayerShip::UpdateFromBits( NetSender const & sender, BitPacker const & bits )
 {
-	Ship::UpdateFromMessage( sender, message );
+	Ship::UpdateFromBits( sender, bits );
 
-	Game::ReadUncompressedUint8( message, &m_playerIndex );
-	Game::ReadUncompressedUint16( message, &m_netInputBitfieldState );
-	Game::ReadCompressedBoolean( message, &m_netIsWarping );
+	Game::ReadUncompressedUint8( bits, &m_playerIndex );
+	Game::ReadUncompressedUint16( bits, &m_netInputBitfieldState );
+	Game::ReadCompressedBoolean( bits, &m_netIsWarping );
 }
 
 
@@ -83,8 +83,8 @@ public:
 //-------------------------------------------------------------------------------------------------
 public:
 	PlayerShip( NetSender const & sender, NetMessage const & message );
-	virtual void WriteToMessage( NetMessage * out_message ) override;
-	virtual void UpdateFromMessage( NetSender const & sender, NetMessage const & message ) override;
+	virtual void WriteToBits( BitPacker * out_bits ) override;
+	virtual void UpdateFromBits( NetSender const & sender, BitPacker const & bits ) override;
 
 	//PlayerShip( XMLNode const & node );
 	//virtual void WriteToXMLNode( XMLNode * out_xmlNode ) override;
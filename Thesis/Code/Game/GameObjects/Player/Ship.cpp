@@ -38,27 +38,27 @@ STATIC void Ship::Initialize( )
 
 //-------------------------------------------------------------------------------------------------
 //Host Only
-void Ship::WriteToMessage( NetMessage * out_message )
+void Ship::WriteToBits( BitPacker * out_bits )
 {
-	GameObject::WriteToMessage( out_message );
+	GameObject::WriteToBits( out_bits );
 
-	Game::WriteUncompressedUint16( out_message, m_health );
-	Game::WriteUncompressedUint16( out_message, m_shield );
-	Game::WriteUncompressedUint16( out_message, m_energy );
-	Game::WriteCompressedBoolean( out_message, HostIsSlowed( ) );
+	Game::WriteCompressedUint16( out_bits, m_health );
+	Game::WriteCompressedUint16( out_bits, m_shield );
+	Game::WriteCompressedUint16( out_bits, m_energy );
+	Game::WriteCompressedBoolean( out_bits, HostIsSlowed( ) );
 }
 
 
 //-------------------------------------------------------------------------------------------------
 //Client Only
-void Ship::UpdateFromMessage( NetSender const & sender, NetMessage const & message )
+void Ship::UpdateFromBits( NetSender const & sender, BitPacker const & bits )
 {
-	GameObject::UpdateFromMessage( sender, message );
+	GameObject::UpdateFromBits( sender, bits );
 
-	Game::ReadUncompressedUint16( message, &m_netHealth );
-	Game::ReadUncompressedUint16( message, &m_netShield );
-	Game::ReadUncompressedUint16( message, &m_netEnergy );
-	Game::ReadCompressedBoolean( message, &m_netIsSlow );
+	Game::ReadCompressedUint16( bits, &m_netHealth );
+	Game::ReadCompressedUint16( bits, &m_netShield );
+	Game::ReadCompressedUint16( bits, &m_netEnergy );
+	Game::ReadCompressedBoolean( bits, &m_netIsSlow );
 }
 
 
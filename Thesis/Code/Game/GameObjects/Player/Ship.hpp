@@ -65,8 +65,8 @@ protected:
 // Functions
 //-------------------------------------------------------------------------------------------------
 public:
-	virtual void WriteToMessage( NetMessage * out_message ) override;
-	virtual void UpdateFromMessage( NetSender const & sender, NetMessage const & message ) override;
+	virtual void WriteToBits( BitPacker * out_bits ) override;
+	virtual void UpdateFromBits( NetSender const & sender, BitPacker const & bits ) override;
 
 	virtual void WriteToXMLNode( XMLNode * out_xmlNode ) override;
 	virtual void UpdateFromXMLNode( XMLNode const & node ) override;
@@ -0,0 +1,376 @@
+#include "Game/General/BotSwarm.hpp"
+
+#include <algorithm>
+#include "Engine/Core/Time.hpp"
+#include "Engine/DebugSystem/Console.hpp"
+#include "Engine/Net/Session/NetConnection.hpp"
+#include "Engine/Net/Session/NetMessage.hpp"
+#include "Engine/Utils/MathUtils.hpp"
+#include "Engine/Utils/StringUtils.hpp"
+#include "Game/General/Game.hpp"
+#include "Game/General/GameCommon.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC double const BotSwarm::SAMPLE_INTERVAL_SECONDS = 1.0;
+STATIC double const BotSwarm::SHOT_INTERVAL_SECONDS = 0.5;
+
+
+//-------------------------------------------------------------------------------------------------
+// Bots only measure traffic, the game state they're sent is dropped. Full object states are
+// still confirmed like a real client would, or the host never moves them on to deltas.
+static void OnBotMessageReceived( NetSender const & sender, NetMessage const & message )
+{
+	if( message.GetNetMessageType( ) != eNetGameMessageType_NET_OBJECT_DELTA_UPDATE || sender.connection == nullptr )
+	{
+		return;
+	}
+
+	uint32_t netID;
+	uint16_t tick;
+	uint16_t baseTick;
+	Game::ReadUncompressedUint32( message, &netID );
+	Game::ReadUncompressedUint16( message, &tick );
+	Game::ReadUncompressedUint16( message, &baseTick );
+	if( baseTick == tick )
+	{
+		OwnedNetMessage confirm( eNetGameMessageType_NET_OBJECT_BASELINE_CONFIRM );
+		confirm.m_coalesceKey = netID;
+		Game::WriteUncompressedUint32( &confirm, netID );
+		Game::WriteUncompressedUint16( &confirm, tick );
+		sender.connection->AddMessage( confirm );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Reorders samples, fraction 1 is the max
+static double GetPercentile( std::vector<double> & samples, double fraction )
+{
+	if( samples.empty( ) )
+	{
+		return 0.0;
+	}
+
+	size_t rank = (size_t) ( fraction * (double) ( samples.size( ) - 1 ) + 0.5 );
+	std::nth_element( samples.begin( ), samples.begin( ) + rank, samples.end( ) );
+	return samples[rank];
+}
+
+
+//-------------------------------------------------------------------------------------------------
+BotSwarm::BotSwarm( NetSession * hostSession, size_t botCount, double durationSeconds, double joinsPerSecond, char const * csvPath )
+	: m_hostSession( hostSession )
+	, m_targetBotCount( botCount )
+	, m_joinInterval( joinsPerSecond > 0.0 ? 1.0 / joinsPerSecond : 0.0 )
+	, m_startTime( Time::GetCurrentTimeSeconds( ) )
+	, m_endTime( m_startTime + durationSeconds )
+	, m_nextJoinTime( m_startTime )
+	, m_lastSampleTime( m_startTime )
+	, m_failedJoinCount( 0 )
+	, m_finished( false )
+	, m_csvFile( nullptr )
+{
+	m_bots.reserve( botCount );
+
+	errno_t errorSuccess = fopen_s( &m_csvFile, csvPath, "wb" );
+	if( errorSuccess != 0 )
+	{
+		m_csvFile = nullptr;
+		g_ConsoleSystem->AddLog( Stringf( "Bot swarm could not open %s, results go to the console only", csvPath ), Console::BAD );
+		return;
+	}
+
+	fprintf( m_csvFile, "seconds,bots_connected,bots_joining,joins,failed_joins,"
+		"host_tick_p50_ms,host_tick_p95_ms,host_tick_p99_ms,host_tick_max_ms,"
+		"down_bytes_per_sec_per_client,up_bytes_per_sec_per_client,host_resend_ratio,"
+		"join_latency_p50_ms,join_latency_p95_ms\n" );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+BotSwarm::~BotSwarm( )
+{
+	Finish( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// hostTickSeconds is the host's time this frame, its net update plus game simulation
+void BotSwarm::Update( double hostTickSeconds )
+{
+	if( m_finished )
+	{
+		return;
+	}
+
+	double currentTime = Time::GetCurrentTimeSeconds( );
+	m_tickSamples.push_back( hostTickSeconds );
+	m_runTickSamples.push_back( hostTickSeconds );
+
+	//Stagger joins so the join path is measured at a steady rate
+	while( m_bots.size( ) < m_targetBotCount && currentTime >= m_nextJoinTime )
+	{
+		AddBot( currentTime );
+		m_nextJoinTime += m_joinInterval;
+	}
+
+	for( Bot & bot : m_bots )
+	{
+		UpdateBot( bot, currentTime );
+	}
+
+	if( currentTime - m_lastSampleTime >= SAMPLE_INTERVAL_SECONDS )
+	{
+		WriteSample( currentTime );
+	}
+
+	if( currentTime >= m_endTime )
+	{
+		Finish( );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Takes the last partial sample, then every bot leaves
+void BotSwarm::Finish( )
+{
+	if( m_finished )
+	{
+		return;
+	}
+	m_finished = true;
+
+	double currentTime = Time::GetCurrentTimeSeconds( );
+	if( currentTime > m_lastSampleTime )
+	{
+		WriteSample( currentTime );
+	}
+
+	size_t joinedCount = m_runJoinLatencies.size( );
+	g_ConsoleSystem->AddLog( Stringf( "Bot swarm: %u joined, %u failed, host tick p50=%.2fms p95=%.2fms p99=%.2fms, join p50=%.0fms p95=%.0fms",
+		(unsigned int) joinedCount,
+		(unsigned int) m_failedJoinCount,
+		GetPercentile( m_runTickSamples, 0.5 ) * 1000.0,
+		GetPercentile( m_runTickSamples, 0.95 ) * 1000.0,
+		GetPercentile( m_runTickSamples, 0.99 ) * 1000.0,
+		GetPercentile( m_runJoinLatencies, 0.5 ) * 1000.0,
+		GetPercentile( m_runJoinLatencies, 0.95 ) * 1000.0 ), Console::GOOD );
+
+	for( Bot & bot : m_bots )
+	{
+		ReleaseBot( bot );
+	}
+	m_bots.clear( );
+
+	if( m_csvFile )
+	{
+		fclose( m_csvFile );
+		m_csvFile = nullptr;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t BotSwarm::GetConnectedCount( ) const
+{
+	size_t connectedCount = 0;
+	for( Bot const & bot : m_bots )
+	{
+		if( bot.state == eBotState_PLAYING )
+		{
+			++connectedCount;
+		}
+	}
+	return connectedCount;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool BotSwarm::IsFinished( ) const
+{
+	return m_finished;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void BotSwarm::AddBot( double currentTime )
+{
+	Bot bot;
+	bot.session = new NetSession( GAME_VERSION );
+	bot.state = eBotState_JOINING;
+	bot.botIndex = m_bots.size( );
+	bot.joinStartTime = currentTime;
+	bot.nextShotTime = currentTime;
+	bot.lastBytesSent = 0;
+	bot.lastBytesReceived = 0;
+	bot.lastHostResendCount = 0;
+	bot.lastHostReliableSendCount = 0;
+
+	//Same protocol as the game, but none of its handlers or events
+	bot.session->SetBroadcastEvents( false );
+	Game::RegisterGameMessages( bot.session, OnBotMessageReceived );
+
+	sockaddr_in const & hostAddress = m_hostSession->GetSocket( ).GetAddress( );
+	unsigned int port = (unsigned int) ntohs( hostAddress.sin_port ) + FIRST_BOT_PORT_OFFSET + (unsigned int) bot.botIndex;
+	if( bot.session->Start( port, BOT_PORT_RANGE ) )
+	{
+		bot.session->Join( hostAddress, Stringf( "bot%03u", (unsigned int) bot.botIndex ).c_str( ) );
+	}
+	m_bots.push_back( bot );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void BotSwarm::UpdateBot( Bot & bot, double currentTime )
+{
+	if( bot.state == eBotState_LEFT )
+	{
+		return;
+	}
+
+	eNetSessionState sessionState = bot.session->GetState( );
+	if( bot.state == eBotState_JOINING )
+	{
+		if( sessionState == eNetSessionState_CONNECTED )
+		{
+			bot.state = eBotState_PLAYING;
+			m_joinLatencies.push_back( currentTime - bot.joinStartTime );
+			m_runJoinLatencies.push_back( currentTime - bot.joinStartTime );
+
+			//Spread the bots across the good classes
+			eGameEvent chooseClass = (eGameEvent) ( eGameEvent_CHOOSE_CLASS_FIGHTER + bot.botIndex % 3 );
+			OwnedNetMessage classEvent( eNetGameMessageType_RELIABLE_INPUT );
+			classEvent.Write<eGameEvent>( chooseClass );
+			bot.session->GetHost( )->AddMessage( classEvent );
+		}
+		else if( sessionState != eNetSessionState_JOINING )
+		{
+			++m_failedJoinCount;
+			ReleaseBot( bot );
+		}
+		return;
+	}
+
+	if( sessionState != eNetSessionState_CONNECTED )
+	{
+		ReleaseBot( bot );
+		return;
+	}
+
+	//Always thrusting, turning one way then the other, staggered so bots spread over the map
+	uint16_t inputBitfield = 0;
+	SetBit( &inputBitfield, eGameButton_UP );
+	double turnSeconds = 2.0 + (double) ( bot.botIndex % 3 );
+	size_t turnPhase = (size_t) ( ( currentTime - bot.joinStartTime ) / turnSeconds ) + bot.botIndex;
+	SetBit( &inputBitfield, turnPhase % 2 == 0 ? eGameButton_LEFT : eGameButton_RIGHT );
+
+	//Coalesced, so adding it every frame still sends one per packet
+	OwnedNetMessage inputState( eNetGameMessageType_UNRELIABLE_INPUT );
+	inputState.Write<uint16_t>( inputBitfield );
+	bot.session->GetHost( )->AddMessage( inputState );
+
+	if( currentTime >= bot.nextShotTime )
+	{
+		OwnedNetMessage shootEvent( eNetGameMessageType_RELIABLE_INPUT );
+		shootEvent.Write<eGameEvent>( eGameEvent_PRESS_SHOOT );
+		bot.session->GetHost( )->AddMessage( shootEvent );
+		bot.nextShotTime = currentTime + SHOT_INTERVAL_SECONDS;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void BotSwarm::WriteSample( double currentTime )
+{
+	double elapsed = currentTime - m_lastSampleTime;
+	m_lastSampleTime = currentTime;
+
+	size_t connectedCount = 0;
+	size_t joiningCount = 0;
+	size_t bytesDown = 0;
+	size_t bytesUp = 0;
+	size_t hostResends = 0;
+	size_t hostReliableSends = 0;
+	for( Bot & bot : m_bots )
+	{
+		if( bot.state == eBotState_JOINING )
+		{
+			++joiningCount;
+			continue;
+		}
+		if( bot.state != eBotState_PLAYING )
+		{
+			continue;
+		}
+		++connectedCount;
+
+		PacketChannelStats stats = bot.session->GetPacketChannel( ).GetStats( );
+		bytesDown += stats.bytesReceived - bot.lastBytesReceived;
+		bytesUp += stats.bytesSent - bot.lastBytesSent;
+		bot.lastBytesReceived = stats.bytesReceived;
+		bot.lastBytesSent = stats.bytesSent;
+
+		NetConnection * hostSide = m_hostSession->GetNetConnection( bot.session->GetSelf( )->GetIndex( ) );
+		if( hostSide )
+		{
+			hostResends += hostSide->GetResendCount( ) - bot.lastHostResendCount;
+			hostReliableSends += hostSide->GetReliableSendCount( ) - bot.lastHostReliableSendCount;
+			bot.lastHostResendCount = hostSide->GetResendCount( );
+			bot.lastHostReliableSendCount = hostSide->GetReliableSendCount( );
+		}
+	}
+
+	double clientSeconds = elapsed * (double) connectedCount;
+	double downPerClient = clientSeconds > 0.0 ? (double) bytesDown / clientSeconds : 0.0;
+	double upPerClient = clientSeconds > 0.0 ? (double) bytesUp / clientSeconds : 0.0;
+	size_t reliableTotal = hostResends + hostReliableSends;
+	double resendRatio = reliableTotal > 0 ? (double) hostResends / (double) reliableTotal : 0.0;
+
+	if( m_csvFile )
+	{
+		fprintf( m_csvFile, "%.2f,%u,%u,%u,%u,%.3f,%.3f,%.3f,%.3f,%.1f,%.1f,%.4f,%.1f,%.1f\n",
+			currentTime - m_startTime,
+			(unsigned int) connectedCount,
+			(unsigned int) joiningCount,
+			(unsigned int) m_joinLatencies.size( ),
+			(unsigned int) m_failedJoinCount,
+			GetPercentile( m_tickSamples, 0.5 ) * 1000.0,
+			GetPercentile( m_tickSamples, 0.95 ) * 1000.0,
+			GetPercentile( m_tickSamples, 0.99 ) * 1000.0,
+			GetPercentile( m_tickSamples, 1.0 ) * 1000.0,
+			downPerClient,
+			upPerClient,
+			resendRatio,
+			GetPercentile( m_joinLatencies, 0.5 ) * 1000.0,
+			GetPercentile( m_joinLatencies, 0.95 ) * 1000.0 );
+		fflush( m_csvFile );
+	}
+
+	m_tickSamples.clear( );
+	m_joinLatencies.clear( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void BotSwarm::ReleaseBot( Bot & bot )
+{
+	if( bot.session == nullptr )
+	{
+		return;
+	}
+
+	if( bot.session->GetState( ) == eNetSessionState_CONNECTED )
+	{
+		bot.session->Leave( );
+	}
+	if( bot.session->GetState( ) == eNetSessionState_DISCONNECTED )
+	{
+		bot.session->Stop( );
+	}
+
+	delete bot.session;
+	bot.session = nullptr;
+	bot.state = eBotState_LEFT;
+}
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <stdio.h>
+#include <vector>
+#include "Engine/Net/Session/NetSession.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+enum eBotState
+{
+	eBotState_JOINING,
+	eBotState_PLAYING,
+	eBotState_LEFT,
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// One simulated client, a NetSession with no game behind it
+class Bot
+{
+public:
+	NetSession * session;
+	eBotState state;
+	size_t botIndex;
+	double joinStartTime;
+	double nextShotTime;
+
+	//Counters at the last sample, traffic from the bot's socket, resends from the host's side
+	size_t lastBytesSent;
+	size_t lastBytesReceived;
+	size_t lastHostResendCount;
+	size_t lastHostReliableSendCount;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Headless load test. Joins bots to a host in this process over the local address, drives them
+// with scripted input and shots, and writes host tick time, per client bandwidth, resend ratio
+// and join latency to a CSV once a second.
+class BotSwarm
+{
+//-------------------------------------------------------------------------------------------------
+// Static Members
+//-------------------------------------------------------------------------------------------------
+public:
+	static double const SAMPLE_INTERVAL_SECONDS;
+	static double const SHOT_INTERVAL_SECONDS;
+	static unsigned int const FIRST_BOT_PORT_OFFSET = 16; //Bots bind above the host's port
+	static unsigned int const BOT_PORT_RANGE = 64;
+
+//-------------------------------------------------------------------------------------------------
+// Members
+//-------------------------------------------------------------------------------------------------
+private:
+	NetSession * m_hostSession;
+	std::vector<Bot> m_bots;
+	size_t m_targetBotCount;
+	double m_joinInterval;
+	double m_startTime;
+	double m_endTime;
+	double m_nextJoinTime;
+	double m_lastSampleTime;
+	size_t m_failedJoinCount;
+	bool m_finished;
+	FILE * m_csvFile;
+
+	//Reset every sample, the run totals feed the summary
+	std::vector<double> m_tickSamples;
+	std::vector<double> m_joinLatencies;
+	std::vector<double> m_runTickSamples;
+	std::vector<double> m_runJoinLatencies;
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+public:
+	BotSwarm( NetSession * hostSession, size_t botCount, double durationSeconds, double joinsPerSecond, char const * csvPath );
+	~BotSwarm( );
+
+	void Update( double hostTickSeconds );
+	void Finish( );
+
+	size_t GetConnectedCount( ) const;
+	bool IsFinished( ) const;
+
+private:
+	void AddBot( double currentTime );
+	void UpdateBot( Bot & bot, double currentTime );
+	void WriteSample( double currentTime );
+	void ReleaseBot( Bot & bot );
+};
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "Game/General/CatchupStream.hpp"
+
+#include <algorithm>
+#include "Engine/Utils/MathUtils.hpp"
+#include "Game/GameObjects/GameObject.hpp"
+#include "Game/GameObjects/NetGameObject.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+static bool IsFarther( CatchupEntry const & first, CatchupEntry const & second )
+{
+	return first.distanceSquared > second.distanceSquared;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Ships go before anything else, the player needs to see who's around before the rocks
+CatchupStream::CatchupStream( std::vector<NetGameObject*> const & objects, Vector2f const & center, double startTime )
+	: m_completeSent( false )
+	, m_startTime( startTime )
+	, m_sentObjectCount( 0 )
+	, m_messageCount( 0 )
+{
+	m_entries.reserve( objects.size( ) );
+	for( size_t objectIndex = 0; objectIndex < objects.size( ); ++objectIndex )
+	{
+		NetGameObject * netObject = objects[objectIndex];
+		GameObject * object = netObject->GetLocalObject( );
+
+		CatchupEntry entry;
+		entry.netID = netObject->GetID( );
+		entry.netObject = netObject;
+		entry.distanceSquared = DistanceBetweenPointsSquared( center, object->m_position );
+		if( object->m_type == eNetGameObjectType_PLAYERSHIP || object->m_type == eNetGameObjectType_ALLYSHIP )
+		{
+			entry.distanceSquared = 0.f;
+		}
+		m_entries.push_back( entry );
+		m_pendingIDs.insert( entry.netID );
+	}
+
+	std::sort( m_entries.begin( ), m_entries.end( ), IsFarther );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Nearest object still owed, nullptr once everything has been taken
+NetGameObject * CatchupStream::TakeNext( )
+{
+	while( !m_entries.empty( ) )
+	{
+		CatchupEntry entry = m_entries.back( );
+		m_entries.pop_back( );
+		if( IsPending( entry.netID ) )
+		{
+			m_batchIDs.push_back( entry.netID );
+			return entry.netObject;
+		}
+	}
+	return nullptr;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Destroyed before it was sent, the client never hears about it
+void CatchupStream::RemoveObject( size_t netID )
+{
+	m_pendingIDs.erase( netID );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Everything taken since the last batch went out in the message tagged deliveryTag
+void CatchupStream::AddSentMessage( uint32_t deliveryTag )
+{
+	m_sentObjectCount += m_batchIDs.size( );
+	++m_messageCount;
+	m_sentBatches[deliveryTag].swap( m_batchIDs );
+	m_batchIDs.clear( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// The client has this batch, its objects can get updates
+void CatchupStream::ConfirmDelivery( uint32_t deliveryTag )
+{
+	auto found = m_sentBatches.find( deliveryTag );
+	if( found == m_sentBatches.end( ) )
+	{
+		return;
+	}
+
+	std::vector<size_t> const & netIDs = found->second;
+	for( size_t idIndex = 0; idIndex < netIDs.size( ); ++idIndex )
+	{
+		m_pendingIDs.erase( netIDs[idIndex] );
+	}
+	m_sentBatches.erase( found );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void CatchupStream::SetCompleteSent( )
+{
+	m_completeSent = true;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool CatchupStream::IsPending( size_t netID ) const
+{
+	return m_pendingIDs.find( netID ) != m_pendingIDs.end( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Nothing left to send, some of it may not be confirmed yet
+bool CatchupStream::IsFinished( ) const
+{
+	return m_entries.empty( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool CatchupStream::IsCompleteSent( ) const
+{
+	return m_completeSent;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool CatchupStream::IsConfirmed( ) const
+{
+	return m_entries.empty( ) && m_pendingIDs.empty( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+double CatchupStream::GetStartTime( ) const
+{
+	return m_startTime;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t CatchupStream::GetSentObjectCount( ) const
+{
+	return m_sentObjectCount;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t CatchupStream::GetMessageCount( ) const
+{
+	return m_messageCount;
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <vector>
+#include "Engine/Math/Vector2f.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+class NetGameObject;
+
+
+//-------------------------------------------------------------------------------------------------
+class CatchupEntry
+{
+public:
+	size_t netID;
+	NetGameObject * netObject; //Only touched while the ID is still pending
+	float distanceSquared;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// World a newly joined connection still has to be sent. Taken at the join and handed out a few
+// objects at a time, nearest first, so the join doesn't flood the connection's reliables. An
+// object stays pending until the batch creating it is confirmed, updates sent before that could
+// reach the client ahead of the create.
+class CatchupStream
+{
+//-------------------------------------------------------------------------------------------------
+// Members
+//-------------------------------------------------------------------------------------------------
+private:
+	std::vector<CatchupEntry> m_entries; //Farthest first, the next one out is at the back
+	std::set<size_t> m_pendingIDs; //Sent or not, until confirmed. Destroyed objects are dropped from here, their entries are skipped
+	std::vector<size_t> m_batchIDs; //Taken since the last AddSentMessage()
+	std::map<uint32_t, std::vector<size_t>> m_sentBatches; //By delivery tag, until the client has them
+	bool m_completeSent;
+	double m_startTime;
+	size_t m_sentObjectCount;
+	size_t m_messageCount;
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+public:
+	CatchupStream( std::vector<NetGameObject*> const & objects, Vector2f const & center, double startTime );
+
+	NetGameObject * TakeNext( );
+	void RemoveObject( size_t netID );
+	void AddSentMessage( uint32_t deliveryTag );
+	void ConfirmDelivery( uint32_t deliveryTag );
+	void SetCompleteSent( );
+
+	bool IsPending( size_t netID ) const;
+	bool IsFinished( ) const;
+	bool IsCompleteSent( ) const;
+	bool IsConfirmed( ) const;
+	double GetStartTime( ) const;
+	size_t GetSentObjectCount( ) const;
+	size_t GetMessageCount( ) const;
+};
\ No newline at end of file
@@ -18,6 +18,7 @@
 #include "Engine/UISystem/UIProgressBar.hpp"
 #include "Engine/UISystem/UISystem.hpp"
 #include "Engine/UISystem/UITextField.hpp"
+#include "Engine/Utils/BitPacker.hpp"
 #include "Engine/Utils/FileUtils.hpp"
 #include "Engine/Utils/StringUtils.hpp"
 #include "Game/GameObjects/Allies/AllyShip.hpp"
@@ -32,9 +33,12 @@
 #include "Game/GameObjects/Player/PlayerShip.hpp"
 #include "Game/GameObjects/Player/Ship.hpp"
 #include "Game/GameObjects/NetGameObject.hpp"
+#include "Game/General/BotSwarm.hpp"
+#include "Game/General/CatchupStream.hpp"
 #include "Game/General/GameCommon.hpp"
 #include "Game/General/NetMessageHandling.hpp"
 #include "Game/General/SessionCommands.hpp"
+#include "Game/General/SnapshotDelta.hpp"
 
 
 //-------------------------------------------------------------------------------------------------
@@ -46,8 +50,15 @@ STATIC bool Game::s_showHost = false;
 STATIC bool const Game::SHOW_COLLISION = false;
 STATIC Color const Game::HOST_COLOR = Color( 0, 0, 0, 255 ); //Color doesn't exist at static initialization
 STATIC float const Game::MAX_MAP_RADIUS = 80.f;
+STATIC float const Game::INTEREST_CELL_SIZE = 10.f;
+STATIC float const Game::NEAR_PRIORITY_SCALE = 3.f; //Objects on top of the player gain priority 4x as fast as ones at the relevance edge
+STATIC float const Game::OBJECT_UPDATE_BUDGET_FRACTION = 0.75f; //Of a connection's per tick bytes, the rest is left for game state, ships and reliables
+STATIC float const Game::CATCHUP_BUDGET_FRACTION = 0.2f; //Of a connection's per tick bytes, for world creates after a join
+STATIC double const Game::DEFAULT_SIM_RATE = 60.0;
+STATIC uint32_t const Game::DELTA_KEEPALIVE_TICKS = 31; //Unchanged objects are resent about twice a second so clients don't time them out
 STATIC Vector2f const Game::MINIMAP_CENTER( -7.30f, -3.9f );
 STATIC NetSession * Game::s_netSession = nullptr;
+STATIC BotSwarm * Game::s_botSwarm = nullptr;
 STATIC float const Game::NORMAL_VIEW_SCALE = 10.f;
 STATIC float const Game::CTHULHU_VIEW_SCALE = 20.f;
 STATIC float const Game::MAX_AUDIO_DISTANCE = 20.f;
@@ -127,7 +138,12 @@ STATIC char const * Game::BUTTON_EMOTE_HELP_EVENT = "EmoteHelpEvent";
 //-------------------------------------------------------------------------------------------------
 STATIC uint8_t Game::GetSessionIndex( )
 {
-	return s_netSession->GetSelf( )->GetIndex( );
+	uint16_t index = s_netSession->GetSelf( )->GetIndex( );
+	if( index == NetSession::INVALID_INDEX )
+	{
+		return GameObject::INVALID_INDEX;
+	}
+	return (uint8_t) index;
 }
 
 
@@ -261,9 +277,121 @@ STATIC void Game::ReadUncompressedUint32( NetMessage const & message, uint32_t *
 }
 
 
+//-------------------------------------------------------------------------------------------------
+STATIC void Game::WriteCompressedPosition( BitPacker * out_bits, Vector2f const & position )
+{
+	Vector2f positionBounds = Vector2f( MAX_MAP_RADIUS + 10.f, MAX_MAP_RADIUS + 10.f );
+	out_bits->WriteQuantizedVector2f( position, -positionBounds, positionBounds, POSITION_BITS );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC void Game::ReadCompressedPosition( BitPacker const & bits, Vector2f * out_position )
+{
+	Vector2f positionBounds = Vector2f( MAX_MAP_RADIUS + 10.f, MAX_MAP_RADIUS + 10.f );
+	bits.ReadQuantizedVector2f( out_position, -positionBounds, positionBounds, POSITION_BITS );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC void Game::WriteCompressedVelocity( BitPacker * out_bits, Vector2f const & velocity )
+{
+	Vector2f velocityBounds = Vector2f( MAX_SPEED, MAX_SPEED );
+	out_bits->WriteQuantizedVector2f( velocity, -velocityBounds, velocityBounds, VELOCITY_BITS );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC void Game::ReadCompressedVelocity( BitPacker const & bits, Vector2f * out_velocity )
+{
+	Vector2f velocityBounds = Vector2f( MAX_SPEED, MAX_SPEED );
+	bits.ReadQuantizedVector2f( out_velocity, -velocityBounds, velocityBounds, VELOCITY_BITS );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC void Game::WriteCompressedRotation( BitPacker * out_bits, float rotation )
+{
+	out_bits->WriteQuantizedFloat( rotation, 0.f, 360.f, ROTATION_BITS );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC void Game::ReadCompressedRotation( BitPacker const & bits, float * out_rotation )
+{
+	bits.ReadQuantizedFloat( out_rotation, 0.f, 360.f, ROTATION_BITS );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC void Game::WriteCompressedBoolean( BitPacker * out_bits, bool actual )
+{
+	out_bits->WriteBool( actual );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC void Game::ReadCompressedBoolean( BitPacker const & bits, bool * actual )
+{
+	bits.ReadBool( actual );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Varint, stats like health are usually small enough to fit in one byte
+STATIC void Game::WriteCompressedUint16( BitPacker * out_bits, uint16_t data )
+{
+	out_bits->WriteVarUint32( data );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC void Game::ReadCompressedUint16( BitPacker const & bits, uint16_t * out_data )
+{
+	uint32_t data = 0U;
+	bits.ReadVarUint32( &data );
+	*out_data = (uint16_t) data;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC void Game::WriteUncompressedUint8( BitPacker * out_bits, uint8_t data )
+{
+	out_bits->WriteBits( data, 8 );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC void Game::ReadUncompressedUint8( BitPacker const & bits, uint8_t * out_data )
+{
+	uint32_t data = 0U;
+	bits.ReadBits( &data, 8 );
+	*out_data = (uint8_t) data;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC void Game::WriteUncompressedUint16( BitPacker * out_bits, uint16_t data )
+{
+	out_bits->WriteBits( data, 16 );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+STATIC void Game::ReadUncompressedUint16( BitPacker const & bits, uint16_t * out_data )
+{
+	uint32_t data = 0U;
+	bits.ReadBits( &data, 16 );
+	*out_data = (uint16_t) data;
+}
+
+
 //-------------------------------------------------------------------------------------------------
 Game::Game( )
 	: m_numHostPlayers( 0 )
+	, m_snapshotGameState( nullptr )
+	, m_snapshotTick( 0 )
+	, m_interestGrid( MAX_MAP_RADIUS + 10.f, INTEREST_CELL_SIZE )
 	, m_numClientPlayers( 0 )
 	, m_ClientGameActivityLog( "Data/Logs/GameplayActivity_Client.txt" )
 	, m_HostGameActivityLog( "Data/Logs/GameplayActivity_Host.txt" )
@@ -325,6 +453,7 @@ Game::Game( )
 	, m_crystalDestroyed( false )
 	, m_quitNextFrame( false )
 	, m_cameraRotation( 0.f )
+	, m_simScheduler( DEFAULT_SIM_RATE, MAX_SIM_SUBSTEPS )
 	, m_viewSize( NORMAL_VIEW_SCALE )
 	, m_cameraPosition( Vector2f::ZERO )
 {
@@ -351,6 +480,11 @@ Game::~Game( )
 	//This thing has a red squiggly line under it, but that can be ignored. MVS glitch
 	EventSystem::Unregister( this );
 
+	//Bots leave before the host goes away
+	delete s_botSwarm;
+	s_botSwarm = nullptr;
+
+	HostReleaseSnapshot( );
 	CleanupPlayersAndGameObjects( );
 	CleanupSprites( );
 
@@ -375,11 +509,35 @@ void Game::Update( )
 	}
 	UpdateInput( );
 	m_gameState.Update( );
-	UpdateGameObjects( );
+
+	double simulateSeconds = 0.0;
+	if( IsHost( ) )
+	{
+		simulateSeconds = UpdateHostTicks( );
+	}
+	else
+	{
+		//Clients follow the frame, the next host starts a fresh schedule
+		m_simScheduler.Reset( );
+		double simulateStart = Time::GetCurrentTimeSeconds( );
+		UpdateGameObjects( );
+		simulateSeconds = Time::GetCurrentTimeSeconds( ) - simulateStart;
+	}
+
 	UpdateCamera( );
 	UpdateUI( );
 	m_HostGameActivityLog.WriteToFile( );
 	m_ClientGameActivityLog.WriteToFile( );
+
+	if( s_botSwarm )
+	{
+		s_botSwarm->Update( s_netSession->GetLastUpdateSeconds( ) + simulateSeconds );
+		if( s_botSwarm->IsFinished( ) )
+		{
+			delete s_botSwarm;
+			s_botSwarm = nullptr;
+		}
+	}
 }
 
 
@@ -658,6 +816,32 @@ void Game::UpdateGameObjects( )
 }
 
 
+//-------------------------------------------------------------------------------------------------
+// The host steps the simulation at a fixed rate so vsync or a hitch doesn't change its tick or net
+// rate. Returns the seconds spent simulating this frame, zero if no tick was due.
+double Game::UpdateHostTicks( )
+{
+	size_t tickCount = m_simScheduler.Advance( Time::GetCurrentTimeSeconds( ) );
+
+	//Game objects step by the frame delta, hand them the tick instead
+	float frameDeltaSeconds = Time::DELTA_SECONDS;
+	Time::DELTA_SECONDS = (float) m_simScheduler.GetInterval( );
+
+	double simulateSeconds = 0.0;
+	for( size_t tickIndex = 0; tickIndex < tickCount; ++tickIndex )
+	{
+		double tickStart = Time::GetCurrentTimeSeconds( );
+		UpdateGameObjects( );
+		double tickSeconds = Time::GetCurrentTimeSeconds( ) - tickStart;
+		m_simScheduler.RecordTick( tickSeconds );
+		simulateSeconds += tickSeconds;
+	}
+
+	Time::DELTA_SECONDS = frameDeltaSeconds;
+	return simulateSeconds;
+}
+
+
 //-------------------------------------------------------------------------------------------------
 //#TODO: Make this much faster
 Vector2f CalcScreenPosition( Vector2f const & shipPosition )
@@ -1705,70 +1889,121 @@ void Game::SetupSpriteRenderer( )
 }
 
 
+//-------------------------------------------------------------------------------------------------
+static MessageCallback * PickCallback( MessageCallback * gameCallback, MessageCallback * replaceCallback )
+{
+	return replaceCallback ? replaceCallback : gameCallback;
+}
+
+
 //-------------------------------------------------------------------------------------------------
 void Game::SetupNetSession( )
 {
 	s_netSession = new NetSession( GAME_VERSION );
+	RegisterGameMessages( s_netSession, nullptr );
+
+	//Player indices are connection indices, a byte that has to stay under GameObject's reserved indices
+	s_netSession->SetConnectionLimit( (uint16_t) MAX_PLAYERS );
+
+	// NetSession Events
+	EventSystem::RegisterEvent( NetSession::ON_CONNECTION_JOIN_EVENT, this, &Game::OnConnectionJoin );
+	EventSystem::RegisterEvent( NetSession::ON_CONNECTION_LEAVE_EVENT, this, &Game::OnConnectionLeave );
+	EventSystem::RegisterEvent( NetSession::PREPARE_SNAPSHOT_EVENT, this, &Game::OnPrepareSnapshot );
+	EventSystem::RegisterEvent( NetSession::PREPARE_PACKET_EVENT, this, &Game::OnPreparePacket );
+	EventSystem::RegisterEvent( NetSession::FINISH_SNAPSHOT_EVENT, this, &Game::OnFinishSnapshot );
+	EventSystem::RegisterEvent( NetSession::ON_GAME_JOIN_VALIDATION_EVENT, this, &Game::OnJoinRequestValidation );
+	EventSystem::RegisterEvent( NetSession::ON_JOIN_DENY_EVENT, this, &Game::OnJoinDeny );
+
+	// Start session, check port range (default = 8)
+	s_netSession->Start( NetworkSystem::GAME_PORT );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Bots and other sessions that only need to speak the protocol pass replaceCallback to skip the game handlers
+STATIC void Game::RegisterGameMessages( NetSession * session, MessageCallback * replaceCallback )
+{
 	byte_t optionFlags, channel;
 
 	// Create Player Message
 	// Connection Required, Reliable, Sequence
 	optionFlags = NetMessageDefinition::RELIABLE_OPTION_FLAG | NetMessageDefinition::SEQUENCE_OPTION_FLAG;
 	channel = CREATE_DESTROY_CHANNEL;
-	s_netSession->RegisterMessage( (eNetMessageType) eNetGameMessageType_NET_PLAYER_CREATE, OnCreatePlayerReceived, 0, optionFlags, channel );
+	session->RegisterMessage( (eNetMessageType) eNetGameMessageType_NET_PLAYER_CREATE, PickCallback( OnCreatePlayerReceived, replaceCallback ), 0, optionFlags, channel );
 
 	// Destroy Player Message
 	// Connection Required, Reliable, Sequence
 	optionFlags = NetMessageDefinition::RELIABLE_OPTION_FLAG | NetMessageDefinition::SEQUENCE_OPTION_FLAG;
 	channel = CREATE_DESTROY_CHANNEL;
-	s_netSession->RegisterMessage( (eNetMessageType) eNetGameMessageType_NET_PLAYER_DESTROY, OnDestroyPlayerReceived, 0, optionFlags, channel );
+	session->RegisterMessage( (eNetMessageType) eNetGameMessageType_NET_PLAYER_DESTROY, PickCallback( OnDestroyPlayerReceived, replaceCallback ), 0, optionFlags, channel );
 
 	// Update Player Message
 	// Connection Required, Reliable, Sequence
 	optionFlags = NetMessageDefinition::RELIABLE_OPTION_FLAG | NetMessageDefinition::SEQUENCE_OPTION_FLAG;
 	channel = UPDATE_CHANNEL;
-	s_netSession->RegisterMessage( (eNetMessageType) eNetGameMessageType_NET_PLAYER_UPDATE, OnUpdatePlayerReceived, 0, optionFlags, channel );
+	session->RegisterMessage( (eNetMessageType) eNetGameMessageType_NET_PLAYER_UPDATE, PickCallback( OnUpdatePlayerReceived, replaceCallback ), 0, optionFlags, channel );
 
 	// Create Objects Message
 	// Connection Required, Reliable, Sequence
 	optionFlags = NetMessageDefinition::RELIABLE_OPTION_FLAG | NetMessageDefinition::SEQUENCE_OPTION_FLAG;
 	channel = CREATE_DESTROY_CHANNEL;
-	s_netSession->RegisterMessage( (eNetMessageType) eNetGameMessageType_NET_OBJECT_CREATE, OnCreateMessageReceived, 0, optionFlags, channel );
+	session->RegisterMessage( (eNetMessageType) eNetGameMessageType_NET_OBJECT_CREATE, PickCallback( OnCreateMessageReceived, replaceCallback ), 0, optionFlags, channel );
 
 	// Destroy Objects Message
 	// Connection Required, Reliable, Sequence
 	optionFlags = NetMessageDefinition::RELIABLE_OPTION_FLAG | NetMessageDefinition::SEQUENCE_OPTION_FLAG;
 	channel = CREATE_DESTROY_CHANNEL;
-	s_netSession->RegisterMessage( (eNetMessageType) eNetGameMessageType_NET_OBJECT_DESTROY, OnDestroyMessageReceived, 0, optionFlags, channel );
+	session->RegisterMessage( (eNetMessageType) eNetGameMessageType_NET_OBJECT_DESTROY, PickCallback( OnDestroyMessageReceived, replaceCallback ), 0, optionFlags, channel );
 
 	// Update Objects Message
-	// Connection Required, Unreliable, Sequence
+	// Connection Required, Unreliable, Sequence, Coalesced by net ID
 	//CURRENT NOT SEQUENCED
-	s_netSession->RegisterMessage( (eNetMessageType) eNetGameMessageType_NET_OBJECT_UPDATE, OnUpdateMessageReceived, 0, 0 );
+	optionFlags = NetMessageDefinition::COALESCE_OPTION_FLAG;
+	session->RegisterMessage( (eNetMessageType) eNetGameMessageType_NET_OBJECT_UPDATE, PickCallback( OnUpdateMessageReceived, replaceCallback ), 0, optionFlags );
+
+	// Delta Update Objects Message
+	// Connection Required, Unreliable, Coalesced by net ID
+	// Not sequenced, every delta has to be stored even if it arrives late
+	optionFlags = NetMessageDefinition::COALESCE_OPTION_FLAG;
+	session->RegisterMessage( (eNetMessageType) eNetGameMessageType_NET_OBJECT_DELTA_UPDATE, PickCallback( OnDeltaUpdateMessageReceived, replaceCallback ), 0, optionFlags );
 
 	// Update Game State Message
-	// Connection Required, Unreliable, Sequence
+	// Connection Required, Unreliable, Sequence, High Priority, Coalesced
 	//CURRENT NOT SEQUENCED
-	s_netSession->RegisterMessage( (eNetMessageType) eNetGameMessageType_GAME_STATE_UPDATE, OnGameStateMessageReceived, 0, 0 );
+	optionFlags = NetMessageDefinition::COALESCE_OPTION_FLAG;
+	session->RegisterMessage( (eNetMessageType) eNetGameMessageType_GAME_STATE_UPDATE, PickCallback( OnGameStateMessageReceived, replaceCallback ), 0, optionFlags, 0, eNetMessagePriority_HIGH );
 
 	// Update Reliable Input
 	// Connection Required, Reliable
 	optionFlags = NetMessageDefinition::RELIABLE_OPTION_FLAG;
-	s_netSession->RegisterMessage( (eNetMessageType) eNetGameMessageType_RELIABLE_INPUT, OnInputMessageReceived, 0, optionFlags );
+	session->RegisterMessage( (eNetMessageType) eNetGameMessageType_RELIABLE_INPUT, PickCallback( OnInputMessageReceived, replaceCallback ), 0, optionFlags );
 
 	// Update Unreliable Input
-	// Connection Required
-	s_netSession->RegisterMessage( (eNetMessageType) eNetGameMessageType_UNRELIABLE_INPUT, OnInputMessageReceived, 0, 0 );
+	// Connection Required, High Priority, Coalesced
+	optionFlags = NetMessageDefinition::COALESCE_OPTION_FLAG;
+	session->RegisterMessage( (eNetMessageType) eNetGameMessageType_UNRELIABLE_INPUT, PickCallback( OnInputMessageReceived, replaceCallback ), 0, optionFlags, 0, eNetMessagePriority_HIGH );
 
-	// NetSession Events
-	EventSystem::RegisterEvent( NetSession::ON_CONNECTION_JOIN_EVENT, this, &Game::OnConnectionJoin );
-	EventSystem::RegisterEvent( NetSession::ON_CONNECTION_LEAVE_EVENT, this, &Game::OnConnectionLeave );
-	EventSystem::RegisterEvent( NetSession::PREPARE_PACKET_EVENT, this, &Game::OnPreparePacket );
-	EventSystem::RegisterEvent( NetSession::ON_GAME_JOIN_VALIDATION_EVENT, this, &Game::OnJoinRequestValidation );
-	EventSystem::RegisterEvent( NetSession::ON_JOIN_DENY_EVENT, this, &Game::OnJoinDeny );
+	// Create Objects Batch Message
+	// Connection Required, Reliable, Sequence, in order with single creates and destroys
+	optionFlags = NetMessageDefinition::RELIABLE_OPTION_FLAG | NetMessageDefinition::SEQUENCE_OPTION_FLAG;
+	channel = CREATE_DESTROY_CHANNEL;
+	session->RegisterMessage( (eNetMessageType) eNetGameMessageType_NET_OBJECT_CREATE_BATCH, PickCallback( OnCreateBatchReceived, replaceCallback ), 0, optionFlags, channel );
 
-	// Start session, check port range (default = 8)
-	s_netSession->Start( NetworkSystem::GAME_PORT );
+	// Catchup Complete Message
+	// Connection Required, Reliable, Sequence, after the last batch
+	optionFlags = NetMessageDefinition::RELIABLE_OPTION_FLAG | NetMessageDefinition::SEQUENCE_OPTION_FLAG;
+	channel = CREATE_DESTROY_CHANNEL;
+	session->RegisterMessage( (eNetMessageType) eNetGameMessageType_NET_CATCHUP_COMPLETE, PickCallback( OnCatchupCompleteReceived, replaceCallback ), 0, optionFlags, channel );
+
+	// Baseline Confirm Message
+	// Connection Required, Unreliable, Coalesced by net ID, the next full state confirms again if lost
+	optionFlags = NetMessageDefinition::COALESCE_OPTION_FLAG;
+	session->RegisterMessage( (eNetMessageType) eNetGameMessageType_NET_OBJECT_BASELINE_CONFIRM, PickCallback( OnBaselineConfirmReceived, replaceCallback ), 0, optionFlags );
+
+	// Baseline Miss Message
+	// Connection Required, Unreliable, Coalesced by net ID, the next delta misses again if lost
+	optionFlags = NetMessageDefinition::COALESCE_OPTION_FLAG;
+	session->RegisterMessage( (eNetMessageType) eNetGameMessageType_NET_OBJECT_BASELINE_MISS, PickCallback( OnBaselineMissReceived, replaceCallback ), 0, optionFlags );
 }
 
 
@@ -1819,6 +2054,8 @@ void Game::SetupTextRenderers( )
 		m_numClientPlayers = 0;
 		m_hostPlayers[playerIndex] = nullptr;
 		m_clientPlayers[playerIndex] = nullptr;
+		m_hostBaselines[playerIndex] = nullptr;
+		m_hostCatchups[playerIndex] = nullptr;
 	}
 }
 
@@ -1835,6 +2072,11 @@ void Game::CleanupPlayersAndGameObjects( )
 			m_hostPlayers[playerIndex] = nullptr;
 		}
 
+		delete m_hostBaselines[playerIndex];
+		m_hostBaselines[playerIndex] = nullptr;
+		delete m_hostCatchups[playerIndex];
+		m_hostCatchups[playerIndex] = nullptr;
+
 		if( m_clientPlayers[playerIndex] )
 		{
 			delete m_clientPlayers[playerIndex];
@@ -1850,6 +2092,7 @@ void Game::CleanupPlayersAndGameObjects( )
 		m_hostObjects[objectIndex] = nullptr;
 	}
 	m_hostObjects.clear( );
+	m_interestGrid.Clear( );
 
 	for( size_t objectIndex = 0; objectIndex < m_clientObjects.size( ); ++objectIndex )
 	{
@@ -1,15 +1,20 @@
 #pragma once
 
 #include <vector>
+#include "Engine/Core/TickScheduler.hpp"
 #include "Engine/DebugSystem/DebugLog.hpp"
 #include "Engine/Math/Vector2f.hpp"
 #include "Engine/Net/Session/NetSession.hpp"
 #include "Game/GameObjects/Player/Player.hpp"
 #include "Game/General/GameCommon.hpp"
 #include "Game/General/GameState.hpp"
+#include "Game/General/InterestGrid.hpp"
+#include "Game/General/SnapshotDelta.hpp"
 
 
 //-------------------------------------------------------------------------------------------------
+class BitPacker;
+class BotSwarm;
 class Command;
 class EnemyShip;
 class Game;
@@ -23,6 +28,8 @@ class NetSession;
 class Player;
 class Ship;
 class ShipSpawner;
+class ConnectionBaselines;
+class CatchupStream;
 class Sprite;
 class TextRenderer;
 class UIBox;
@@ -53,8 +60,18 @@ public:
 	static bool const SHOW_COLLISION;
 	static Color const HOST_COLOR;
 	static float const MAX_MAP_RADIUS;
+	static float const INTEREST_CELL_SIZE;
+	static float const NEAR_PRIORITY_SCALE;
+	static float const OBJECT_UPDATE_BUDGET_FRACTION;
+	static float const CATCHUP_BUDGET_FRACTION;
+	static size_t const CATCHUP_MAX_UNSENT_RELIABLES = 8; //Past this the stream waits for the connection to drain
+	static size_t const CATCHUP_BATCH_SIZE = 512; //Payload bytes per create batch, well under OwnedNetMessage::MAX_SIZE
+	static uint32_t const DELTA_KEEPALIVE_TICKS;
+	static double const DEFAULT_SIM_RATE;
+	static size_t const MAX_SIM_SUBSTEPS = 4; //Catch up after a hitch, past this the host just falls behind
 	static Vector2f const MINIMAP_CENTER;
 	static NetSession * s_netSession;
+	static BotSwarm * s_botSwarm; //Load test bots, only while one is running
 	static byte_t const CREATE_DESTROY_CHANNEL = 1;
 	static byte_t const UPDATE_CHANNEL = 2;
 	static byte_t const INPUT_CHANNEL = 3;
@@ -62,6 +79,9 @@ public:
 	static float const CTHULHU_VIEW_SCALE;
 	static float const MAX_AUDIO_DISTANCE;
 	static float const MAX_SPEED;
+	static size_t const POSITION_BITS = 15; //Per axis, ~0.005 units across the map
+	static size_t const VELOCITY_BITS = 12; //Per axis
+	static size_t const ROTATION_BITS = 9; //~0.7 degrees
 	static int const CULTIST_SPAWN_COUNT = 4;
 
 	static char const * STRING_WORLD_DATA;
@@ -139,6 +159,7 @@ public:
 //-------------------------------------------------------------------------------------------------
 public:
 	static uint8_t GetSessionIndex( );
+	static void RegisterGameMessages( NetSession * session, MessageCallback * replaceCallback );
 	static void WriteCompressedPosition( NetMessage * out_message, Vector2f const & position );
 	static void ReadCompressedPosition( NetMessage const & message, Vector2f * out_position );
 	static void WriteCompressedVelocity( NetMessage * out_message, Vector2f const & velocity );
@@ -155,6 +176,20 @@ public:
 	static void ReadUncompressedUint16( NetMessage const & message, uint16_t * out_data );
 	static void WriteUncompressedUint32( NetMessage * out_message, uint32_t data );
 	static void ReadUncompressedUint32( NetMessage const & message, uint32_t * out_data );
+	static void WriteCompressedPosition( BitPacker * out_bits, Vector2f const & position );
+	static void ReadCompressedPosition( BitPacker const & bits, Vector2f * out_position );
+	static void WriteCompressedVelocity( BitPacker * out_bits, Vector2f const & velocity );
+	static void ReadCompressedVelocity( BitPacker const & bits, Vector2f * out_velocity );
+	static void WriteCompressedRotation( BitPacker * out_bits, float rotation );
+	static void ReadCompressedRotation( BitPacker const & bits, float * out_rotation );
+	static void WriteCompressedBoolean( BitPacker * out_bits, bool actual );
+	static void ReadCompressedBoolean( BitPacker const & bits, bool * actual );
+	static void WriteCompressedUint16( BitPacker * out_bits, uint16_t data );
+	static void ReadCompressedUint16( BitPacker const & bits, uint16_t * out_data );
+	static void WriteUncompressedUint8( BitPacker * out_bits, uint8_t data );
+	static void ReadUncompressedUint8( BitPacker const & bits, uint8_t * out_data );
+	static void WriteUncompressedUint16( BitPacker * out_bits, uint16_t data );
+	static void ReadUncompressedUint16( BitPacker const & bits, uint16_t * out_data );
 
 //-------------------------------------------------------------------------------------------------
 // Members
@@ -167,6 +202,28 @@ private:
 	Player * m_hostPlayers[MAX_PLAYERS];
 	size_t m_numHostPlayers;
 
+	//Host snapshot, encoded once per send tick and shared by every connection
+	NetMessage * m_snapshotGameState;
+	std::vector<NetGameObject*> m_snapshotShips;
+	std::vector<NetMessage*> m_snapshotObjects;
+	std::vector<NetGameObject*> m_snapshotAlwaysRelevant;
+	uint32_t m_snapshotTick;
+
+	//Host delta baselines, per connection
+	ConnectionBaselines * m_hostBaselines[MAX_PLAYERS];
+	std::vector<uint32_t> m_confirmedDeliveryTags;
+
+	//Host player syncs are written here, they can outgrow one NetMessage
+	std::vector<byte_t> m_hostSyncBuffer;
+
+	//Host world still owed to newly joined connections
+	CatchupStream * m_hostCatchups[MAX_PLAYERS];
+
+	//Host relevance filtering
+	InterestGrid m_interestGrid;
+	std::vector<void*> m_interestResults;
+	std::vector<UpdateCandidate> m_updateCandidates;
+
 	std::vector<NetGameObject*> m_clientObjects;
 	Player * m_clientPlayers[MAX_PLAYERS];
 	size_t m_numClientPlayers;
@@ -247,6 +304,7 @@ public:
 	bool m_crystalDestroyed;
 	bool m_quitNextFrame;
 	float m_cameraRotation;
+	TickScheduler m_simScheduler; //Host simulation, fixed rate on the real clock
 
 private:
 	//Used to calculate audio attenuation
@@ -262,6 +320,7 @@ public:
 	void Update( );
 	void UpdateInput( );
 	void UpdateGameObjects( );
+	double UpdateHostTicks( );
 	void UpdateCamera( );
 	void UpdatePlayers( );
 	void UpdateUI( );
@@ -298,7 +357,9 @@ private:
 public:
 	void OnConnectionJoin( NamedProperties & );
 	void OnConnectionLeave( NamedProperties & );
+	void OnPrepareSnapshot( NamedProperties & );
 	void OnPreparePacket( NamedProperties & );
+	void OnFinishSnapshot( NamedProperties & );
 	void OnJoinRequestValidation( NamedProperties & );
 	void OnJoinDeny( NamedProperties & );
 	void OnDedicatedHostButton( NamedProperties & );
@@ -338,6 +399,7 @@ public:
 	std::vector<Player*> HostGetActivePlayers( ) const;
 	Player * HostGetPlayerForPlayerShip( PlayerShip const * playerShip ) const;
 	void HostUpdatePlayer( byte_t playerIndex );
+	void HostSendPlayerUpdate( NetConnection * connection, byte_t playerIndex );
 	void HostAddLevelToPlayer( byte_t playerIndex );
 	bool HostAddItemToPlayer( Player * player, uint16_t itemCode );
 	void HostApplyInputEventToPlayer( eGameEvent const & inputEvent, byte_t playerIndex );
@@ -375,6 +437,15 @@ public:
 
 	//Host Generic
 	void HostCatchupConnectionOnCurrentGameState( NetConnection * conn );
+	void HostUpdateCatchup( NetConnection * connection );
+	bool HostIsCatchupPending( NetConnection * connection, size_t netID ) const;
+	void HostBuildSnapshot( );
+	void HostReleaseSnapshot( );
+	float HostGetRelevanceRadius( eNetGameObjectType const & type ) const;
+	float HostGetUpdatePriority( eNetGameObjectType const & type ) const;
+	ConnectionBaselines * HostGetBaselines( NetConnection * connection );
+	void HostConfirmDeliveries( NetConnection * connection );
+	size_t HostAddObjectUpdate( NetConnection * connection, NetGameObject * netObject );
 	void HostCheckCollisions( NetGameObject * object );
 	float HostGetClosestGameObjectWithinDegrees( GameObject const * fromObject, float withinDegrees, GameObject ** out_foundGameObject );
 	float HostGetClosestGoodShip( Vector2f const & position, Ship ** out_foundShip );
@@ -7,8 +7,11 @@ typedef unsigned char byte_t;
 
 
 //-------------------------------------------------------------------------------------------------
-#define GAME_VERSION 12
+#define GAME_VERSION 15
 /* Version Log
+15: Paced, batched world catch-up on join
+14: Bit packed object updates
+13: Delta compressed object updates
 12: Community Playtest
 11: Thesis Playtest
 10: Updated UI
@@ -142,6 +145,11 @@ enum eNetGameMessageType : byte_t
 	eNetGameMessageType_GAME_STATE_UPDATE,
 	eNetGameMessageType_RELIABLE_INPUT,
 	eNetGameMessageType_UNRELIABLE_INPUT,
+	eNetGameMessageType_NET_OBJECT_DELTA_UPDATE,
+	eNetGameMessageType_NET_OBJECT_CREATE_BATCH,
+	eNetGameMessageType_NET_CATCHUP_COMPLETE,
+	eNetGameMessageType_NET_OBJECT_BASELINE_CONFIRM,
+	eNetGameMessageType_NET_OBJECT_BASELINE_MISS,
 };
 
 
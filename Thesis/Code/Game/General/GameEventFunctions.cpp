@@ -1,8 +1,11 @@
 #include "Game/General/Game.hpp"
 
+#include <algorithm>
+#include "Engine/Core/Engine.hpp"
 #include "Engine/Core/NamedProperties.hpp"
 #include "Engine/Core/Time.hpp"
 #include "Engine/Net/Session/NetConnection.hpp"
+#include "Engine/Net/Session/RateController.hpp"
 #include "Engine/RenderSystem/SpriteRenderSystem/SpriteGameRenderer.hpp"
 #include "Engine/UISystem/UIContainer.hpp"
 #include "Engine/UISystem/UIItem.hpp"
@@ -27,7 +30,7 @@ void Game::OnConnectionJoin( NamedProperties & netEvent )
 		if( ( connection->IsHost( ) && !m_isDedicatedServer ) ||
 			!connection->IsHost( ) )
 		{
-			HostCreatePlayer( connection->GetIndex( ), connection->GetUsername( ), connection->GetPassword( ) );
+			HostCreatePlayer( (byte_t) connection->GetIndex( ), connection->GetUsername( ), connection->GetPassword( ) );
 
 			//Send back all other objects that exist
 			if( !connection->IsHost( ) )
@@ -61,7 +64,7 @@ void Game::OnConnectionLeave( NamedProperties & netEvent )
 
 	if( IsHost( ) && !m_isDedicatedServer )
 	{
-		HostDestroyPlayer( connection->GetIndex( ) );
+		HostDestroyPlayer( (byte_t) connection->GetIndex( ) );
 	}
 
 	//The host and self is disconnected seperately (if they're the same)
@@ -79,6 +82,10 @@ void Game::OnConnectionLeave( NamedProperties & netEvent )
 
 	if( IsHost( ) )
 	{
+		delete m_hostBaselines[connection->GetIndex( )];
+		m_hostBaselines[connection->GetIndex( )] = nullptr;
+		delete m_hostCatchups[connection->GetIndex( )];
+		m_hostCatchups[connection->GetIndex( )] = nullptr;
 		m_HostGameActivityLog.Printf( "%s (index=%u) Disconnected", connection->GetUsername( ), connection->GetIndex( ) );
 	}
 	else
@@ -88,6 +95,23 @@ void Game::OnConnectionLeave( NamedProperties & netEvent )
 }
 
 
+//-------------------------------------------------------------------------------------------------
+static bool IsHigherPriority( UpdateCandidate const & first, UpdateCandidate const & second )
+{
+	return first.history->m_sendPriority > second.history->m_sendPriority;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void Game::OnPrepareSnapshot( NamedProperties & )
+{
+	if( IsHost( ) )
+	{
+		HostBuildSnapshot( );
+	}
+}
+
+
 //-------------------------------------------------------------------------------------------------
 void Game::OnPreparePacket( NamedProperties & netEvent )
 {
@@ -107,87 +131,107 @@ void Game::OnPreparePacket( NamedProperties & netEvent )
 		if( currentPlayer )
 		{
 			//Send Input State
-			NetMessage inputState( eNetGameMessageType_UNRELIABLE_INPUT );
+			OwnedNetMessage inputState( eNetGameMessageType_UNRELIABLE_INPUT );
 			inputState.Write<uint16_t>( currentPlayer->GetInputBitfield( ) );
 			connection->AddMessage( inputState );
 		}
 	}
 
 	// Then send host info, because if we're host/client we need to make sure our input is sent
+	// Everything here was encoded once in HostBuildSnapshot, object updates are then delta'd per connection
 	if( IsHost( ) )
 	{
-		NetMessage gameStateUpdate( eNetGameMessageType_GAME_STATE_UPDATE );
-		m_gameState.WriteToMessage( &gameStateUpdate );
-		connection->AddMessage( gameStateUpdate );
+		if( m_snapshotGameState == nullptr )
+		{
+			return;
+		}
+
+		connection->AddMessage( *m_snapshotGameState );
+		HostConfirmDeliveries( connection );
+
+		//Rest of the world for a connection that just joined, with its own slice of the budget
+		HostUpdateCatchup( connection );
 
 		//Sync ships first
-		for( size_t playerIndex = 0; playerIndex < MAX_PLAYERS; ++playerIndex )
+		for( size_t shipIndex = 0; shipIndex < m_snapshotShips.size( ); ++shipIndex )
+		{
+			HostAddObjectUpdate( connection, m_snapshotShips[shipIndex] );
+		}
+
+		//Always sync Crystal
+		for( size_t objectIndex = 0; objectIndex < m_snapshotAlwaysRelevant.size( ); ++objectIndex )
+		{
+			HostAddObjectUpdate( connection, m_snapshotAlwaysRelevant[objectIndex] );
+		}
+
+		//Only sync players that exist
+		size_t currentIndex = connection->GetIndex( );
+		Player * checkPlayer = m_hostPlayers[currentIndex];
+		if( checkPlayer == nullptr )
+		{
+			return;
+		}
+
+		//Sync things that are not ships, only the ones in nearby cells are checked
+		//Each relevant object's priority grows every tick it waits, so near objects go first and far ones still get their turn
+		ConnectionBaselines * baselines = HostGetBaselines( connection );
+		Vector2f curretPlayerPosition = checkPlayer->GetLastPosition( );
+		float queryRadius = HostGetRelevanceRadius( eNetGameObjectType_ENEMYSHIP ); //Largest relevance radius
+		m_interestResults.clear( );
+		m_updateCandidates.clear( );
+		m_interestGrid.Query( curretPlayerPosition, queryRadius, &m_interestResults );
+		for( size_t resultIndex = 0; resultIndex < m_interestResults.size( ); ++resultIndex )
 		{
-			if( m_hostPlayers[playerIndex] == nullptr )
+			NetGameObject * netObject = (NetGameObject*) m_interestResults[resultIndex];
+			GameObject * object = netObject->GetLocalObject( );
+			if( netObject->m_snapshotUpdate == nullptr || object->m_type == eNetGameObjectType_ALLYSHIP )
 			{
 				continue;
 			}
-			if( m_hostPlayers[playerIndex]->m_localShip == nullptr )
+
+			float relevanceRadius = HostGetRelevanceRadius( object->m_type );
+			float distanceSquared = DistanceBetweenPointsSquared( curretPlayerPosition, object->m_position );
+			if( distanceSquared > ( relevanceRadius * relevanceRadius ) )
 			{
 				continue;
 			}
 
-			//Send all ships
-			NetMessage update( eNetGameMessageType_NET_OBJECT_UPDATE );
-			NetGameObject * netShip = m_hostPlayers[playerIndex]->m_localShip;
-			netShip->WriteToMessage( &update );
-			connection->AddMessage( update );
+			float nearness = 1.f - sqrtf( distanceSquared ) / relevanceRadius;
+			UpdateCandidate candidate;
+			candidate.netObject = netObject;
+			candidate.history = &baselines->GetHistory( netObject->GetID( ) );
+			candidate.history->m_sendPriority += HostGetUpdatePriority( object->m_type ) * ( 1.f + NEAR_PRIORITY_SCALE * nearness );
+			m_updateCandidates.push_back( candidate );
 		}
-		//Sync things that are not ships
-		for( size_t objectIndex = 0; objectIndex < m_hostObjects.size( ); ++objectIndex )
-		{
-			//Sync bullets / enemies
-			//Only sync if they're close
-			//#TODO: Make sure to make this is flexible when more entities need to get networked
-			GameObject * object = m_hostObjects[objectIndex]->GetLocalObject( );
-			if( object->m_type == eNetGameObjectType_BULLET ||
-				object->m_type == eNetGameObjectType_ENEMYSHIP ||
-				object->m_type == eNetGameObjectType_ROCK )
-			{
-				size_t currentIndex = connection->GetIndex( );
-				Player * checkPlayer = m_hostPlayers[currentIndex];
-				//Only sync players that exist
-				if( checkPlayer == nullptr )
-				{
-					continue;
-				}
-				Vector2f curretPlayerPosition = checkPlayer->GetLastPosition( );
-				float maxDistance = g_SpriteRenderSystem->GetVirtualSize( );
-				if( DistanceBetweenPointsSquared( curretPlayerPosition, object->m_position ) > ( maxDistance * maxDistance ) )
-				{
-					continue;
-				}
 
-				NetMessage update( eNetGameMessageType_NET_OBJECT_UPDATE );
-				m_hostObjects[objectIndex]->WriteToMessage( &update );
-				connection->AddMessage( update );
-			}
+		std::sort( m_updateCandidates.begin( ), m_updateCandidates.end( ), IsHigherPriority );
 
-			//Always sync Crystal
-			else if( object->m_type == eNetGameObjectType_ALLYSHIP )
+		//Send the top of the list until this tick's share of the connection's budget is used,
+		//always at least one so a tiny budget still makes progress
+		double budget = connection->GetRateController( )->GetSendRate( ) * s_netSession->GetSendInterval( ) * OBJECT_UPDATE_BUDGET_FRACTION;
+		double bytesQueued = 0.0;
+		for( size_t candidateIndex = 0; candidateIndex < m_updateCandidates.size( ); ++candidateIndex )
+		{
+			if( candidateIndex > 0 && bytesQueued >= budget )
 			{
-				size_t currentIndex = connection->GetIndex( );
-				Player * checkPlayer = m_hostPlayers[currentIndex];
-				//Only sync players that exist
-				if( checkPlayer == nullptr )
-				{
-					continue;
-				}
-				//Vector2f curretPlayerPosition = checkPlayer->GetLastPosition( );
-				NetMessage update( eNetGameMessageType_NET_OBJECT_UPDATE );
-				m_hostObjects[objectIndex]->WriteToMessage( &update );
-				connection->AddMessage( update );
+				break;
 			}
+
+			UpdateCandidate & candidate = m_updateCandidates[candidateIndex];
+			bytesQueued += (double) HostAddObjectUpdate( connection, candidate.netObject );
+			candidate.history->m_sendPriority = 0.f;
 		}
 	}
 }
 
 
+//-------------------------------------------------------------------------------------------------
+void Game::OnFinishSnapshot( NamedProperties & )
+{
+	HostReleaseSnapshot( );
+}
+
+
 //-------------------------------------------------------------------------------------------------
 void Game::OnJoinRequestValidation( NamedProperties & netEvent )
 {
@@ -230,7 +274,7 @@ void Game::OnJoinRequestValidation( NamedProperties & netEvent )
 				else
 				{
 					//Tell Connection that the host left (This will make them leave)
-					NetMessage leave( eNetMessageType_LEAVE, s_netSession->GetHost( )->GetIndex( ) );
+					OwnedNetMessage leave( eNetMessageType_LEAVE, s_netSession->GetHost( )->GetIndex( ) );
 					bootConnection->AddMessage( leave );
 					bootConnection->SendPacket( );
 
@@ -269,6 +313,10 @@ void Game::OnDedicatedHostButton( NamedProperties & )
 {
 	m_showDebug = true;
 	m_isDedicatedServer = true;
+
+	//Nothing to render for, frames line up with simulation ticks
+	g_EngineSystem->SetTargetFPS( m_simScheduler.GetRate( ) );
+	g_EngineSystem->SetPreciseFrameWait( true );
 	AttemptCreateHost( "", "" );
 }
 
@@ -278,6 +326,7 @@ void Game::OnGameHostButton( NamedProperties & )
 {
 	m_showDebug = false;
 	m_isDedicatedServer = false;
+	g_EngineSystem->SetPreciseFrameWait( false );
 
 	//Get username from username field
 	std::string defaultUsername = NetworkUtils::GetLocalHostName( );
@@ -326,7 +375,7 @@ void Game::OnGameJoinButton( NamedProperties & )
 //-------------------------------------------------------------------------------------------------
 void Game::OnFighterClassButton( NamedProperties & )
 {
-	NetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
+	OwnedNetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
 	inputEvent.Write<byte_t>( eGameEvent_CHOOSE_CLASS_FIGHTER );
 	s_netSession->GetHost( )->AddMessage( inputEvent );
 }
@@ -335,7 +384,7 @@ void Game::OnFighterClassButton( NamedProperties & )
 //-------------------------------------------------------------------------------------------------
 void Game::OnWizardClassButton( NamedProperties & )
 {
-	NetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
+	OwnedNetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
 	inputEvent.Write<byte_t>( eGameEvent_CHOOSE_CLASS_WIZARD );
 	s_netSession->GetHost( )->AddMessage( inputEvent );
 }
@@ -344,7 +393,7 @@ void Game::OnWizardClassButton( NamedProperties & )
 //-------------------------------------------------------------------------------------------------
 void Game::OnRogueClassButton( NamedProperties & )
 {
-	NetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
+	OwnedNetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
 	inputEvent.Write<byte_t>( eGameEvent_CHOOSE_CLASS_ROGUE );
 	s_netSession->GetHost( )->AddMessage( inputEvent );
 }
@@ -353,7 +402,7 @@ void Game::OnRogueClassButton( NamedProperties & )
 //-------------------------------------------------------------------------------------------------
 void Game::OnCultistClassButton( NamedProperties & )
 {
-	NetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
+	OwnedNetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
 	inputEvent.Write<byte_t>( eGameEvent_CHOOSE_CLASS_CULTIST );
 	s_netSession->GetHost( )->AddMessage( inputEvent );
 }
@@ -362,7 +411,7 @@ void Game::OnCultistClassButton( NamedProperties & )
 //-------------------------------------------------------------------------------------------------
 void Game::OnUpgradeHullButton( NamedProperties & )
 {
-	NetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
+	OwnedNetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
 	inputEvent.Write<byte_t>( eGameEvent_UPGRADE_HULL );
 	s_netSession->GetHost( )->AddMessage( inputEvent );
 }
@@ -371,7 +420,7 @@ void Game::OnUpgradeHullButton( NamedProperties & )
 //-------------------------------------------------------------------------------------------------
 void Game::OnUpgradeHealthButton( NamedProperties & )
 {
-	NetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
+	OwnedNetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
 	inputEvent.Write<byte_t>( eGameEvent_UPGRADE_HEALTH );
 	s_netSession->GetHost( )->AddMessage( inputEvent );
 }
@@ -380,7 +429,7 @@ void Game::OnUpgradeHealthButton( NamedProperties & )
 //-------------------------------------------------------------------------------------------------
 void Game::OnUpgradeShieldButton( NamedProperties & )
 {
-	NetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
+	OwnedNetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
 	inputEvent.Write<byte_t>( eGameEvent_UPGRADE_SHIELD );
 	s_netSession->GetHost( )->AddMessage( inputEvent );
 }
@@ -389,7 +438,7 @@ void Game::OnUpgradeShieldButton( NamedProperties & )
 //-------------------------------------------------------------------------------------------------
 void Game::OnUpgradeEnergyButton( NamedProperties & )
 {
-	NetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
+	OwnedNetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
 	inputEvent.Write<byte_t>( eGameEvent_UPGRADE_ENERGY );
 	s_netSession->GetHost( )->AddMessage( inputEvent );
 }
@@ -398,7 +447,7 @@ void Game::OnUpgradeEnergyButton( NamedProperties & )
 //-------------------------------------------------------------------------------------------------
 void Game::OnFeedCrystalButton( NamedProperties & )
 {
-	NetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
+	OwnedNetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
 	inputEvent.Write<byte_t>( eGameEvent_FEED_CRYSTAL );
 	s_netSession->GetHost( )->AddMessage( inputEvent );
 }
@@ -407,7 +456,7 @@ void Game::OnFeedCrystalButton( NamedProperties & )
 //-------------------------------------------------------------------------------------------------
 void Game::OnEmoteHappyButton( NamedProperties & )
 {
-	NetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
+	OwnedNetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
 	inputEvent.Write<byte_t>( eGameEvent_EMOTE_HAPPY );
 	s_netSession->GetHost( )->AddMessage( inputEvent );
 }
@@ -416,7 +465,7 @@ void Game::OnEmoteHappyButton( NamedProperties & )
 //-------------------------------------------------------------------------------------------------
 void Game::OnEmoteSadButton( NamedProperties & )
 {
-	NetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
+	OwnedNetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
 	inputEvent.Write<byte_t>( eGameEvent_EMOTE_SAD );
 	s_netSession->GetHost( )->AddMessage( inputEvent );
 }
@@ -425,7 +474,7 @@ void Game::OnEmoteSadButton( NamedProperties & )
 //-------------------------------------------------------------------------------------------------
 void Game::OnEmoteAngryButton( NamedProperties & )
 {
-	NetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
+	OwnedNetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
 	inputEvent.Write<byte_t>( eGameEvent_EMOTE_ANGRY );
 	s_netSession->GetHost( )->AddMessage( inputEvent );
 }
@@ -434,7 +483,7 @@ void Game::OnEmoteAngryButton( NamedProperties & )
 //-------------------------------------------------------------------------------------------------
 void Game::OnEmoteWhoopsButton( NamedProperties & )
 {
-	NetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
+	OwnedNetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
 	inputEvent.Write<byte_t>( eGameEvent_EMOTE_WHOOPS );
 	s_netSession->GetHost( )->AddMessage( inputEvent );
 }
@@ -443,7 +492,7 @@ void Game::OnEmoteWhoopsButton( NamedProperties & )
 //-------------------------------------------------------------------------------------------------
 void Game::OnEmoteHelpButton( NamedProperties & )
 {
-	NetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
+	OwnedNetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
 	inputEvent.Write<byte_t>( eGameEvent_EMOTE_HELP );
 	s_netSession->GetHost( )->AddMessage( inputEvent );
 }
@@ -1,10 +1,14 @@
 #include "Game/General/Game.hpp"
 
 #include "Engine/Core/NamedProperties.hpp"
+#include "Engine/Core/Time.hpp"
 #include "Engine/DebugSystem/Console.hpp"
+#include "Engine/Net/Session/FragmentBuffer.hpp"
 #include "Engine/Net/Session/NetConnection.hpp"
+#include "Engine/Net/Session/RateController.hpp"
 #include "Engine/RenderSystem/SpriteRenderSystem/ParticleSystem.hpp"
 #include "Engine/RenderSystem/SpriteRenderSystem/ParticleEngine.hpp"
+#include "Engine/RenderSystem/SpriteRenderSystem/SpriteGameRenderer.hpp"
 #include "Engine/UISystem/UISystem.hpp"
 #include "Engine/UISystem/UIWidget.hpp"
 #include "Game/GameObjects/Allies/AllyShip.hpp"
@@ -18,8 +22,10 @@
 #include "Game/GameObjects/Items/Pickup.hpp"
 #include "Game/GameObjects/Player/Player.hpp"
 #include "Game/GameObjects/Player/PlayerShip.hpp"
+#include "Game/General/CatchupStream.hpp"
 #include "Game/General/NetMessageHandling.hpp"
 #include "Game/General/SessionCommands.hpp"
+#include "Game/General/SnapshotDelta.hpp"
 
 
 //-------------------------------------------------------------------------------------------------
@@ -118,7 +124,7 @@ void Game::HostCreatePlayer( byte_t netIndex, char const * username, size_t pass
 	m_HostGameActivityLog.Printf( "Player (index=%u) Created: %s", m_hostPlayers[netIndex]->GetPlayerIndex( ), m_hostPlayers[netIndex]->GetUsername( ) );
 
 	//Send create message
-	NetMessage create( eNetGameMessageType_NET_PLAYER_CREATE );
+	OwnedNetMessage create( eNetGameMessageType_NET_PLAYER_CREATE );
 	create.Write<byte_t>( netIndex );
 	create.WriteString( username );
 	s_netSession->AddMessageToAllClients( create );
@@ -126,10 +132,7 @@ void Game::HostCreatePlayer( byte_t netIndex, char const * username, size_t pass
 	//Immediately send a single Update Message, because players load with saved data and that data is only sent when it changes
 	//If this isn't sent, then the player will think they have absolutely nothing until the next update
 	//#TODO: Make sure this is actually happening (correctly)
-	NetMessage updateOneTime( eNetGameMessageType_NET_PLAYER_UPDATE );
-	updateOneTime.Write<byte_t>( m_hostPlayers[netIndex]->GetPlayerIndex( ) );
-	m_hostPlayers[netIndex]->WriteToMessage( &updateOneTime );
-	s_netSession->AddMessageToAllClients( updateOneTime );
+	HostSendPlayerUpdate( nullptr, netIndex );
 }
 
 
@@ -137,7 +140,7 @@ void Game::HostCreatePlayer( byte_t netIndex, char const * username, size_t pass
 void Game::HostDestroyPlayer( byte_t netIndex )
 {
 	//Send destroy message
-	NetMessage destroy( eNetGameMessageType_NET_PLAYER_DESTROY );
+	OwnedNetMessage destroy( eNetGameMessageType_NET_PLAYER_DESTROY );
 	destroy.Write<byte_t>( netIndex );
 	s_netSession->AddMessageToAllClients( destroy );
 
@@ -219,10 +222,32 @@ Player * Game::HostGetPlayerForPlayerShip( PlayerShip const * playerShip ) const
 //-------------------------------------------------------------------------------------------------
 void Game::HostUpdatePlayer( byte_t playerIndex )
 {
-	NetMessage update( eNetGameMessageType_NET_PLAYER_UPDATE );
+	HostSendPlayerUpdate( nullptr, playerIndex );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Full inventory and stats can be bigger than one NetMessage, so the sync always goes out
+// fragmented, in order with every other player sync. nullptr connection sends to all clients.
+void Game::HostSendPlayerUpdate( NetConnection * connection, byte_t playerIndex )
+{
+	if( m_hostSyncBuffer.empty( ) )
+	{
+		m_hostSyncBuffer.resize( FragmentBuffer::MAX_SIZE );
+	}
+
+	NetMessage update( eNetGameMessageType_NET_PLAYER_UPDATE, NetSession::INVALID_INDEX, m_hostSyncBuffer.data( ), m_hostSyncBuffer.size( ), 0 );
 	update.Write<byte_t>( m_hostPlayers[playerIndex]->GetPlayerIndex( ) );
 	m_hostPlayers[playerIndex]->WriteToMessage( &update );
-	s_netSession->AddMessageToAllClients( update );
+
+	if( connection )
+	{
+		connection->AddFragmentedMessage( eNetGameMessageType_NET_PLAYER_UPDATE, update.GetBuffer( ), update.GetPayloadSize( ) );
+	}
+	else
+	{
+		s_netSession->AddFragmentedMessageToAllClients( eNetGameMessageType_NET_PLAYER_UPDATE, update.GetBuffer( ), update.GetPayloadSize( ) );
+	}
 }
 
 
@@ -349,9 +374,9 @@ void Game::ClientDestroyPlayer( byte_t netIndex )
 Player * Game::ClientGetPlayerSelf( ) const
 {
 	NetConnection * conn = s_netSession->GetSelf( );
-	if( conn && conn->GetIndex( ) != GameObject::INVALID_INDEX )
+	if( conn && conn->GetIndex( ) != NetSession::INVALID_INDEX )
 	{
-		return ClientGetPlayer( conn->GetIndex( ) );
+		return ClientGetPlayer( (byte_t) conn->GetIndex( ) );
 	}
 	else
 	{
@@ -394,10 +419,11 @@ NetGameObject * Game::HostCreateNetGameObject( GameObject * object )
 	//Add to list of host objects
 	NetGameObject * netObject = new NetGameObject( object );
 	m_hostObjects.push_back( netObject );
+	netObject->m_interestProxy = m_interestGrid.AddProxy( netObject, object->m_position );
 	m_HostGameActivityLog.Printf( "%s (id=%u) Created at (%.2f,%.2f)", object->GetEntityName( ), netObject->GetID( ), object->m_position.x, object->m_position.y );
 
 	//Send create message
-	NetMessage create( eNetGameMessageType_NET_OBJECT_CREATE );
+	OwnedNetMessage create( eNetGameMessageType_NET_OBJECT_CREATE );
 	netObject->WriteToMessage( &create );
 	s_netSession->AddMessageToAllClients( create );
 
@@ -414,9 +440,20 @@ void Game::HostDestroyNetGameObject( NetGameObject * netObject )
 
 	//Send destroy message
 	size_t netID = netObject->GetID( );
-	NetMessage destroy( eNetGameMessageType_NET_OBJECT_DESTROY );
+	OwnedNetMessage destroy( eNetGameMessageType_NET_OBJECT_DESTROY );
 	destroy.Write<size_t>( netID );
 	s_netSession->AddMessageToAllClients( destroy );
+	for( size_t playerIndex = 0; playerIndex < MAX_PLAYERS; ++playerIndex )
+	{
+		if( m_hostBaselines[playerIndex] )
+		{
+			m_hostBaselines[playerIndex]->RemoveObject( netID );
+		}
+		if( m_hostCatchups[playerIndex] )
+		{
+			m_hostCatchups[playerIndex]->RemoveObject( netID );
+		}
+	}
 
 	{
 		GameObject * checkObject = netObject->GetLocalObject( );
@@ -498,6 +535,7 @@ void Game::HostDestroyNetGameObject( NetGameObject * netObject )
 		NetGameObject * hostNetObject = *hostObjectIter;
 		if( hostNetObject == netObject )
 		{
+			m_interestGrid.RemoveProxy( hostNetObject->m_interestProxy );
 			delete hostNetObject;
 			m_hostObjects.erase( hostObjectIter );
 			return;
@@ -806,6 +844,7 @@ void Game::HostFireWeapon( byte_t playerIndex, uint16_t weaponCode, Vector2f con
 
 
 //-------------------------------------------------------------------------------------------------
+// Players go out right away, the net objects are streamed by HostUpdateCatchup over the next ticks
 void Game::HostCatchupConnectionOnCurrentGameState( NetConnection * conn )
 {
 	//Create players first
@@ -820,29 +859,339 @@ void Game::HostCatchupConnectionOnCurrentGameState( NetConnection * conn )
 		//Don't send create for themselves
 		if( playerIndex != conn->GetIndex( ) )
 		{
-			NetMessage create( eNetGameMessageType_NET_PLAYER_CREATE );
+			OwnedNetMessage create( eNetGameMessageType_NET_PLAYER_CREATE );
 			create.Write<byte_t>( playerIndex );
 			create.WriteString( m_hostPlayers[playerIndex]->GetUsername( ) );
 			conn->AddMessage( create );
 
-			NetMessage update( eNetGameMessageType_NET_PLAYER_UPDATE );
 			m_hostPlayers[playerIndex]->m_forceUpdate = true;
-			update.Write<byte_t>( m_hostPlayers[playerIndex]->GetPlayerIndex( ) );
-			m_hostPlayers[playerIndex]->WriteToMessage( &update );
-			conn->AddMessage( update );
+			HostSendPlayerUpdate( conn, playerIndex );
 		}
 	}
 
-	//Create all current net objects
-	for( size_t netObjectIndex = 0; netObjectIndex < m_hostObjects.size( ); ++netObjectIndex )
+	//Queue all current net objects, nearest to the new player first
+	//Anything created from here on is sent to this connection like everyone else
+	Vector2f joinPosition = Vector2f::ZERO;
+	if( m_hostPlayers[conn->GetIndex( )] )
+	{
+		joinPosition = m_hostPlayers[conn->GetIndex( )]->GetLastPosition( );
+	}
+	delete m_hostCatchups[conn->GetIndex( )];
+	m_hostCatchups[conn->GetIndex( )] = new CatchupStream( m_hostObjects, joinPosition, Time::GetCurrentTimeSeconds( ) );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Sends the next part of a joined connection's catch-up, several creates to a batch. Holds off
+// while the connection still has reliables queued so gameplay creates and destroys aren't stuck
+// behind the world, and says when it's done so the client knows it has everything. The stream
+// is kept until every batch is confirmed, updates for its objects are held until then.
+void Game::HostUpdateCatchup( NetConnection * connection )
+{
+	uint16_t connectionIndex = connection->GetIndex( );
+	CatchupStream * catchup = m_hostCatchups[connectionIndex];
+	if( catchup == nullptr )
+	{
+		return;
+	}
+
+	if( catchup->IsCompleteSent( ) )
+	{
+		if( catchup->IsConfirmed( ) )
+		{
+			delete catchup;
+			m_hostCatchups[connectionIndex] = nullptr;
+		}
+		return;
+	}
+
+	if( connection->GetUnsentReliableCount( ) > CATCHUP_MAX_UNSENT_RELIABLES )
+	{
+		return;
+	}
+
+	//Always at least one batch so a tiny budget still makes progress
+	size_t const ENTRY_MAX_SIZE = sizeof( uint32_t ) + sizeof( eNetGameObjectType ) + GameObject::MAX_NET_STATE_SIZE;
+	double budget = connection->GetRateController( )->GetSendRate( ) * s_netSession->GetSendInterval( ) * CATCHUP_BUDGET_FRACTION;
+	double bytesQueued = 0.0;
+	while( !catchup->IsFinished( ) && ( bytesQueued == 0.0 || bytesQueued < budget ) )
+	{
+		OwnedNetMessage batch( eNetGameMessageType_NET_OBJECT_CREATE_BATCH );
+		size_t countPosition = batch.Reserve<uint8_t>( 0U );
+		uint8_t objectCount = 0;
+		while( objectCount < UINT8_MAX && batch.GetPayloadSize( ) + ENTRY_MAX_SIZE <= CATCHUP_BATCH_SIZE )
+		{
+			NetGameObject * netObject = catchup->TakeNext( );
+			if( netObject == nullptr )
+			{
+				break;
+			}
+
+			GameObject * object = netObject->GetLocalObject( );
+			WriteUncompressedUint32( &batch, (uint32_t) netObject->GetID( ) );
+			batch.Write<eNetGameObjectType>( object->m_type );
+			object->WriteToMessage( &batch );
+			++objectCount;
+		}
+
+		//Everything left was destroyed before it went out
+		if( objectCount == 0 )
+		{
+			break;
+		}
+
+		batch.WriteAt<uint8_t>( countPosition, objectCount );
+		batch.m_deliveryTag = HostGetBaselines( connection )->TakeTag( );
+		connection->AddMessage( batch );
+		catchup->AddSentMessage( batch.m_deliveryTag );
+		bytesQueued += (double) batch.GetTotalWrittenMessageSize( );
+	}
+
+	if( catchup->IsFinished( ) )
+	{
+		OwnedNetMessage complete( eNetGameMessageType_NET_CATCHUP_COMPLETE );
+		WriteUncompressedUint32( &complete, (uint32_t) catchup->GetSentObjectCount( ) );
+		connection->AddMessage( complete );
+
+		double catchupSeconds = Time::GetCurrentTimeSeconds( ) - catchup->GetStartTime( );
+		m_HostGameActivityLog.Printf( "%s (index=%u) Caught up on %u objects in %u messages, %.3fs", connection->GetUsername( ), connectionIndex, catchup->GetSentObjectCount( ), catchup->GetMessageCount( ), catchupSeconds );
+		catchup->SetCompleteSent( );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// The client may not have this object yet, an update could arrive ahead of its create
+bool Game::HostIsCatchupPending( NetConnection * connection, size_t netID ) const
+{
+	CatchupStream const * catchup = m_hostCatchups[connection->GetIndex( )];
+	return catchup != nullptr && catchup->IsPending( netID );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Encodes the per-tick updates once into the session arena. OnPreparePacket hands the same
+// encoded messages to every connection instead of serializing them again per client.
+void Game::HostBuildSnapshot( )
+{
+	HostReleaseSnapshot( );
+	NetMessageArena & arena = s_netSession->GetMessageArena( );
+
+	OwnedNetMessage gameStateUpdate( eNetGameMessageType_GAME_STATE_UPDATE );
+	m_gameState.WriteToMessage( &gameStateUpdate );
+	m_snapshotGameState = arena.Share( gameStateUpdate );
+
+	for( size_t playerIndex = 0; playerIndex < MAX_PLAYERS; ++playerIndex )
+	{
+		if( m_hostPlayers[playerIndex] == nullptr )
+		{
+			continue;
+		}
+		if( m_hostPlayers[playerIndex]->m_localShip == nullptr )
+		{
+			continue;
+		}
+
+		NetGameObject * ship = m_hostPlayers[playerIndex]->m_localShip;
+		OwnedNetMessage update( eNetGameMessageType_NET_OBJECT_UPDATE );
+		update.m_coalesceKey = (uint32_t) ship->GetID( );
+		ship->WriteToMessage( &update );
+		ship->m_snapshotUpdate = arena.Share( update );
+		m_snapshotObjects.push_back( ship->m_snapshotUpdate );
+		m_snapshotShips.push_back( ship );
+	}
+
+	++m_snapshotTick;
+	for( size_t objectIndex = 0; objectIndex < m_hostObjects.size( ); ++objectIndex )
+	{
+		NetGameObject * netObject = m_hostObjects[objectIndex];
+		GameObject * object = netObject->GetLocalObject( );
+		m_interestGrid.MoveProxy( netObject->m_interestProxy, object->m_position );
+
+		//#TODO: Make sure to make this is flexible when more entities need to get networked
+		if( object->m_type != eNetGameObjectType_BULLET &&
+			object->m_type != eNetGameObjectType_ENEMYSHIP &&
+			object->m_type != eNetGameObjectType_ROCK &&
+			object->m_type != eNetGameObjectType_ALLYSHIP )
+		{
+			continue;
+		}
+
+		OwnedNetMessage update( eNetGameMessageType_NET_OBJECT_UPDATE );
+		update.m_coalesceKey = (uint32_t) netObject->GetID( );
+		netObject->WriteToMessage( &update );
+		netObject->m_snapshotUpdate = arena.Share( update );
+		m_snapshotObjects.push_back( netObject->m_snapshotUpdate );
+
+		//Always sync Crystal
+		if( object->m_type == eNetGameObjectType_ALLYSHIP )
+		{
+			m_snapshotAlwaysRelevant.push_back( netObject );
+		}
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void Game::HostReleaseSnapshot( )
+{
+	if( s_netSession == nullptr )
+	{
+		return;
+	}
+
+	NetMessageArena & arena = s_netSession->GetMessageArena( );
+	arena.Release( m_snapshotGameState );
+	m_snapshotGameState = nullptr;
+	for( NetMessage * update : m_snapshotObjects )
+	{
+		arena.Release( update );
+	}
+	m_snapshotObjects.clear( );
+	for( NetGameObject * ship : m_snapshotShips )
+	{
+		ship->m_snapshotUpdate = nullptr;
+	}
+	m_snapshotShips.clear( );
+	m_snapshotAlwaysRelevant.clear( );
+	for( size_t objectIndex = 0; objectIndex < m_hostObjects.size( ); ++objectIndex )
+	{
+		m_hostObjects[objectIndex]->m_snapshotUpdate = nullptr;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+ConnectionBaselines * Game::HostGetBaselines( NetConnection * connection )
+{
+	size_t connectionIndex = connection->GetIndex( );
+	ConnectionBaselines * baselines = m_hostBaselines[connectionIndex];
+	if( baselines == nullptr )
+	{
+		baselines = new ConnectionBaselines( );
+		m_hostBaselines[connectionIndex] = baselines;
+	}
+	return baselines;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Applies whatever the ack system confirmed since the last time. Delta updates and catch-up
+// batches share the connection's tags.
+void Game::HostConfirmDeliveries( NetConnection * connection )
+{
+	ConnectionBaselines * baselines = HostGetBaselines( connection );
+	CatchupStream * catchup = m_hostCatchups[connection->GetIndex( )];
+
+	m_confirmedDeliveryTags.clear( );
+	connection->TakeConfirmedDeliveryTags( &m_confirmedDeliveryTags );
+	for( size_t tagIndex = 0; tagIndex < m_confirmedDeliveryTags.size( ); ++tagIndex )
+	{
+		baselines->ConfirmDelivery( m_confirmedDeliveryTags[tagIndex] );
+		if( catchup )
+		{
+			catchup->ConfirmDelivery( m_confirmedDeliveryTags[tagIndex] );
+		}
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Sends an object's snapshot update to one connection as a delta against the newest state that
+// connection has acked, once it has confirmed applying one (see ConnectionBaselines). The delta message is: net ID, tick, baseline tick, then either the
+// changed lanes or the full fields when there is no usable baseline (baseline tick == tick).
+// Returns the bytes queued, 0 if the client already has this state.
+size_t Game::HostAddObjectUpdate( NetConnection * connection, NetGameObject * netObject )
+{
+	if( HostIsCatchupPending( connection, netObject->GetID( ) ) )
+	{
+		return 0;
+	}
+
+	ConnectionBaselines * baselines = HostGetBaselines( connection );
+
+	//Fields are everything after the net ID
+	NetMessage & fullUpdate = *netObject->m_snapshotUpdate;
+	size_t const NET_ID_SIZE = sizeof( uint32_t );
+	size_t fieldSize = fullUpdate.GetPayloadSize( ) - NET_ID_SIZE;
+	if( fieldSize == 0 || fieldSize > SnapshotState::MAX_STATE_SIZE )
+	{
+		connection->AddMessage( fullUpdate );
+		return fullUpdate.GetTotalWrittenMessageSize( );
+	}
+	byte_t const * fields = fullUpdate.GetBuffer( ) + NET_ID_SIZE;
+
+	size_t netID = netObject->GetID( );
+	SnapshotHistory & history = baselines->GetHistory( netID );
+	SnapshotState const * baseline = history.FindNewestAcked( m_snapshotTick );
+	if( baseline && baseline->size != fieldSize )
+	{
+		baseline = nullptr;
+	}
+
+	//The client already has exactly this, only resend once in a while so it doesn't time out
+	bool unchanged = baseline && baseline->tick == history.m_lastTick && memcmp( baseline->data, fields, fieldSize ) == 0;
+	if( unchanged && ( m_snapshotTick - history.m_lastTick ) < DELTA_KEEPALIVE_TICKS )
+	{
+		return 0;
+	}
+
+	OwnedNetMessage delta( eNetGameMessageType_NET_OBJECT_DELTA_UPDATE );
+	delta.m_coalesceKey = (uint32_t) netID;
+	WriteUncompressedUint32( &delta, netID );
+	WriteUncompressedUint16( &delta, (uint16_t) m_snapshotTick );
+	if( baseline )
+	{
+		WriteUncompressedUint16( &delta, (uint16_t) baseline->tick );
+		WriteSnapshotDelta( &delta, *baseline, fields, fieldSize );
+	}
+	else
+	{
+		WriteUncompressedUint16( &delta, (uint16_t) m_snapshotTick );
+		delta.WriteForward( fields, fieldSize );
+	}
+
+	history.Store( m_snapshotTick, fields, fieldSize );
+	history.m_lastTick = m_snapshotTick;
+	history.m_hasLastTick = true;
+	delta.m_deliveryTag = baselines->AddRecord( netID, m_snapshotTick );
+	connection->AddMessage( delta );
+	return delta.GetTotalWrittenMessageSize( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// How far from a player an object stays relevant, based on the host's view size
+float Game::HostGetRelevanceRadius( eNetGameObjectType const & type ) const
+{
+	float viewRadius = g_SpriteRenderSystem->GetVirtualSize( );
+	switch( type )
+	{
+	case eNetGameObjectType_ENEMYSHIP:
+		//Seen a bit before they come on screen so they don't pop in
+		return viewRadius * 1.5f;
+	case eNetGameObjectType_BULLET:
+	case eNetGameObjectType_ROCK:
+	default:
+		return viewRadius;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// How fast an object's send priority grows each tick it's relevant, before distance scaling
+float Game::HostGetUpdatePriority( eNetGameObjectType const & type ) const
+{
+	switch( type )
 	{
-		//Send create message
-		NetMessage create( eNetGameMessageType_NET_OBJECT_CREATE );
-		GameObject * object = m_hostObjects[netObjectIndex]->GetLocalObject( );
-		create.Write<size_t>( m_hostObjects[netObjectIndex]->GetID( ) );
-		create.Write<eNetGameObjectType>( object->m_type );
-		object->WriteToMessage( &create );
-		conn->AddMessage( create );
+	case eNetGameObjectType_ENEMYSHIP:
+		//They shoot back, stale positions are the most noticeable
+		return 2.f;
+	case eNetGameObjectType_BULLET:
+		return 1.5f;
+	case eNetGameObjectType_ROCK:
+	default:
+		return 1.f;
 	}
 }
 
@@ -1144,7 +1493,10 @@ void Game::HostWipeGame( )
 		}
 	}
 
-	//Flush current packets
+	//Flush current packets, sent from here even if the network thread is running
+	s_netSession->LockNetThread( );
+	NamedProperties snapshotEvent;
+	EventSystem::TriggerEvent( NetSession::PREPARE_SNAPSHOT_EVENT, snapshotEvent );
 	for( uint8_t index = 0; index < MAX_PLAYERS; ++index )
 	{
 		if( !s_netSession->GetNetConnection( index ) )
@@ -1156,6 +1508,8 @@ void Game::HostWipeGame( )
 		EventSystem::TriggerEvent( NetSession::PREPARE_PACKET_EVENT, netEvent );
 		s_netSession->GetNetConnection( index )->SendPacket( );
 	}
+	EventSystem::TriggerEvent( NetSession::FINISH_SNAPSHOT_EVENT, snapshotEvent );
+	s_netSession->UnlockNetThread( );
 
 	//Boot host, and by consequence, all clients
 	m_quitNextFrame = true;
@@ -1246,7 +1600,7 @@ float Game::ClientGetClosestGameObjectWithinDegrees( GameObject const * fromObje
 //-------------------------------------------------------------------------------------------------
 void Game::ClientRequestEvent( eGameEvent const & upgradeEvent )
 {
-	NetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
+	OwnedNetMessage inputEvent( eNetGameMessageType_RELIABLE_INPUT );
 	inputEvent.Write<eGameEvent>( upgradeEvent );
 	s_netSession->GetHost( )->AddMessage( inputEvent );
 }
@@ -1255,7 +1609,7 @@ void Game::ClientRequestEvent( eGameEvent const & upgradeEvent )
 //-------------------------------------------------------------------------------------------------
 void Game::ClientRequestRemoveItem( byte_t itemIndex )
 {
-	NetMessage removeItemEvent( eNetGameMessageType_RELIABLE_INPUT );
+	OwnedNetMessage removeItemEvent( eNetGameMessageType_RELIABLE_INPUT );
 	removeItemEvent.Write<eGameEvent>( eGameEvent_EJECT_ITEM );
 	removeItemEvent.Write<byte_t>( itemIndex );
 	s_netSession->GetHost( )->AddMessage( removeItemEvent );
@@ -1265,7 +1619,7 @@ void Game::ClientRequestRemoveItem( byte_t itemIndex )
 //-------------------------------------------------------------------------------------------------
 void Game::ClientRequestRemoveEquipment( eEquipmentSlot const & slot )
 {
-	NetMessage removeItemEvent( eNetGameMessageType_RELIABLE_INPUT );
+	OwnedNetMessage removeItemEvent( eNetGameMessageType_RELIABLE_INPUT );
 	if( slot == eEquipmentSlot_PRIMARY )
 	{
 		removeItemEvent.Write<eGameEvent>( eGameEvent_REMOVE_PRIMARY );
@@ -1277,7 +1631,7 @@ void Game::ClientRequestRemoveEquipment( eEquipmentSlot const & slot )
 //-------------------------------------------------------------------------------------------------
 void Game::ClientRequestEquipPrimary( byte_t itemIndex )
 {
-	NetMessage equipItemEvent( eNetGameMessageType_RELIABLE_INPUT );
+	OwnedNetMessage equipItemEvent( eNetGameMessageType_RELIABLE_INPUT );
 	equipItemEvent.Write<eGameEvent>( eGameEvent_EQUIP_PRIMARY );
 	equipItemEvent.Write<byte_t>( itemIndex );
 	s_netSession->GetHost( )->AddMessage( equipItemEvent );
@@ -0,0 +1,158 @@
+#include "Game/General/InterestGrid.hpp"
+
+#include <math.h>
+#include "Engine/Utils/MathUtils.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+InterestGrid::InterestGrid( float worldRadius, float cellSize )
+	: m_worldRadius( worldRadius )
+	, m_cellSize( cellSize )
+	, m_cellsPerSide( (int) ceilf( ( worldRadius * 2.f ) / cellSize ) )
+{
+	m_cells.resize( m_cellsPerSide * m_cellsPerSide );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t InterestGrid::AddProxy( void * userData, Vector2f const & position )
+{
+	size_t proxy;
+	if( m_freeProxies.empty( ) )
+	{
+		proxy = m_proxies.size( );
+		m_proxies.push_back( InterestProxy( ) );
+	}
+	else
+	{
+		proxy = m_freeProxies.back( );
+		m_freeProxies.pop_back( );
+	}
+
+	InterestProxy & entry = m_proxies[proxy];
+	entry.userData = userData;
+	entry.position = position;
+	entry.cellIndex = INVALID_CELL;
+	InsertIntoCell( proxy, GetCellIndex( position ) );
+	return proxy;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void InterestGrid::MoveProxy( size_t proxy, Vector2f const & position )
+{
+	InterestProxy & entry = m_proxies[proxy];
+	entry.position = position;
+
+	//Most frames an object stays in the same cell
+	int cellIndex = GetCellIndex( position );
+	if( cellIndex == entry.cellIndex )
+	{
+		return;
+	}
+
+	RemoveFromCell( proxy );
+	InsertIntoCell( proxy, cellIndex );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void InterestGrid::RemoveProxy( size_t proxy )
+{
+	if( proxy == INVALID_PROXY )
+	{
+		return;
+	}
+
+	RemoveFromCell( proxy );
+	m_proxies[proxy].userData = nullptr;
+	m_freeProxies.push_back( proxy );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void InterestGrid::Clear( )
+{
+	for( size_t cellIndex = 0; cellIndex < m_cells.size( ); ++cellIndex )
+	{
+		m_cells[cellIndex].clear( );
+	}
+	m_proxies.clear( );
+	m_freeProxies.clear( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Appends every proxy in the cells overlapping the query square. Callers do their own exact
+// distance check, the grid only narrows down the candidates.
+void InterestGrid::Query( Vector2f const & center, float radius, std::vector<void*> * out_userData ) const
+{
+	int minX = GetCellCoord( center.x - radius );
+	int maxX = GetCellCoord( center.x + radius );
+	int minY = GetCellCoord( center.y - radius );
+	int maxY = GetCellCoord( center.y + radius );
+
+	for( int cellY = minY; cellY <= maxY; ++cellY )
+	{
+		for( int cellX = minX; cellX <= maxX; ++cellX )
+		{
+			std::vector<size_t> const & cell = m_cells[cellY * m_cellsPerSide + cellX];
+			for( size_t slot = 0; slot < cell.size( ); ++slot )
+			{
+				out_userData->push_back( m_proxies[cell[slot]].userData );
+			}
+		}
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+size_t InterestGrid::GetProxyCount( ) const
+{
+	return m_proxies.size( ) - m_freeProxies.size( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Anything outside the map is clamped into the border cells
+int InterestGrid::GetCellCoord( float worldCoord ) const
+{
+	int cellCoord = (int) floorf( ( worldCoord + m_worldRadius ) / m_cellSize );
+	return Clamp( cellCoord, 0, m_cellsPerSide - 1 );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+int InterestGrid::GetCellIndex( Vector2f const & position ) const
+{
+	return GetCellCoord( position.y ) * m_cellsPerSide + GetCellCoord( position.x );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void InterestGrid::InsertIntoCell( size_t proxy, int cellIndex )
+{
+	std::vector<size_t> & cell = m_cells[cellIndex];
+	m_proxies[proxy].cellIndex = cellIndex;
+	m_proxies[proxy].cellSlot = cell.size( );
+	cell.push_back( proxy );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void InterestGrid::RemoveFromCell( size_t proxy )
+{
+	InterestProxy & entry = m_proxies[proxy];
+	if( entry.cellIndex == INVALID_CELL )
+	{
+		return;
+	}
+
+	//Swap with the last one in the cell so removal stays O(1)
+	std::vector<size_t> & cell = m_cells[entry.cellIndex];
+	size_t lastProxy = cell.back( );
+	cell[entry.cellSlot] = lastProxy;
+	m_proxies[lastProxy].cellSlot = entry.cellSlot;
+	cell.pop_back( );
+	entry.cellIndex = INVALID_CELL;
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <vector>
+#include "Engine/Math/Vector2f.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+class InterestProxy
+{
+public:
+	void * userData;
+	Vector2f position;
+	int cellIndex;
+	size_t cellSlot;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Uniform grid over the map used by the host to find which objects are relevant to a connection.
+// Objects are moved between cells only when they cross a cell boundary.
+class InterestGrid
+{
+//-------------------------------------------------------------------------------------------------
+// Static Members
+//-------------------------------------------------------------------------------------------------
+public:
+	static size_t const INVALID_PROXY = (size_t) -1;
+	static int const INVALID_CELL = -1;
+
+//-------------------------------------------------------------------------------------------------
+// Members
+//-------------------------------------------------------------------------------------------------
+private:
+	float m_worldRadius;
+	float m_cellSize;
+	int m_cellsPerSide;
+	std::vector<std::vector<size_t>> m_cells;
+	std::vector<InterestProxy> m_proxies;
+	std::vector<size_t> m_freeProxies;
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+public:
+	InterestGrid( float worldRadius, float cellSize );
+
+	size_t AddProxy( void * userData, Vector2f const & position );
+	void MoveProxy( size_t proxy, Vector2f const & position );
+	void RemoveProxy( size_t proxy );
+	void Clear( );
+	void Query( Vector2f const & center, float radius, std::vector<void*> * out_userData ) const;
+
+	size_t GetProxyCount( ) const;
+
+private:
+	int GetCellCoord( float worldCoord ) const;
+	int GetCellIndex( Vector2f const & position ) const;
+	void InsertIntoCell( size_t proxy, int cellIndex );
+	void RemoveFromCell( size_t proxy );
+};
\ No newline at end of file
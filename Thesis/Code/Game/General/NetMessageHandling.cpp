@@ -2,6 +2,7 @@
 
 #include "Engine/Net/Session/NetPacket.hpp"
 #include "Engine/Net/Session/NetConnection.hpp"
+#include "Engine/Utils/MathUtils.hpp"
 #include "Game/GameObjects/Enemies/Rock.hpp"
 #include "Game/GameObjects/Enemies/EnemyShip.hpp"
 #include "Game/GameObjects/Other/Bullet.hpp"
@@ -10,6 +11,7 @@
 #include "Game/GameObjects/NetGameObject.hpp"
 #include "Game/General/Game.hpp"
 #include "Game/General/GameState.hpp"
+#include "Game/General/SnapshotDelta.hpp"
 
 
 //-------------------------------------------------------------------------------------------------
@@ -61,6 +63,46 @@ void OnCreateMessageReceived( NetSender const & sender, NetMessage const & messa
 }
 
 
+//-------------------------------------------------------------------------------------------------
+// Several creates from the host's catch-up after our join: a count, then net ID, type and object for each
+void OnCreateBatchReceived( NetSender const & sender, NetMessage const & message )
+{
+	if( !g_GameSystem->m_isDedicatedServer )
+	{
+		uint8_t objectCount;
+		Game::ReadUncompressedUint8( message, &objectCount );
+		for( uint8_t objectIndex = 0; objectIndex < objectCount; ++objectIndex )
+		{
+			uint32_t netID;
+			Game::ReadUncompressedUint32( message, &netID );
+			eNetGameObjectType type;
+			message.Read<eNetGameObjectType>( &type );
+			GameObject * object = GameObject::CreateFromNetMessage( type, sender, message );
+
+			//Can't find where the next entry starts without reading this one
+			if( object == nullptr )
+			{
+				ASSERT_RECOVERABLE( false, "OnCreateBatchReceived tried to make an object from a bad type" );
+				return;
+			}
+			g_GameSystem->ClientCreateNetGameObject( netID, object );
+		}
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void OnCatchupCompleteReceived( NetSender const &, NetMessage const & message )
+{
+	if( !g_GameSystem->m_isDedicatedServer )
+	{
+		uint32_t objectCount;
+		Game::ReadUncompressedUint32( message, &objectCount );
+		g_GameSystem->m_ClientGameActivityLog.Printf( "Caught up on %u objects", objectCount );
+	}
+}
+
+
 //-------------------------------------------------------------------------------------------------
 void OnDestroyMessageReceived( NetSender const &, NetMessage const & message )
 {
@@ -95,6 +137,118 @@ void OnUpdateMessageReceived( NetSender const & sender, NetMessage const & messa
 }
 
 
+//-------------------------------------------------------------------------------------------------
+// Rebuilds the full object update from a stored baseline. Every state is kept even when it
+// arrives late, because the host may already be using it as a baseline. The host only builds
+// deltas once a full state is confirmed applied here, and goes back to full states after a miss.
+void OnDeltaUpdateMessageReceived( NetSender const & sender, NetMessage const & message )
+{
+	if( !g_GameSystem->m_isDedicatedServer )
+	{
+		uint32_t netID;
+		uint16_t tick;
+		uint16_t baseTick;
+		Game::ReadUncompressedUint32( message, &netID );
+		Game::ReadUncompressedUint16( message, &tick );
+		Game::ReadUncompressedUint16( message, &baseTick );
+
+		NetGameObject * netObject = g_GameSystem->ClientGetNetGameObjectFromNetID( netID );
+
+		//Received an update for a destroy object
+		if( netObject == nullptr )
+		{
+			return;
+		}
+
+		if( netObject->m_receivedHistory == nullptr )
+		{
+			netObject->m_receivedHistory = new SnapshotHistory( );
+		}
+		SnapshotHistory & history = *netObject->m_receivedHistory;
+
+		byte_t fields[SnapshotState::MAX_STATE_SIZE];
+		size_t fieldSize;
+		if( baseTick == tick )
+		{
+			fieldSize = message.GetReadableBytesLeft( );
+			if( fieldSize == 0 || fieldSize > SnapshotState::MAX_STATE_SIZE || !message.ReadForward( fields, fieldSize ) )
+			{
+				return;
+			}
+		}
+		else
+		{
+			//The packet is acked either way, so the host has to hear that this one didn't apply
+			SnapshotState const * baseline = history.Find( baseTick );
+			if( baseline == nullptr || !ReadSnapshotDelta( message, *baseline, fields ) )
+			{
+				OwnedNetMessage miss( eNetGameMessageType_NET_OBJECT_BASELINE_MISS );
+				miss.m_coalesceKey = netID;
+				Game::WriteUncompressedUint32( &miss, netID );
+				Game::WriteUncompressedUint16( &miss, tick );
+				sender.connection->AddMessage( miss );
+				return;
+			}
+			fieldSize = baseline->size;
+		}
+		history.Store( tick, fields, fieldSize );
+
+		if( baseTick == tick )
+		{
+			OwnedNetMessage confirm( eNetGameMessageType_NET_OBJECT_BASELINE_CONFIRM );
+			confirm.m_coalesceKey = netID;
+			Game::WriteUncompressedUint32( &confirm, netID );
+			Game::WriteUncompressedUint16( &confirm, tick );
+			sender.connection->AddMessage( confirm );
+		}
+
+		//Older than what we're showing, only keep it as a baseline
+		if( history.m_hasLastTick && !GreaterThanCycle( tick, (uint16_t) history.m_lastTick ) )
+		{
+			return;
+		}
+		history.m_lastTick = tick;
+		history.m_hasLastTick = true;
+
+		OwnedNetMessage update( eNetGameMessageType_NET_OBJECT_UPDATE );
+		update.WriteForward( fields, fieldSize );
+		update.Rewind( );
+		GameObject * object = netObject->GetLocalObject( );
+		object->UpdateFromMessage( sender, update );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// The client applied a full state, deltas for this object can start from it
+void OnBaselineConfirmReceived( NetSender const & sender, NetMessage const & message )
+{
+	if( g_GameSystem->IsHost( ) && sender.connection )
+	{
+		uint32_t netID;
+		uint16_t tick;
+		Game::ReadUncompressedUint32( message, &netID );
+		Game::ReadUncompressedUint16( message, &tick );
+		g_GameSystem->HostGetBaselines( sender.connection )->ConfirmApplied( netID, tick );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// The client dropped a delta it couldn't decode, this object goes back to full states
+void OnBaselineMissReceived( NetSender const & sender, NetMessage const & message )
+{
+	if( g_GameSystem->IsHost( ) && sender.connection )
+	{
+		uint32_t netID;
+		uint16_t tick;
+		Game::ReadUncompressedUint32( message, &netID );
+		Game::ReadUncompressedUint16( message, &tick );
+		g_GameSystem->HostGetBaselines( sender.connection )->ResetBaseline( netID, tick );
+	}
+}
+
+
 //-------------------------------------------------------------------------------------------------
 void OnGameStateMessageReceived( NetSender const & sender, NetMessage const & message )
 {
@@ -115,7 +269,7 @@ void OnInputMessageReceived( NetSender const & sender, NetMessage const & messag
 	{
 		eGameEvent inputPressed;
 		message.Read<eGameEvent>( &inputPressed );
-		byte_t playerIndex = sender.connection->GetIndex( );
+		byte_t playerIndex = (byte_t) sender.connection->GetIndex( );
 		
 		//Handle Eject Item Event
 		if( inputPressed == eGameEvent_EJECT_ITEM )
@@ -172,7 +326,7 @@ void OnInputMessageReceived( NetSender const & sender, NetMessage const & messag
 	{
 		uint16_t inputBitfield;
 		message.Read<uint16_t>( &inputBitfield );
-		byte_t playerIndex = sender.connection->GetIndex( );
+		byte_t playerIndex = (byte_t) sender.connection->GetIndex( );
 		g_GameSystem->HostApplyInputToPlayer( inputBitfield, playerIndex );
 	}
 }
\ No newline at end of file
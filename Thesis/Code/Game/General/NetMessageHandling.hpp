@@ -14,5 +14,10 @@ void OnUpdatePlayerReceived( NetSender const & sender, NetMessage const & messag
 void OnCreateMessageReceived( NetSender const & sender, NetMessage const & message );
 void OnDestroyMessageReceived( NetSender const & sender, NetMessage const & message );
 void OnUpdateMessageReceived( NetSender const & sender, NetMessage const & message );
+void OnDeltaUpdateMessageReceived( NetSender const & sender, NetMessage const & message );
+void OnCreateBatchReceived( NetSender const & sender, NetMessage const & message );
+void OnCatchupCompleteReceived( NetSender const & sender, NetMessage const & message );
+void OnBaselineConfirmReceived( NetSender const & sender, NetMessage const & message );
+void OnBaselineMissReceived( NetSender const & sender, NetMessage const & message );
 void OnGameStateMessageReceived( NetSender const & sender, NetMessage const & message );
 void OnInputMessageReceived( NetSender const & sender, NetMessage const & message );
\ No newline at end of file
@@ -1,9 +1,25 @@
 #include "Game/General/SessionCommands.hpp"
 
+#include "Engine/Core/Engine.hpp"
+#include "Engine/Core/TickScheduler.hpp"
+#include "Engine/Core/Time.hpp"
 #include "Engine/DebugSystem/Command.hpp"
 #include "Engine/DebugSystem/Console.hpp"
 #include "Engine/Net/NetworkSystem.hpp"
+#include "Engine/Net/Session/ConnectionLookup.hpp"
+#include "Engine/Net/Session/LinkEmulator.hpp"
+#include "Engine/Net/Session/NetConnection.hpp"
+#include "Engine/Net/Session/NetMessage.hpp"
+#include "Engine/Net/Session/NetPacket.hpp"
+#include "Engine/Net/Session/PacketCompressor.hpp"
+#include "Engine/Net/Session/RateController.hpp"
+#include "Engine/Net/Session/TrafficCapture.hpp"
+#include "Engine/Utils/BitPacker.hpp"
+#include "Engine/Utils/MathUtils.hpp"
+#include "Game/GameObjects/GameObject.hpp"
+#include "Game/General/BotSwarm.hpp"
 #include "Game/General/Game.hpp"
+#include "Game/General/InterestGrid.hpp"
 
 
 //-------------------------------------------------------------------------------------------------
@@ -18,7 +34,31 @@ void RegisterConsoleCommands( )
 
 	g_ConsoleSystem->RegisterCommand( "session_drop_rate", SessionDropRateCommand, " [rate] : Chance to drop incoming packet (0.0-1.0)." );
 	g_ConsoleSystem->RegisterCommand( "session_latency", SessionLatencyCommand, " [min] [max] : Delay before processing incoming packet (miliseconds)." );
+	g_ConsoleSystem->RegisterCommand( "session_link_profile", SessionLinkProfileCommand, " [name] [seed] : Emulate a network both ways, lists the profiles without a name. default seed = 1" );
+	g_ConsoleSystem->RegisterCommand( "session_link_stats", SessionLinkStatsCommand, " : Packets lost, queued out, duplicated and reordered by the emulated link since last socket stats reset." );
 	g_ConsoleSystem->RegisterCommand( "session_toggle_timeouts", SessionToggleTimeoutsCommand, " : Connections are automatically destroyed after a long time of no traffic." );
+	g_ConsoleSystem->RegisterCommand( "session_net_thread", SessionNetThreadCommand, " : Toggle receiving, acks and sending on a separate network thread, callbacks stay on the game thread." );
+	g_ConsoleSystem->RegisterCommand( "session_socket_stats", SessionSocketStatsCommand, " : Socket syscalls per tick and packets per second since last call." );
+	g_ConsoleSystem->RegisterCommand( "session_arena_stats", SessionArenaStatsCommand, " : Message arena bytes allocated last tick and live allocations." );
+	g_ConsoleSystem->RegisterCommand( "session_rtt_stats", SessionRTTStatsCommand, " : Smoothed round trip time, variance, resend timeout, resends and send rate for each connection." );
+	g_ConsoleSystem->RegisterCommand( "session_capture", SessionCaptureCommand, " [records] : Capture packet and message headers into a ring of this many records, 0 stops. default = 65536" );
+	g_ConsoleSystem->RegisterCommand( "session_capture_dump", SessionCaptureDumpCommand, " [file] : Write the capture ring to a binary file. default = Data/Logs/NetCapture.bin" );
+	g_ConsoleSystem->RegisterCommand( "session_capture_report", SessionCaptureReportCommand, " [capture] [report] : Per message type bandwidth from a capture file, as CSV. default = Data/Logs/NetCapture.bin | Data/Logs/NetCaptureReport.csv" );
+	g_ConsoleSystem->RegisterCommand( "session_telemetry", SessionTelemetryCommand, " : One JSON line per connection: round trip histogram, resends, reliable window, queue depths and per message type traffic." );
+	g_ConsoleSystem->RegisterCommand( "session_telemetry_export", SessionTelemetryExportCommand, " [seconds] [file] : Append session_telemetry lines to a file every interval, 0 stops. default = 1 | Data/Logs/NetTelemetry.jsonl" );
+	g_ConsoleSystem->RegisterCommand( "session_compress", SessionCompressCommand, " [dictionary] : Load a packet dictionary, connections that join with the same one send compressed packets, off clears it. Must be disconnected. default = Data/NetPacket.dict" );
+	g_ConsoleSystem->RegisterCommand( "session_compress_stats", SessionCompressStatsCommand, " : Packets compressed and skipped and the bytes saved since the last call." );
+	g_ConsoleSystem->RegisterCommand( "session_compress_sample", SessionCompressSampleCommand, " [packets] : Record the next sent packets to train a dictionary from, 0 stops. default = 5000" );
+	g_ConsoleSystem->RegisterCommand( "session_compress_save", SessionCompressSaveCommand, " [file] : Write the recorded packets to a file. default = Data/Logs/NetPacketSamples.bin" );
+	g_ConsoleSystem->RegisterCommand( "session_compress_train", SessionCompressTrainCommand, " [samples] [dictionary] [bytes] : Train a packet dictionary from recorded packets. default = Data/Logs/NetPacketSamples.bin | Data/NetPacket.dict | 8192" );
+	g_ConsoleSystem->RegisterCommand( "sim_tick_rate", SimTickRateCommand, " [simHz] [sendHz] [maxSubsteps] : Host simulation and packet send rates. default = 60 | 60 | 4" );
+	g_ConsoleSystem->RegisterCommand( "sim_tick_stats", SimTickStatsCommand, " : Ticks, overruns and dropped ticks for the simulation and send schedulers since the last call." );
+	g_ConsoleSystem->RegisterCommand( "bot_swarm_start", BotSwarmStartCommand, " [bots] [seconds] [joinsPerSecond] [file] : Join headless bots to this host and log load stats as CSV. default = 100 | 60 | 10 | Data/Logs/BotSwarm.csv" );
+	g_ConsoleSystem->RegisterCommand( "bot_swarm_stop", BotSwarmStopCommand, " : Bots leave and the CSV is closed." );
+	g_ConsoleSystem->RegisterCommand( "interest_benchmark", InterestBenchmarkCommand, " [players] [objects] [ticks] : Compare interest grid queries against brute force. default = 70 | 5000 | 60" );
+	g_ConsoleSystem->RegisterCommand( "session_lookup_benchmark", SessionLookupBenchmarkCommand, " [connections] [packets] : Compare per packet connection lookup, linear scan vs hashed. default = 250 | 1000000" );
+	g_ConsoleSystem->RegisterCommand( "bitpack_benchmark", BitPackBenchmarkCommand, " [objects] [iterations] : Compare ship update size and encode time, byte vs bit packing. default = 5000 | 20" );
+	g_ConsoleSystem->RegisterCommand( "compress_benchmark", CompressBenchmarkCommand, " [samples] [dictionary] [iterations] : Compression ratio and time per packet on recorded packets, with and without the dictionary. default = Data/Logs/NetPacketSamples.bin | Data/NetPacket.dict | 10" );
 
 	g_ConsoleSystem->RegisterCommand( "session_debug", SessionDebug, " : Debugs Connection traffic." );
 }
@@ -137,6 +177,69 @@ void SessionLatencyCommand( Command const & command )
 }
 
 
+//-------------------------------------------------------------------------------------------------
+void SessionLinkProfileCommand( Command const & command )
+{
+	if( !command.HasArg( 0 ) )
+	{
+		for( size_t presetIndex = 0; presetIndex < LinkProfile::GetPresetCount( ); ++presetIndex )
+		{
+			LinkProfile const & preset = LinkProfile::GetPreset( presetIndex );
+			g_ConsoleSystem->AddLog( Stringf( "%s: %.0f+-%.0fms loss=%.1f%%/%.0f%% dup=%.1f%% reorder=%.1f%% bw=%.0fKB/s mtu=%u",
+				preset.name,
+				preset.latency * 1000.0,
+				preset.jitter * 1000.0,
+				preset.goodLossRate * 100.f,
+				preset.badLossRate * 100.f,
+				preset.duplicateRate * 100.f,
+				preset.reorderRate * 100.f,
+				preset.bandwidth / 1024.0,
+				(unsigned int) preset.mtu ), Console::GOOD );
+		}
+		LinkEmulator const & current = Game::s_netSession->GetPacketChannel( ).GetOutgoingLink( );
+		g_ConsoleSystem->AddLog( Stringf( "Current: %s seed=%u", current.GetProfile( ).name, (unsigned int) current.GetSeed( ) ), Console::GOOD );
+		return;
+	}
+
+	std::string name = command.GetArg( 0, "none" );
+	unsigned int seed = command.GetArg( 1, (unsigned int) PacketChannel::DEFAULT_LINK_SEED );
+	LinkProfile const * profile = LinkProfile::FindPreset( name.c_str( ) );
+	if( profile == nullptr )
+	{
+		g_ConsoleSystem->AddLog( Stringf( "Unknown link profile: %s", name.c_str( ) ), Console::BAD );
+		return;
+	}
+
+	Game::s_netSession->SetLinkProfile( *profile, seed );
+	g_ConsoleSystem->AddLog( Stringf( "Set link profile: %s seed=%u", profile->name, seed ), Console::GOOD );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void SessionLinkStatsCommand( Command const & )
+{
+	PacketChannel const & channel = Game::s_netSession->GetPacketChannel( );
+	LinkEmulator const * links[2] = { &channel.GetOutgoingLink( ), &channel.GetIncomingLink( ) };
+	char const * directions[2] = { "Out", "In" };
+	for( size_t linkIndex = 0; linkIndex < 2; ++linkIndex )
+	{
+		LinkEmulatorStats const & stats = links[linkIndex]->GetStats( );
+		g_ConsoleSystem->AddLog( Stringf( "%s (%s): Sent=%u Delivered=%u Lost=%u (Burst=%u) QueueDrop=%u MTUDrop=%u Dup=%u Reorder=%u Held=%u",
+			directions[linkIndex],
+			links[linkIndex]->GetProfile( ).name,
+			(unsigned int) stats.submitted,
+			(unsigned int) stats.delivered,
+			(unsigned int) stats.lost,
+			(unsigned int) stats.burstLost,
+			(unsigned int) stats.queueDropped,
+			(unsigned int) stats.mtuDropped,
+			(unsigned int) stats.duplicated,
+			(unsigned int) stats.reordered,
+			(unsigned int) links[linkIndex]->GetHeldCount( ) ), Console::GOOD );
+	}
+}
+
+
 //-------------------------------------------------------------------------------------------------
 void SessionToggleTimeoutsCommand( Command const & )
 {
@@ -145,6 +248,722 @@ void SessionToggleTimeoutsCommand( Command const & )
 }
 
 
+//-------------------------------------------------------------------------------------------------
+void SessionNetThreadCommand( Command const & )
+{
+	if( Game::s_netSession->IsNetThreadRunning( ) )
+	{
+		Game::s_netSession->StopNetThread( );
+	}
+	else
+	{
+		Game::s_netSession->StartNetThread( );
+	}
+	g_ConsoleSystem->AddLog( Stringf( "Network thread: %s", Game::s_netSession->IsNetThreadRunning( ) ? "running" : "stopped" ), Console::GOOD );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void SessionSocketStatsCommand( Command const & )
+{
+	PacketChannelStats stats = Game::s_netSession->GetPacketChannel( ).GetStats( );
+	double elapsedSeconds = Time::GetCurrentTimeSeconds( ) - stats.startTime;
+	if( stats.ticks == 0 || elapsedSeconds <= 0.0 )
+	{
+		g_ConsoleSystem->AddLog( "No ticks recorded yet", Console::BAD );
+		return;
+	}
+
+	g_ConsoleSystem->AddLog( Stringf( "Ticks: %u over %.2fs", (unsigned int) stats.ticks, elapsedSeconds ), Console::GOOD );
+	g_ConsoleSystem->AddLog( Stringf( "Syscalls per tick: %.2f", (double) stats.syscallCount / (double) stats.ticks ), Console::GOOD );
+	g_ConsoleSystem->AddLog( Stringf( "Packets sent per second: %.1f", (double) stats.packetsSent / elapsedSeconds ), Console::GOOD );
+	g_ConsoleSystem->AddLog( Stringf( "Packets received per second: %.1f", (double) stats.packetsReceived / elapsedSeconds ), Console::GOOD );
+	Game::s_netSession->ResetSocketStats( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void SessionArenaStatsCommand( Command const & )
+{
+	NetMessageArena const & arena = Game::s_netSession->GetMessageArena( );
+	NetMessageArenaStats const & stats = arena.GetLastTickStats( );
+	g_ConsoleSystem->AddLog( Stringf( "Bytes allocated last tick: %u", (unsigned int) stats.bytesAllocated ), Console::GOOD );
+	g_ConsoleSystem->AddLog( Stringf( "Payload bytes copied last tick: %u", (unsigned int) stats.bytesCopied ), Console::GOOD );
+	g_ConsoleSystem->AddLog( Stringf( "Blocks allocated: %u, shared: %u", (unsigned int) stats.blocksAllocated, (unsigned int) stats.blocksShared ), Console::GOOD );
+	g_ConsoleSystem->AddLog( Stringf( "Live blocks: %u, live messages: %u, reserved: %u bytes", (unsigned int) arena.GetLiveBlockCount( ), (unsigned int) arena.GetLiveMessageCount( ), (unsigned int) arena.GetReservedBytes( ) ), Console::GOOD );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void SessionRTTStatsCommand( Command const & )
+{
+	bool anyConnection = false;
+	for( NetConnection * connection : Game::s_netSession->GetActiveConnections( ) )
+	{
+		if( connection->IsSelf( ) )
+		{
+			continue;
+		}
+
+		anyConnection = true;
+		g_ConsoleSystem->AddLog( Stringf( "[%u] %s: SRTT=%.1fms RTTVAR=%.1fms RTO=%.1fms Resends=%u Rate=%.1fKB/s",
+			(unsigned int) connection->GetIndex( ),
+			connection->GetUsername( ),
+			connection->GetRoundTripTime( ) * 1000.0,
+			connection->GetRoundTripTimeVariance( ) * 1000.0,
+			connection->GetResendTimeout( ) * 1000.0,
+			(unsigned int) connection->GetResendCount( ),
+			connection->GetRateController( )->GetSendRate( ) / 1024.0 ), Console::GOOD );
+	}
+
+	if( !anyConnection )
+	{
+		g_ConsoleSystem->AddLog( "No remote connections", Console::BAD );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void SessionCaptureCommand( Command const & command )
+{
+	int recordCount = command.GetArg( 0, (int) TrafficCapture::DEFAULT_RECORD_COUNT );
+	if( recordCount <= 0 )
+	{
+		Game::s_netSession->StopTrafficCapture( );
+		g_ConsoleSystem->AddLog( "Traffic capture stopped", Console::GOOD );
+		return;
+	}
+
+	Game::s_netSession->StartTrafficCapture( (size_t) recordCount );
+	g_ConsoleSystem->AddLog( Stringf( "Capturing traffic, newest %d records kept", recordCount ), Console::GOOD );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void SessionCaptureDumpCommand( Command const & command )
+{
+	std::string capturePath = command.GetArg( 0, "Data/Logs/NetCapture.bin" );
+	if( !Game::s_netSession->DumpTrafficCapture( capturePath.c_str( ) ) )
+	{
+		g_ConsoleSystem->AddLog( Stringf( "Could not write %s", capturePath.c_str( ) ), Console::BAD );
+		return;
+	}
+	g_ConsoleSystem->AddLog( Stringf( "Traffic capture written to %s", capturePath.c_str( ) ), Console::GOOD );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Offline, reads any capture file, no session needed
+void SessionCaptureReportCommand( Command const & command )
+{
+	std::string capturePath = command.GetArg( 0, "Data/Logs/NetCapture.bin" );
+	std::string reportPath = command.GetArg( 1, "Data/Logs/NetCaptureReport.csv" );
+	if( !TrafficCapture::WriteReport( capturePath.c_str( ), reportPath.c_str( ) ) )
+	{
+		g_ConsoleSystem->AddLog( Stringf( "Could not read %s or write %s", capturePath.c_str( ), reportPath.c_str( ) ), Console::BAD );
+		return;
+	}
+	g_ConsoleSystem->AddLog( Stringf( "Traffic report written to %s", reportPath.c_str( ) ), Console::GOOD );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Each line is its own log so a remote command server client gets them back as separate echoes
+void SessionTelemetryCommand( Command const & )
+{
+	std::string telemetry;
+	Game::s_netSession->WriteTelemetry( &telemetry );
+	if( telemetry.empty( ) )
+	{
+		g_ConsoleSystem->AddLog( "No remote connections", Console::BAD );
+		return;
+	}
+
+	std::vector<std::string> lines = SplitString( telemetry, '\n' );
+	for( std::string const & line : lines )
+	{
+		if( !line.empty( ) )
+		{
+			g_ConsoleSystem->AddLog( line, Console::GOOD );
+		}
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void SessionTelemetryExportCommand( Command const & command )
+{
+	float intervalSeconds = command.GetArg( 0, 1.f );
+	std::string telemetryPath = command.GetArg( 1, "Data/Logs/NetTelemetry.jsonl" );
+	if( intervalSeconds <= 0.f )
+	{
+		Game::s_netSession->StopTelemetryExport( );
+		g_ConsoleSystem->AddLog( "Telemetry export stopped", Console::GOOD );
+		return;
+	}
+
+	if( !Game::s_netSession->StartTelemetryExport( telemetryPath.c_str( ), intervalSeconds ) )
+	{
+		g_ConsoleSystem->AddLog( Stringf( "Could not open %s", telemetryPath.c_str( ) ), Console::BAD );
+		return;
+	}
+	g_ConsoleSystem->AddLog( Stringf( "Exporting telemetry to %s every %.2fs", telemetryPath.c_str( ), intervalSeconds ), Console::GOOD );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void SessionCompressCommand( Command const & command )
+{
+	std::string dictionaryPath = command.GetArg( 0, "Data/NetPacket.dict" );
+	PacketDictionary dictionary;
+	if( dictionaryPath != "off" && !dictionary.Load( dictionaryPath.c_str( ) ) )
+	{
+		g_ConsoleSystem->AddLog( Stringf( "Could not read %s", dictionaryPath.c_str( ) ), Console::BAD );
+		return;
+	}
+
+	if( !Game::s_netSession->SetPacketDictionary( dictionary ) )
+	{
+		g_ConsoleSystem->AddLog( "Leave the session first, connections agree on the dictionary when they join", Console::BAD );
+		return;
+	}
+
+	if( dictionary.IsEmpty( ) )
+	{
+		g_ConsoleSystem->AddLog( "Packet compression off", Console::GOOD );
+		return;
+	}
+	g_ConsoleSystem->AddLog( Stringf( "Packet dictionary %08x, %u bytes", dictionary.GetHash( ), (unsigned int) dictionary.GetSize( ) ), Console::GOOD );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void SessionCompressStatsCommand( Command const & )
+{
+	PacketCompressionStats stats = Game::s_netSession->GetCompressionStats( );
+	Game::s_netSession->ResetCompressionStats( );
+
+	double ratio = stats.rawBytes > 0 ? (double) stats.compressedBytes / (double) stats.rawBytes : 1.0;
+	g_ConsoleSystem->AddLog( Stringf( "Dictionary %08x: Compressed=%u Skipped=%u Raw=%uB Sent=%uB Ratio=%.3f",
+		Game::s_netSession->GetPacketDictionaryHash( ),
+		(unsigned int) stats.compressedCount,
+		(unsigned int) stats.skippedCount,
+		(unsigned int) stats.rawBytes,
+		(unsigned int) stats.compressedBytes,
+		ratio ), Console::GOOD );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void SessionCompressSampleCommand( Command const & command )
+{
+	int sampleCount = command.GetArg( 0, 5000 );
+	if( sampleCount <= 0 )
+	{
+		Game::s_netSession->StopPacketSampling( );
+		g_ConsoleSystem->AddLog( Stringf( "Packet sampling stopped, %u recorded", (unsigned int) Game::s_netSession->GetPacketSampleCount( ) ), Console::GOOD );
+		return;
+	}
+
+	Game::s_netSession->StartPacketSampling( (size_t) sampleCount );
+	g_ConsoleSystem->AddLog( Stringf( "Recording the next %d sent packets", sampleCount ), Console::GOOD );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void SessionCompressSaveCommand( Command const & command )
+{
+	std::string samplesPath = command.GetArg( 0, "Data/Logs/NetPacketSamples.bin" );
+	if( !Game::s_netSession->SavePacketSamples( samplesPath.c_str( ) ) )
+	{
+		g_ConsoleSystem->AddLog( Stringf( "Could not write %s", samplesPath.c_str( ) ), Console::BAD );
+		return;
+	}
+	g_ConsoleSystem->AddLog( Stringf( "%u packets written to %s", (unsigned int) Game::s_netSession->GetPacketSampleCount( ), samplesPath.c_str( ) ), Console::GOOD );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Offline, no session needed. Load the result on both ends with session_compress.
+void SessionCompressTrainCommand( Command const & command )
+{
+	std::string samplesPath = command.GetArg( 0, "Data/Logs/NetPacketSamples.bin" );
+	std::string dictionaryPath = command.GetArg( 1, "Data/NetPacket.dict" );
+	int dictionarySize = command.GetArg( 2, (int) PacketDictionary::DEFAULT_SIZE );
+
+	PacketSamples samples;
+	if( !samples.Load( samplesPath.c_str( ) ) )
+	{
+		g_ConsoleSystem->AddLog( Stringf( "Could not read %s", samplesPath.c_str( ) ), Console::BAD );
+		return;
+	}
+
+	PacketDictionary dictionary;
+	if( dictionarySize <= 0 || !PacketDictionary::Train( samples, (size_t) dictionarySize, &dictionary ) )
+	{
+		g_ConsoleSystem->AddLog( "Nothing repeats across the samples to train on", Console::BAD );
+		return;
+	}
+	if( !dictionary.Save( dictionaryPath.c_str( ) ) )
+	{
+		g_ConsoleSystem->AddLog( Stringf( "Could not write %s", dictionaryPath.c_str( ) ), Console::BAD );
+		return;
+	}
+	g_ConsoleSystem->AddLog( Stringf( "Dictionary %08x, %u bytes from %u packets, written to %s",
+		dictionary.GetHash( ),
+		(unsigned int) dictionary.GetSize( ),
+		(unsigned int) samples.GetCount( ),
+		dictionaryPath.c_str( ) ), Console::GOOD );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void SimTickRateCommand( Command const & command )
+{
+	float simRate = command.GetArg( 0, 60.f );
+	float sendRate = command.GetArg( 1, 60.f );
+	int maxSubsteps = command.GetArg( 2, (int) Game::MAX_SIM_SUBSTEPS );
+	if( simRate <= 0.f || sendRate <= 0.f || maxSubsteps < 1 )
+	{
+		g_ConsoleSystem->AddLog( "Rates must be above zero and substeps at least one", Console::BAD );
+		return;
+	}
+
+	TickScheduler & simScheduler = g_GameSystem->m_simScheduler;
+	simScheduler.SetRate( (double) simRate );
+	simScheduler.SetMaxSubsteps( (size_t) maxSubsteps );
+	Game::s_netSession->SetSendRate( (double) sendRate );
+
+	//Dedicated frames follow the simulation
+	if( g_GameSystem->m_isDedicatedServer )
+	{
+		g_EngineSystem->SetTargetFPS( (double) simRate );
+	}
+	g_ConsoleSystem->AddLog( Stringf( "Simulation: %.1fHz up to %d substeps, send: %.1fHz", simRate, maxSubsteps, sendRate ), Console::GOOD );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+static void LogTickStats( char const * name, TickScheduler const & scheduler )
+{
+	TickSchedulerStats const & stats = scheduler.GetStats( );
+	double averageSeconds = stats.ticks > 0 ? stats.totalTickSeconds / (double) stats.ticks : 0.0;
+	g_ConsoleSystem->AddLog( Stringf( "%s %.1fHz: Ticks=%u Overruns=%u Dropped=%u Avg=%.3fms Max=%.3fms",
+		name,
+		scheduler.GetRate( ),
+		(unsigned int) stats.ticks,
+		(unsigned int) stats.overruns,
+		(unsigned int) stats.droppedTicks,
+		averageSeconds * 1000.0,
+		stats.maxTickSeconds * 1000.0 ), Console::GOOD );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void SimTickStatsCommand( Command const & )
+{
+	LogTickStats( "Simulation", g_GameSystem->m_simScheduler );
+	g_GameSystem->m_simScheduler.ResetStats( );
+
+	Game::s_netSession->LockNetThread( );
+	LogTickStats( "Send", Game::s_netSession->GetSendScheduler( ) );
+	Game::s_netSession->UnlockNetThread( );
+	Game::s_netSession->ResetSendStats( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void BotSwarmStartCommand( Command const & command )
+{
+	if( !Game::s_netSession->IsHost( ) )
+	{
+		g_ConsoleSystem->AddLog( "Host a game first, bots join this process's host", Console::BAD );
+		return;
+	}
+	if( Game::s_botSwarm )
+	{
+		g_ConsoleSystem->AddLog( "Bot swarm already running", Console::BAD );
+		return;
+	}
+
+	int botCount = command.GetArg( 0, 100 );
+	float durationSeconds = command.GetArg( 1, 60.f );
+	float joinsPerSecond = command.GetArg( 2, 10.f );
+	std::string csvPath = command.GetArg( 3, "Data/Logs/BotSwarm.csv" );
+
+	//Host takes a connection index too
+	int maxBots = (int) Game::MAX_PLAYERS - 1;
+	botCount = Clamp( botCount, 1, maxBots );
+
+	Game::s_botSwarm = new BotSwarm( Game::s_netSession, (size_t) botCount, (double) durationSeconds, (double) joinsPerSecond, csvPath.c_str( ) );
+	g_ConsoleSystem->AddLog( Stringf( "Bot swarm: %d bots for %.0fs, writing %s", botCount, durationSeconds, csvPath.c_str( ) ), Console::GOOD );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void BotSwarmStopCommand( Command const & )
+{
+	if( Game::s_botSwarm == nullptr )
+	{
+		g_ConsoleSystem->AddLog( "No bot swarm running", Console::BAD );
+		return;
+	}
+
+	//Game::Update cleans it up once finished
+	Game::s_botSwarm->Finish( );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Replays random movement for a crowded server, timing grid relevance queries against the
+// original check of every object for every player
+void InterestBenchmarkCommand( Command const & command )
+{
+	int playerCount = command.GetArg( 0, 70 );
+	int objectCount = command.GetArg( 1, 5000 );
+	int tickCount = command.GetArg( 2, 60 );
+	if( playerCount <= 0 || objectCount <= 0 || tickCount <= 0 )
+	{
+		return;
+	}
+
+	float const relevanceRadius = 10.f;
+	float const mapRadius = Game::MAX_MAP_RADIUS;
+	float const tickSeconds = 1.f / 60.f;
+
+	std::vector<Vector2f> playerPositions( playerCount );
+	std::vector<Vector2f> objectPositions( objectCount );
+	std::vector<Vector2f> objectVelocities( objectCount );
+	for( int playerIndex = 0; playerIndex < playerCount; ++playerIndex )
+	{
+		playerPositions[playerIndex] = RandomFloat( mapRadius ) * RandomUnitVectorCircle( );
+	}
+
+	InterestGrid grid( mapRadius + 10.f, Game::INTEREST_CELL_SIZE );
+	std::vector<size_t> proxies( objectCount );
+	for( int objectIndex = 0; objectIndex < objectCount; ++objectIndex )
+	{
+		objectPositions[objectIndex] = RandomFloat( mapRadius ) * RandomUnitVectorCircle( );
+		objectVelocities[objectIndex] = RandomFloat( 2.f, 20.f ) * RandomUnitVectorCircle( );
+		proxies[objectIndex] = grid.AddProxy( &objectPositions[objectIndex], objectPositions[objectIndex] );
+	}
+
+	double gridSeconds = 0.0;
+	double bruteSeconds = 0.0;
+	size_t gridRelevant = 0;
+	size_t bruteRelevant = 0;
+	size_t gridCandidates = 0;
+	std::vector<void*> results;
+	float radiusSquared = relevanceRadius * relevanceRadius;
+	for( int tick = 0; tick < tickCount; ++tick )
+	{
+		//Move everything, bounce off the edge of the map
+		double startTime = Time::GetCurrentTimeSeconds( );
+		for( int objectIndex = 0; objectIndex < objectCount; ++objectIndex )
+		{
+			Vector2f & position = objectPositions[objectIndex];
+			position += tickSeconds * objectVelocities[objectIndex];
+			if( position.SquareLength( ) > mapRadius * mapRadius )
+			{
+				objectVelocities[objectIndex] = -objectVelocities[objectIndex];
+			}
+			grid.MoveProxy( proxies[objectIndex], position );
+		}
+		for( int playerIndex = 0; playerIndex < playerCount; ++playerIndex )
+		{
+			results.clear( );
+			grid.Query( playerPositions[playerIndex], relevanceRadius, &results );
+			gridCandidates += results.size( );
+			for( size_t resultIndex = 0; resultIndex < results.size( ); ++resultIndex )
+			{
+				Vector2f const * position = (Vector2f const *) results[resultIndex];
+				if( DistanceBetweenPointsSquared( playerPositions[playerIndex], *position ) <= radiusSquared )
+				{
+					++gridRelevant;
+				}
+			}
+		}
+		gridSeconds += Time::GetCurrentTimeSeconds( ) - startTime;
+
+		startTime = Time::GetCurrentTimeSeconds( );
+		for( int playerIndex = 0; playerIndex < playerCount; ++playerIndex )
+		{
+			for( int objectIndex = 0; objectIndex < objectCount; ++objectIndex )
+			{
+				if( DistanceBetweenPointsSquared( playerPositions[playerIndex], objectPositions[objectIndex] ) <= radiusSquared )
+				{
+					++bruteRelevant;
+				}
+			}
+		}
+		bruteSeconds += Time::GetCurrentTimeSeconds( ) - startTime;
+	}
+
+	g_ConsoleSystem->AddLog( Stringf( "%d players, %d objects, %d ticks", playerCount, objectCount, tickCount ), Console::GOOD );
+	g_ConsoleSystem->AddLog( Stringf( "Grid: %.3fms per tick (includes cell updates), %.1f candidates per player", gridSeconds * 1000.0 / tickCount, (double) gridCandidates / ( tickCount * playerCount ) ), Console::GOOD );
+	g_ConsoleSystem->AddLog( Stringf( "Brute force: %.3fms per tick", bruteSeconds * 1000.0 / tickCount ), Console::GOOD );
+	g_ConsoleSystem->AddLog( Stringf( "Relevant matches: grid %u, brute force %u", (unsigned int) gridRelevant, (unsigned int) bruteRelevant ), gridRelevant == bruteRelevant ? Console::GOOD : Console::BAD );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Resolves the sender of simulated incoming packets the old way (scan every slot) and the new
+// ways (header index checked against the address, hashed address lookup)
+void SessionLookupBenchmarkCommand( Command const & command )
+{
+	int connectionCount = command.GetArg( 0, 250 );
+	int packetCount = command.GetArg( 1, 1000000 );
+	if( connectionCount <= 0 || packetCount <= 0 )
+	{
+		return;
+	}
+	if( connectionCount > (int) ConnectionLookup::MAX_CONNECTIONS )
+	{
+		connectionCount = (int) ConnectionLookup::MAX_CONNECTIONS;
+	}
+
+	//Slots hold pointers like NetSession::m_connections, so the scan pays the same indirection
+	ConnectionLookup * lookup = new ConnectionLookup( );
+	sockaddr_in * slots[ConnectionLookup::MAX_CONNECTIONS] = { nullptr };
+	for( int index = 0; index < connectionCount; ++index )
+	{
+		sockaddr_in * address = new sockaddr_in( );
+		address->sin_family = AF_INET;
+		address->sin_addr.s_addr = (uint32_t) RandomIntZeroToMax( );
+		address->sin_port = (uint16_t) RandomInt( 1024, 65535 );
+		slots[index] = address;
+		lookup->Add( (uint16_t) index, *address, Stringf( "client%d", index ).c_str( ) );
+	}
+
+	//Each packet's from address is its own copy, like the one recvfrom fills in
+	std::vector<uint16_t> senders( packetCount );
+	std::vector<sockaddr_in> fromAddresses( packetCount );
+	for( int packetIndex = 0; packetIndex < packetCount; ++packetIndex )
+	{
+		senders[packetIndex] = (uint16_t) RandomInt( connectionCount );
+		fromAddresses[packetIndex] = *slots[senders[packetIndex]];
+	}
+
+	size_t scanFound = 0;
+	double startTime = Time::GetCurrentTimeSeconds( );
+	for( int packetIndex = 0; packetIndex < packetCount; ++packetIndex )
+	{
+		sockaddr_in const & from = fromAddresses[packetIndex];
+		for( size_t index = 0; index < ConnectionLookup::MAX_CONNECTIONS; ++index )
+		{
+			if( slots[index] && IsEqual( *slots[index], from ) )
+			{
+				++scanFound;
+				break;
+			}
+		}
+	}
+	double scanSeconds = Time::GetCurrentTimeSeconds( ) - startTime;
+
+	size_t headerFound = 0;
+	startTime = Time::GetCurrentTimeSeconds( );
+	for( int packetIndex = 0; packetIndex < packetCount; ++packetIndex )
+	{
+		uint16_t fromConnIndex = senders[packetIndex];
+		sockaddr_in const & from = fromAddresses[packetIndex];
+		if( slots[fromConnIndex] && IsEqual( *slots[fromConnIndex], from ) )
+		{
+			++headerFound;
+		}
+	}
+	double headerSeconds = Time::GetCurrentTimeSeconds( ) - startTime;
+
+	size_t hashFound = 0;
+	startTime = Time::GetCurrentTimeSeconds( );
+	for( int packetIndex = 0; packetIndex < packetCount; ++packetIndex )
+	{
+		if( lookup->FindAddress( fromAddresses[packetIndex] ) == senders[packetIndex] )
+		{
+			++hashFound;
+		}
+	}
+	double hashSeconds = Time::GetCurrentTimeSeconds( ) - startTime;
+
+	for( int index = 0; index < connectionCount; ++index )
+	{
+		delete slots[index];
+	}
+	delete lookup;
+
+	double const nanoseconds = 1000000000.0 / packetCount;
+	g_ConsoleSystem->AddLog( Stringf( "%d connections, %d packets", connectionCount, packetCount ), Console::GOOD );
+	g_ConsoleSystem->AddLog( Stringf( "Linear scan: %.1fns per packet", scanSeconds * nanoseconds ), Console::GOOD );
+	g_ConsoleSystem->AddLog( Stringf( "Header index: %.1fns per packet", headerSeconds * nanoseconds ), Console::GOOD );
+	g_ConsoleSystem->AddLog( Stringf( "Hashed address: %.1fns per packet", hashSeconds * nanoseconds ), Console::GOOD );
+	bool allFound = scanFound == (size_t) packetCount && headerFound == (size_t) packetCount && hashFound == (size_t) packetCount;
+	g_ConsoleSystem->AddLog( Stringf( "Resolved: scan %u, header %u, hashed %u", (unsigned int) scanFound, (unsigned int) headerFound, (unsigned int) hashFound ), allFound ? Console::GOOD : Console::BAD );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Encodes the fields of a Ship update both ways. The byte path is the old per-field layout.
+void BitPackBenchmarkCommand( Command const & command )
+{
+	int objectCount = command.GetArg( 0, 5000 );
+	int iterationCount = command.GetArg( 1, 20 );
+	if( objectCount <= 0 || iterationCount <= 0 )
+	{
+		return;
+	}
+
+	float const mapRadius = Game::MAX_MAP_RADIUS;
+	std::vector<Vector2f> positions( objectCount );
+	std::vector<Vector2f> velocities( objectCount );
+	std::vector<float> rotations( objectCount );
+	std::vector<uint16_t> stats( objectCount );
+	std::vector<bool> flags( objectCount );
+	for( int objectIndex = 0; objectIndex < objectCount; ++objectIndex )
+	{
+		positions[objectIndex] = RandomFloat( mapRadius ) * RandomUnitVectorCircle( );
+		velocities[objectIndex] = RandomFloat( Game::MAX_SPEED ) * RandomUnitVectorCircle( );
+		rotations[objectIndex] = RandomFloat( 360.f );
+		stats[objectIndex] = (uint16_t) RandomInt( 0, 500 );
+		flags[objectIndex] = RandomInt( 2 ) == 0;
+	}
+
+	size_t byteTotal = 0;
+	double byteSeconds = 0.0;
+	size_t bitTotal = 0;
+	double bitSeconds = 0.0;
+	for( int iteration = 0; iteration < iterationCount; ++iteration )
+	{
+		double startTime = Time::GetCurrentTimeSeconds( );
+		for( int objectIndex = 0; objectIndex < objectCount; ++objectIndex )
+		{
+			OwnedNetMessage update( eNetGameMessageType_NET_OBJECT_UPDATE );
+			Game::WriteCompressedPosition( &update, positions[objectIndex] );
+			Game::WriteCompressedVelocity( &update, velocities[objectIndex] );
+			Game::WriteCompressedRotation( &update, rotations[objectIndex] );
+			Game::WriteUncompressedUint16( &update, stats[objectIndex] );
+			Game::WriteUncompressedUint16( &update, stats[objectIndex] );
+			Game::WriteUncompressedUint16( &update, stats[objectIndex] );
+			Game::WriteCompressedBoolean( &update, flags[objectIndex] );
+			byteTotal += update.GetPayloadSize( );
+		}
+		byteSeconds += Time::GetCurrentTimeSeconds( ) - startTime;
+
+		startTime = Time::GetCurrentTimeSeconds( );
+		for( int objectIndex = 0; objectIndex < objectCount; ++objectIndex )
+		{
+			OwnedNetMessage update( eNetGameMessageType_NET_OBJECT_UPDATE );
+			byte_t stateBuffer[GameObject::MAX_NET_STATE_SIZE];
+			BitPacker bits( stateBuffer, GameObject::MAX_NET_STATE_SIZE );
+			Game::WriteCompressedPosition( &bits, positions[objectIndex] );
+			Game::WriteCompressedVelocity( &bits, velocities[objectIndex] );
+			Game::WriteCompressedRotation( &bits, rotations[objectIndex] );
+			Game::WriteCompressedUint16( &bits, stats[objectIndex] );
+			Game::WriteCompressedUint16( &bits, stats[objectIndex] );
+			Game::WriteCompressedUint16( &bits, stats[objectIndex] );
+			Game::WriteCompressedBoolean( &bits, flags[objectIndex] );
+			update.WriteBits( bits );
+			bitTotal += update.GetPayloadSize( );
+		}
+		bitSeconds += Time::GetCurrentTimeSeconds( ) - startTime;
+	}
+
+	double encodeCount = (double) objectCount * iterationCount;
+	g_ConsoleSystem->AddLog( Stringf( "%d ship updates, %d iterations", objectCount, iterationCount ), Console::GOOD );
+	g_ConsoleSystem->AddLog( Stringf( "Byte packed: %.2f bytes, %.1fns per object", byteTotal / encodeCount, byteSeconds * 1000000000.0 / encodeCount ), Console::GOOD );
+	g_ConsoleSystem->AddLog( Stringf( "Bit packed: %.2f bytes, %.1fns per object", bitTotal / encodeCount, bitSeconds * 1000000000.0 / encodeCount ), Console::GOOD );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Sizes as NetSession::SendPacket() would send them: the header stays raw, and a packet that
+// doesn't shrink goes out as it was
+static void LogCompressBenchmark( char const * name, PacketSamples const & samples, PacketDictionary const * dictionary, int iterationCount )
+{
+	size_t rawTotal = 0;
+	size_t sentTotal = 0;
+	size_t skippedCount = 0;
+	size_t mismatchCount = 0;
+	double compressSeconds = 0.0;
+	double decompressSeconds = 0.0;
+	for( int iteration = 0; iteration < iterationCount; ++iteration )
+	{
+		for( size_t sampleIndex = 0; sampleIndex < samples.GetCount( ); ++sampleIndex )
+		{
+			size_t sampleSize;
+			byte_t const * sample = samples.GetSample( sampleIndex, &sampleSize );
+			rawTotal += NetPacket::HEADER_SIZE + sampleSize;
+
+			byte_t compressed[NetPacket::MAX_SIZE];
+			double startTime = Time::GetCurrentTimeSeconds( );
+			size_t compressedSize = sampleSize > 2 ? PacketCompressor::Compress( dictionary, sample, sampleSize, compressed, sampleSize - 2 ) : 0;
+			compressSeconds += Time::GetCurrentTimeSeconds( ) - startTime;
+			if( compressedSize == 0 )
+			{
+				++skippedCount;
+				sentTotal += NetPacket::HEADER_SIZE + sampleSize;
+				continue;
+			}
+			sentTotal += NetPacket::HEADER_SIZE + 1 + compressedSize;
+
+			byte_t expanded[NetPacket::MAX_SIZE];
+			startTime = Time::GetCurrentTimeSeconds( );
+			size_t expandedSize = PacketCompressor::Decompress( dictionary, compressed, compressedSize, expanded, NetPacket::MAX_SIZE );
+			decompressSeconds += Time::GetCurrentTimeSeconds( ) - startTime;
+			if( expandedSize != sampleSize || memcmp( expanded, sample, sampleSize ) != 0 )
+			{
+				++mismatchCount;
+			}
+		}
+	}
+
+	double packetCount = (double) samples.GetCount( ) * iterationCount;
+	g_ConsoleSystem->AddLog( Stringf( "%s: Ratio=%.3f Skipped=%.1f%% Compress=%.2fus Decompress=%.2fus per packet",
+		name,
+		rawTotal > 0 ? (double) sentTotal / (double) rawTotal : 1.0,
+		skippedCount * 100.0 / packetCount,
+		compressSeconds * 1000000.0 / packetCount,
+		decompressSeconds * 1000000.0 / packetCount ), mismatchCount == 0 ? Console::GOOD : Console::BAD );
+	if( mismatchCount > 0 )
+	{
+		g_ConsoleSystem->AddLog( Stringf( "%u packets did not survive the round trip", (unsigned int) mismatchCount ), Console::BAD );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void CompressBenchmarkCommand( Command const & command )
+{
+	std::string samplesPath = command.GetArg( 0, "Data/Logs/NetPacketSamples.bin" );
+	std::string dictionaryPath = command.GetArg( 1, "Data/NetPacket.dict" );
+	int iterationCount = command.GetArg( 2, 10 );
+	if( iterationCount <= 0 )
+	{
+		return;
+	}
+
+	PacketSamples samples;
+	if( !samples.Load( samplesPath.c_str( ) ) || samples.GetCount( ) == 0 )
+	{
+		g_ConsoleSystem->AddLog( Stringf( "Could not read %s", samplesPath.c_str( ) ), Console::BAD );
+		return;
+	}
+
+	g_ConsoleSystem->AddLog( Stringf( "%u recorded packets, %.1f bytes average, %d iterations",
+		(unsigned int) samples.GetCount( ),
+		NetPacket::HEADER_SIZE + samples.GetTotalSize( ) / (double) samples.GetCount( ),
+		iterationCount ), Console::GOOD );
+	LogCompressBenchmark( "No dictionary", samples, nullptr, iterationCount );
+
+	//Benchmarking against its own training set flatters the dictionary, record a separate session for it
+	PacketDictionary dictionary;
+	if( !dictionary.Load( dictionaryPath.c_str( ) ) )
+	{
+		g_ConsoleSystem->AddLog( Stringf( "Could not read %s, no dictionary results", dictionaryPath.c_str( ) ), Console::BAD );
+		return;
+	}
+	LogCompressBenchmark( Stringf( "Dictionary %08x", dictionary.GetHash( ) ).c_str( ), samples, &dictionary, iterationCount );
+}
+
+
 //-------------------------------------------------------------------------------------------------
 void SessionDebug( Command const & )
 {
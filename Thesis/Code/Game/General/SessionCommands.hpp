@@ -17,5 +17,29 @@ void SessionCreateConnectionCommand( Command const & );
 
 void SessionDropRateCommand( Command const & );
 void SessionLatencyCommand( Command const & );
+void SessionLinkProfileCommand( Command const & );
+void SessionLinkStatsCommand( Command const & );
 void SessionToggleTimeoutsCommand( Command const & );
+void SessionNetThreadCommand( Command const & );
+void SessionSocketStatsCommand( Command const & );
+void SessionArenaStatsCommand( Command const & );
+void SessionRTTStatsCommand( Command const & );
+void SessionCaptureCommand( Command const & );
+void SessionCaptureDumpCommand( Command const & );
+void SessionCaptureReportCommand( Command const & );
+void SessionTelemetryCommand( Command const & );
+void SessionTelemetryExportCommand( Command const & );
+void SessionCompressCommand( Command const & );
+void SessionCompressStatsCommand( Command const & );
+void SessionCompressSampleCommand( Command const & );
+void SessionCompressSaveCommand( Command const & );
+void SessionCompressTrainCommand( Command const & );
+void SimTickRateCommand( Command const & );
+void SimTickStatsCommand( Command const & );
+void BotSwarmStartCommand( Command const & );
+void BotSwarmStopCommand( Command const & );
+void InterestBenchmarkCommand( Command const & );
+void SessionLookupBenchmarkCommand( Command const & );
+void BitPackBenchmarkCommand( Command const & );
+void CompressBenchmarkCommand( Command const & );
 void SessionDebug( Command const & );
\ No newline at end of file
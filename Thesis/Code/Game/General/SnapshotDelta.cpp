@@ -0,0 +1,280 @@
+#include "Game/General/SnapshotDelta.hpp"
+
+#include "Engine/Net/Session/NetMessage.hpp"
+#include "Engine/Utils/MathUtils.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+static size_t const LANE_SIZE = 2;
+static size_t const MAX_MASK_BYTES = ( SnapshotState::MAX_STATE_SIZE / LANE_SIZE + 7 ) / 8;
+
+
+//-------------------------------------------------------------------------------------------------
+SnapshotHistory::SnapshotHistory( )
+	: m_lastTick( 0 )
+	, m_hasLastTick( false )
+	, m_sendPriority( 0.f )
+	, m_baselineConfirmed( false )
+	, m_baselineFloor( 0 )
+{
+	for( size_t stateIndex = 0; stateIndex < HISTORY_SIZE; ++stateIndex )
+	{
+		m_states[stateIndex].valid = false;
+		m_states[stateIndex].acked = false;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+SnapshotState * SnapshotHistory::Store( uint32_t tick, byte_t const * data, size_t size )
+{
+	SnapshotState & state = m_states[tick % HISTORY_SIZE];
+	state.tick = tick;
+	state.valid = true;
+	state.acked = false;
+	state.size = (byte_t) size;
+	memcpy( state.data, data, size );
+	return &state;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Only the low 16 bits of the tick are sent, which is all the client ever stores
+SnapshotState const * SnapshotHistory::Find( uint16_t tick ) const
+{
+	SnapshotState const & state = m_states[tick % HISTORY_SIZE];
+	if( state.valid && (uint16_t) state.tick == tick )
+	{
+		return &state;
+	}
+	return nullptr;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+SnapshotState const * SnapshotHistory::FindNewestAcked( uint32_t currentTick ) const
+{
+	SnapshotState const * newest = nullptr;
+	for( size_t stateIndex = 0; stateIndex < HISTORY_SIZE; ++stateIndex )
+	{
+		SnapshotState const & state = m_states[stateIndex];
+		if( !state.valid || !state.acked || currentTick - state.tick > MAX_BASELINE_AGE )
+		{
+			continue;
+		}
+		if( newest == nullptr || state.tick > newest->tick )
+		{
+			newest = &state;
+		}
+	}
+	return newest;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void SnapshotHistory::MarkAcked( uint32_t tick )
+{
+	SnapshotState & state = m_states[tick % HISTORY_SIZE];
+	if( state.valid && state.tick == tick )
+	{
+		state.acked = true;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void SnapshotHistory::ClearAcked( )
+{
+	for( size_t stateIndex = 0; stateIndex < HISTORY_SIZE; ++stateIndex )
+	{
+		m_states[stateIndex].acked = false;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+ConnectionBaselines::ConnectionBaselines( )
+	: m_nextTag( NetMessage::NO_DELIVERY_TAG + 1 )
+{
+	for( size_t recordIndex = 0; recordIndex < MAX_RECORDS; ++recordIndex )
+	{
+		m_records[recordIndex].tag = NetMessage::NO_DELIVERY_TAG;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+SnapshotHistory & ConnectionBaselines::GetHistory( size_t netID )
+{
+	return m_objects[netID];
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// Next delivery tag for this connection, other tagged messages take theirs here too so they
+// never match a record
+uint32_t ConnectionBaselines::TakeTag( )
+{
+	uint32_t tag = m_nextTag;
+	++m_nextTag;
+	if( m_nextTag == NetMessage::NO_DELIVERY_TAG )
+	{
+		++m_nextTag;
+	}
+	return tag;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+uint32_t ConnectionBaselines::AddRecord( size_t netID, uint32_t tick )
+{
+	uint32_t tag = TakeTag( );
+	DeliveryRecord & record = m_records[tag % MAX_RECORDS];
+	record.tag = tag;
+	record.netID = netID;
+	record.tick = tick;
+	return tag;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void ConnectionBaselines::ConfirmDelivery( uint32_t tag )
+{
+	//Record was reused before the ack came back, nothing to confirm
+	DeliveryRecord const & record = m_records[tag % MAX_RECORDS];
+	if( record.tag != tag )
+	{
+		return;
+	}
+
+	//Transport acks only count once the client has applied a state of ours, and only for states
+	//sent since, which it decodes against that one
+	auto found = m_objects.find( record.netID );
+	if( found == m_objects.end( ) )
+	{
+		return;
+	}
+
+	SnapshotHistory & history = found->second;
+	if( history.m_baselineConfirmed && record.tick >= history.m_baselineFloor )
+	{
+		history.MarkAcked( record.tick );
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// The client applied this state, so deltas against it are safe. The first one confirmed starts
+// the run of states that transport acks can build on.
+void ConnectionBaselines::ConfirmApplied( size_t netID, uint16_t tick )
+{
+	auto found = m_objects.find( netID );
+	if( found == m_objects.end( ) )
+	{
+		return;
+	}
+
+	//Fell out of the history, or from before a reset
+	SnapshotHistory & history = found->second;
+	SnapshotState const * state = history.Find( tick );
+	if( state == nullptr || state->tick < history.m_baselineFloor )
+	{
+		return;
+	}
+
+	history.MarkAcked( state->tick );
+	if( !history.m_baselineConfirmed )
+	{
+		history.m_baselineConfirmed = true;
+		history.m_baselineFloor = state->tick;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+// The client couldn't decode the delta sent on missedTick. Nothing sent so far is trusted, full
+// states go out until the client confirms one again.
+void ConnectionBaselines::ResetBaseline( size_t netID, uint16_t missedTick )
+{
+	auto found = m_objects.find( netID );
+	if( found == m_objects.end( ) )
+	{
+		return;
+	}
+
+	//Already reset since that delta went out
+	SnapshotHistory & history = found->second;
+	SnapshotState const * missed = history.Find( missedTick );
+	if( missed == nullptr || missed->tick < history.m_baselineFloor || !history.m_baselineConfirmed )
+	{
+		return;
+	}
+
+	history.ClearAcked( );
+	history.m_baselineConfirmed = false;
+	history.m_baselineFloor = history.m_lastTick + 1;
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void ConnectionBaselines::RemoveObject( size_t netID )
+{
+	m_objects.erase( netID );
+}
+
+
+//-------------------------------------------------------------------------------------------------
+void WriteSnapshotDelta( NetMessage * out_message, SnapshotState const & baseline, byte_t const * data, size_t size )
+{
+	size_t laneCount = ( size + LANE_SIZE - 1 ) / LANE_SIZE;
+	size_t maskBytes = ( laneCount + 7 ) / 8;
+	uint8_t mask[MAX_MASK_BYTES] = { 0 };
+
+	for( size_t laneIndex = 0; laneIndex < laneCount; ++laneIndex )
+	{
+		size_t offset = laneIndex * LANE_SIZE;
+		size_t laneSize = Min( LANE_SIZE, size - offset );
+		if( memcmp( baseline.data + offset, data + offset, laneSize ) != 0 )
+		{
+			SetBit( &mask[laneIndex / 8], laneIndex % 8 );
+		}
+	}
+
+	out_message->WriteForward( mask, maskBytes );
+	for( size_t laneIndex = 0; laneIndex < laneCount; ++laneIndex )
+	{
+		if( IsBitSet( mask[laneIndex / 8], laneIndex % 8 ) )
+		{
+			size_t offset = laneIndex * LANE_SIZE;
+			out_message->WriteForward( data + offset, Min( LANE_SIZE, size - offset ) );
+		}
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------------
+bool ReadSnapshotDelta( NetMessage const & message, SnapshotState const & baseline, byte_t * out_data )
+{
+	size_t size = baseline.size;
+	size_t laneCount = ( size + LANE_SIZE - 1 ) / LANE_SIZE;
+	size_t maskBytes = ( laneCount + 7 ) / 8;
+	uint8_t mask[MAX_MASK_BYTES];
+	if( !message.ReadForward( mask, maskBytes ) )
+	{
+		return false;
+	}
+
+	memcpy( out_data, baseline.data, size );
+	for( size_t laneIndex = 0; laneIndex < laneCount; ++laneIndex )
+	{
+		if( IsBitSet( mask[laneIndex / 8], laneIndex % 8 ) )
+		{
+			size_t offset = laneIndex * LANE_SIZE;
+			if( !message.ReadForward( out_data + offset, Min( LANE_SIZE, size - offset ) ) )
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <map>
+#include "Game/General/GameCommon.hpp"
+
+
+//-------------------------------------------------------------------------------------------------
+class NetGameObject;
+class NetMessage;
+
+
+//-------------------------------------------------------------------------------------------------
+// One encoded object update, without its net ID
+class SnapshotState
+{
+public:
+	static size_t const MAX_STATE_SIZE = 64;
+
+public:
+	uint32_t tick;
+	bool valid;
+	bool acked;
+	byte_t size;
+	byte_t data[MAX_STATE_SIZE];
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Recent states of one object, slotted by tick. The host keeps one per object per connection to
+// know what the client has acked, the client keeps one per object to rebuild deltas.
+class SnapshotHistory
+{
+//-------------------------------------------------------------------------------------------------
+// Static Members
+//-------------------------------------------------------------------------------------------------
+public:
+	static size_t const HISTORY_SIZE = 32;
+	static uint32_t const MAX_BASELINE_AGE = 1024; //ticks
+
+//-------------------------------------------------------------------------------------------------
+// Members
+//-------------------------------------------------------------------------------------------------
+public:
+	SnapshotState m_states[HISTORY_SIZE];
+	uint32_t m_lastTick;
+	bool m_hasLastTick;
+	float m_sendPriority; //Host only, grows every tick the object is relevant and not sent
+	bool m_baselineConfirmed; //Host only, the client applied one of our states, see ConnectionBaselines::ConfirmApplied
+	uint32_t m_baselineFloor; //Host only, older states aren't trusted as baselines
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+public:
+	SnapshotHistory( );
+
+	SnapshotState * Store( uint32_t tick, byte_t const * data, size_t size );
+	SnapshotState const * Find( uint16_t tick ) const;
+	SnapshotState const * FindNewestAcked( uint32_t currentTick ) const;
+	void MarkAcked( uint32_t tick );
+	void ClearAcked( );
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// An object update competing for a connection's byte budget this tick
+class UpdateCandidate
+{
+public:
+	NetGameObject * netObject;
+	SnapshotHistory * history;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+class DeliveryRecord
+{
+public:
+	uint32_t tag;
+	size_t netID;
+	uint32_t tick;
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Host side baselines for one connection. Each delta sent is tagged so the ack system can tell
+// us which states reached the client. An acked packet doesn't mean the client could apply it, so
+// an object only gets deltas once the client confirms a full state it applied, and a client that
+// can't decode a delta sends it back to full states.
+class ConnectionBaselines
+{
+//-------------------------------------------------------------------------------------------------
+// Static Members
+//-------------------------------------------------------------------------------------------------
+public:
+	static size_t const MAX_RECORDS = 4096;
+
+//-------------------------------------------------------------------------------------------------
+// Members
+//-------------------------------------------------------------------------------------------------
+private:
+	std::map<size_t, SnapshotHistory> m_objects;
+	DeliveryRecord m_records[MAX_RECORDS];
+	uint32_t m_nextTag;
+
+//-------------------------------------------------------------------------------------------------
+// Functions
+//-------------------------------------------------------------------------------------------------
+public:
+	ConnectionBaselines( );
+
+	SnapshotHistory & GetHistory( size_t netID );
+	uint32_t TakeTag( );
+	uint32_t AddRecord( size_t netID, uint32_t tick );
+	void ConfirmDelivery( uint32_t tag );
+	void ConfirmApplied( size_t netID, uint16_t tick );
+	void ResetBaseline( size_t netID, uint16_t missedTick );
+	void RemoveObject( size_t netID );
+};
+
+
+//-------------------------------------------------------------------------------------------------
+// Wire format after the net ID and ticks: a bitmask of changed 16-bit lanes, then the lanes
+void WriteSnapshotDelta( NetMessage * out_message, SnapshotState const & baseline, byte_t const * data, size_t size );
+bool ReadSnapshotDelta( NetMessage const & message, SnapshotState const & baseline, byte_t * out_data );
\ No newline at end of file